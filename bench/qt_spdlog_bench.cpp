@@ -0,0 +1,780 @@
+// Бенчмарки qt_spdlog на Google Benchmark.
+//
+//   QtSpdlogBench [--benchmark_filter=REGEX] [--benchmark_out=FILE --benchmark_out_format=json]
+//                 [--baseline=FILE] [--max-regression=PERCENT] [--latency]
+//
+// Записи уходят в null sink или в файл на tmpfs (/dev/shm, иначе временный каталог),
+// консоль не измеряется. Результат в JSON сохраняется стандартным --benchmark_out;
+// с --baseline сохраненный файл сравнивается с текущим прогоном по real_time, код
+// возврата 1 - есть замедление больше --max-regression (по умолчанию 10%).
+// --latency добавляет к прогонам макросов процентили задержки одного вызова.
+// Счетчик allocs_per_op - число operator new на вызов в потоке логирования.
+// Сокетный sink пишет в приемник внутри процесса (только POSIX), он вычитывает
+// данные вхолостую.
+
+#include "qt_spdlog.h"
+#include "qt_spdlog_async.h"
+#include "qt_spdlog_config.h"
+#include "qt_spdlog_socket.h"
+
+#include <benchmark/benchmark.h>
+
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// СЧЕТЧИК ВЫДЕЛЕНИЙ
+// ============================================================================
+
+// Выделения считаются только в потоке замера и только внутри цикла прогона:
+// подмена operator new касается одного этого процесса бенчмарков
+namespace allocations {
+thread_local bool counting = false;
+thread_local std::uint64_t count = 0;
+} // namespace allocations
+
+void* operator new(std::size_t size)
+{
+    if (allocations::counting) {
+        ++allocations::count;
+    }
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace {
+
+// ============================================================================
+// ОКРУЖЕНИЕ
+// ============================================================================
+
+enum SinkKind {
+    NullSink,
+    FileSink,
+    RotatingSink,
+    AsyncNullSink,
+    SinkKindCount
+};
+
+const char* const sinkNames[SinkKindCount] = {"null", "file", "rotating", "async_null"};
+
+std::string benchFilePath(const char* name)
+{
+    const QString directory = QFileInfo(QStringLiteral("/dev/shm")).isWritable()
+        ? QStringLiteral("/dev/shm")
+        : QDir::tempPath();
+    return QDir(directory).filePath(QString::fromLatin1(name)).toStdString();
+}
+
+std::shared_ptr<qt_spdlog::async::backend> asyncBackend()
+{
+    static auto backend = std::make_shared<qt_spdlog::async::backend>();
+    return backend;
+}
+
+// Логгеры создаются один раз на процесс и переживают все прогоны
+std::shared_ptr<spdlog::logger> benchLogger(int kind)
+{
+    static std::mutex mutex;
+    static std::map<int, std::shared_ptr<spdlog::logger>> loggers;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& logger = loggers[kind];
+    if (logger) {
+        return logger;
+    }
+    const std::string name = std::string("bench_") + sinkNames[kind];
+    switch (kind) {
+    case FileSink:
+        logger = std::make_shared<spdlog::logger>(
+            name, std::make_shared<spdlog::sinks::basic_file_sink_mt>(benchFilePath("qt_spdlog_bench.log"), true));
+        break;
+    case RotatingSink:
+        logger = std::make_shared<spdlog::logger>(
+            name, std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
+                      benchFilePath("qt_spdlog_bench_rotating.log"), 16 * 1024 * 1024, 2));
+        break;
+    case AsyncNullSink:
+        logger = std::make_shared<qt_spdlog::async::async_logger>(
+            name, spdlog::sinks_init_list{std::make_shared<spdlog::sinks::null_sink_mt>()}, asyncBackend());
+        break;
+    default:
+        logger = std::make_shared<spdlog::logger>(name, std::make_shared<spdlog::sinks::null_sink_mt>());
+        break;
+    }
+    logger->set_formatter(qt_spdlog::patterns::DEFAULT.make_formatter());
+    logger->set_level(spdlog::level::info);
+    qt_spdlog::register_logger(logger);
+    return logger;
+}
+
+// --latency: каждый вызов замеряется в гистограмму, процентили выводятся
+// счетчиками прогона (p50_ns, p99_ns, p99.9_ns, max_ns) в консоль и JSON
+bool latencyMode = false;
+
+qt_spdlog::latency::recorder& latencyRecorder()
+{
+    static qt_spdlog::latency::recorder recorder;
+    return recorder;
+}
+
+// Логгер по умолчанию подменяется в потоке 0 до стартового барьера
+void useDefaultLogger(benchmark::State& state, int kind)
+{
+    if (state.thread_index() == 0) {
+        spdlog::set_default_logger(benchLogger(kind));
+    }
+}
+
+void sinksAndThreads(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgName("sink")->DenseRange(0, SinkKindCount - 1)->ThreadRange(1, 8)->UseRealTime();
+}
+
+// Второй аргумент (name) принимает значения 0 и 1
+void sinksFlagAndThreads(benchmark::internal::Benchmark* bench, const char* name)
+{
+    bench->ArgNames({"sink", name})
+        ->ArgsProduct({benchmark::CreateDenseRange(0, SinkKindCount - 1, 1), {0, 1}})
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+}
+
+// Цикл замера одного вызова макроса. Гистограмма сбрасывается потоком 0 до
+// стартового барьера и читается им после конечного, когда все потоки закончили
+template<typename Call>
+void runLogging(benchmark::State& state, int kind, Call&& call)
+{
+    allocations::count = 0;
+    allocations::counting = true;
+    if (latencyMode) {
+        if (state.thread_index() == 0) {
+            latencyRecorder().reset();
+        }
+        for (auto _ : state) {
+            qt_spdlog::latency::recorder::scope timer(latencyRecorder());
+            call();
+        }
+    } else {
+        for (auto _ : state) {
+            call();
+        }
+    }
+
+    allocations::counting = false;
+
+    // Счетчики потоков суммируются и делятся на общее число итераций
+    state.counters["allocs_per_op"] = benchmark::Counter(static_cast<double>(allocations::count),
+                                                         benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() != 0) {
+        return;
+    }
+    if (kind == AsyncNullSink) {
+        // Очередь разбирается вне замера, следующий прогон начинается с пустой
+        std::static_pointer_cast<qt_spdlog::async::async_logger>(benchLogger(kind))->flush_and_wait();
+    }
+    if (latencyMode) {
+        const auto values = latencyRecorder().snapshot();
+        state.counters["p50_ns"] = values.percentile(50);
+        state.counters["p99_ns"] = values.percentile(99);
+        state.counters["p99.9_ns"] = values.percentile(99.9);
+        state.counters["max_ns"] = values.max();
+    }
+}
+
+// ============================================================================
+// СЕМЕЙСТВА МАКРОСОВ
+// ============================================================================
+
+using qt_spdlog::kv;
+
+void BM_LogLiteral(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    runLogging(state, kind, [] { QT_LOG_INFO("Запись без аргументов"); });
+}
+BENCHMARK(BM_LogLiteral)->Apply(sinksAndThreads);
+
+void BM_LogFormat(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    int counter = 0;
+    runLogging(state, kind, [&counter] { QT_LOG_INFO("Запись #{}: {:.3f} мс, {}", ++counter, 12.5, "ok"); });
+}
+BENCHMARK(BM_LogFormat)->Apply(sinksAndThreads);
+
+void BM_LogQString(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    const QString user = QStringLiteral("Иван Петров");
+    runLogging(state, kind, [&user] { QT_LOG_INFO("Пользователь {} вошел", user); });
+}
+BENCHMARK(BM_LogQString)->Apply(sinksAndThreads);
+
+void BM_LoggerHandle(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    benchLogger(kind);
+    const qt_spdlog::logger_handle handle(std::string("bench_") + sinkNames[kind]);
+    runLogging(state, kind, [&handle] { QT_LOGGER_INFO(handle.get(), "Запись через дескриптор #{}", 1); });
+}
+BENCHMARK(BM_LoggerHandle)->Apply(sinksAndThreads);
+
+void BM_LogKv(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    const QString user = QStringLiteral("Иван Петров");
+    runLogging(state, kind, [&user] {
+        QT_LOG_INFO_KV("Вход", kv("user_id", 1542), kv("user", user), kv("latency_ms", 12.5));
+    });
+}
+BENCHMARK(BM_LogKv)->Apply(sinksAndThreads);
+
+void BM_LogJson(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    const QVariantMap fields{{"amount", 2500.5}, {"currency", "RUB"}};
+    runLogging(state, kind, [&fields] { QT_LOG_INFO_JSON("Платеж принят", fields); });
+}
+BENCHMARK(BM_LogJson)->Apply(sinksAndThreads);
+
+// Логгер потока клонируется из логгера по умолчанию при первом вызове в потоке,
+// поэтому вариант один - null sink
+void BM_LogThreadLocal(benchmark::State& state)
+{
+    useDefaultLogger(state, NullSink);
+    runLogging(state, NullSink, [] { QT_LOG_INFO_TS("Запись через логгер потока #{}", 1); });
+}
+BENCHMARK(BM_LogThreadLocal)->ThreadRange(1, 8)->UseRealTime();
+
+// Отфильтрованная запись: стоимость проверки уровня
+void BM_LogFiltered(benchmark::State& state)
+{
+    useDefaultLogger(state, NullSink);
+    runLogging(state, NullSink, [] { QT_LOG_DEBUG("Не выводится #{}", 1); });
+}
+BENCHMARK(BM_LogFiltered)->ThreadRange(1, 8)->UseRealTime();
+
+// cond: 0 - стоимость ложного условия, 1 - условие истинно и запись выводится
+void BM_LogIf(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    const bool condition = state.range(1) != 0;
+    runLogging(state, kind, [condition] { QT_LOG_IF_INFO(condition, "Условная запись #{}", 1); });
+}
+BENCHMARK(BM_LogIf)->Apply([](benchmark::internal::Benchmark* bench) { sinksFlagAndThreads(bench, "cond"); });
+
+// Уровень always выводится мимо уровня логгера
+void BM_LogAlways(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    runLogging(state, kind, [] { QT_LOG_ALWAYS("Запись уровня always #{}", 1); });
+}
+BENCHMARK(BM_LogAlways)->Apply(sinksAndThreads);
+
+// msg: 0 - QT_LOG_INFO_LOCATION(), 1 - QT_LOG_INFO_LOCATION_MSG
+void BM_LogLocation(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    if (state.range(1) != 0) {
+        runLogging(state, kind, [] { QT_LOG_INFO_LOCATION_MSG("Точка входа"); });
+    } else {
+        runLogging(state, kind, [] { QT_LOG_INFO_LOCATION(); });
+    }
+}
+BENCHMARK(BM_LogLocation)->Apply([](benchmark::internal::Benchmark* bench) { sinksFlagAndThreads(bench, "msg"); });
+
+// Имя типа исключения разбирается при каждой записи
+void BM_LogException(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    useDefaultLogger(state, kind);
+    const std::runtime_error error("Соединение разорвано");
+    runLogging(state, kind, [&error] { QT_LOG_EXCEPTION_ERROR(error, "загрузка профиля"); });
+}
+BENCHMARK(BM_LogException)->Apply(sinksAndThreads);
+
+void BM_LoggerKv(benchmark::State& state)
+{
+    const int kind = static_cast<int>(state.range(0));
+    const auto logger = benchLogger(kind);
+    const QString user = QStringLiteral("Иван Петров");
+    runLogging(state, kind, [&logger, &user] {
+        QT_LOGGER_INFO_KV(logger, "Вход", kv("user_id", 1542), kv("user", user), kv("latency_ms", 12.5));
+    });
+}
+BENCHMARK(BM_LoggerKv)->Apply(sinksAndThreads);
+
+// Захват и установка модуля и контекста - то, что run_with_context добавляет
+// к задаче QtConcurrent::run. context: 0 - пустой, 1 - операция, модуль и 2 ключа
+void runTaskContext(benchmark::State& state)
+{
+    for (auto _ : state) {
+        const auto captured = qt_spdlog::scoped::task_context::capture();
+        qt_spdlog::scoped::TaskContextScope scope(captured);
+        benchmark::DoNotOptimize(&scope);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TaskContext(benchmark::State& state)
+{
+    if (state.range(0) == 0) {
+        runTaskContext(state);
+        return;
+    }
+    auto operation = qt_spdlog::begin_operation();
+    auto module = qt_spdlog::module("Bench");
+    auto requestContext = qt_spdlog::context(kv("request_id", QStringLiteral("req-42")), kv("user_id", 42));
+    runTaskContext(state);
+}
+BENCHMARK(BM_TaskContext)->ArgName("context")->DenseRange(0, 1)->ThreadRange(1, 8)->UseRealTime();
+
+// ============================================================================
+// SINK'И
+// ============================================================================
+
+#ifndef _WIN32
+// Приемник сокетного sink'а: принимает соединения и вычитывает их вхолостую,
+// пока не будет остановлен. Живет до выхода из процесса, дольше логгеров
+class SocketDrain {
+public:
+    explicit SocketDrain(std::string path)
+        : path_(std::move(path))
+    {
+        ::unlink(path_.c_str());
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+        listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener_ < 0 || ::bind(listener_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener_, 16) != 0) {
+            std::fprintf(stderr, "socket drain: cannot listen on %s: %s\n", path_.c_str(), std::strerror(errno));
+            if (listener_ >= 0) {
+                ::close(listener_);
+            }
+            listener_ = -1;
+            return;
+        }
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~SocketDrain()
+    {
+        stop_.store(true, std::memory_order_relaxed);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (listener_ >= 0) {
+            ::close(listener_);
+            ::unlink(path_.c_str());
+        }
+    }
+
+    SocketDrain(const SocketDrain&) = delete;
+    SocketDrain& operator=(const SocketDrain&) = delete;
+
+    bool listening() const { return listener_ >= 0; }
+    const std::string& path() const { return path_; }
+
+private:
+    void run()
+    {
+        std::vector<char> buffer(256 * 1024);
+        std::vector<pollfd> fds{{listener_, POLLIN, 0}};
+        while (!stop_.load(std::memory_order_relaxed)) {
+            if (::poll(fds.data(), fds.size(), 100) <= 0) {
+                continue;
+            }
+            for (std::size_t i = fds.size() - 1; i > 0; --i) {
+                if (fds[i].revents != 0 && ::read(fds[i].fd, buffer.data(), buffer.size()) <= 0) {
+                    ::close(fds[i].fd);
+                    fds.erase(fds.begin() + static_cast<std::ptrdiff_t>(i));
+                }
+            }
+            if (fds[0].revents & POLLIN) {
+                const int client = ::accept(listener_, nullptr, nullptr);
+                if (client >= 0) {
+                    fds.push_back({client, POLLIN, 0});
+                }
+            }
+        }
+        for (std::size_t i = 1; i < fds.size(); ++i) {
+            ::close(fds[i].fd);
+        }
+    }
+
+    std::string path_;
+    int listener_ = -1;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+SocketDrain& socketDrain()
+{
+    static SocketDrain drain(benchFilePath("qt_spdlog_bench.sock"));
+    return drain;
+}
+
+// Логгер на каждый размер пачки, все подключены к одному приемнику
+std::shared_ptr<spdlog::logger> socketLogger(std::size_t batchRecords)
+{
+    static std::mutex mutex;
+    static std::map<std::size_t, std::shared_ptr<spdlog::logger>> loggers;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& logger = loggers[batchRecords];
+    if (!logger) {
+        qt_spdlog::sinks::socket_sink_options options;
+        options.address = socketDrain().path();
+        options.batch_records = batchRecords;
+        options.batch_bytes = 1024 * 1024;
+        logger = std::make_shared<spdlog::logger>("bench_socket_" + std::to_string(batchRecords),
+                                                  std::make_shared<qt_spdlog::sinks::socket_sink_mt>(options));
+        logger->set_formatter(qt_spdlog::patterns::DEFAULT.make_formatter());
+        logger->set_level(spdlog::level::info);
+    }
+    return logger;
+}
+
+// batch: записей в пачке одного send
+void BM_SocketSink(benchmark::State& state)
+{
+    if (!socketDrain().listening()) {
+        state.SkipWithError("Приемник сокетного sink'а не запущен");
+        return;
+    }
+    const auto logger = socketLogger(static_cast<std::size_t>(state.range(0)));
+    runLogging(state, NullSink, [&logger] {
+        QT_LOGGER_INFO(logger, "Сообщение для приемника #{} со значением {:.3f}", 1, 0.5);
+    });
+    if (state.thread_index() == 0) {
+        // Неполная пачка уходит вне замера
+        logger->flush();
+    }
+}
+BENCHMARK(BM_SocketSink)->ArgName("batch")->Arg(1)->Arg(16)->Arg(128)->Arg(1024)->ThreadRange(1, 8)->UseRealTime();
+#endif
+
+std::shared_ptr<qt_spdlog::config::reloadable_sink> reloadableSink()
+{
+    static const auto sink = [] {
+        auto created = std::make_shared<qt_spdlog::config::reloadable_sink>();
+        created->publish({std::make_shared<spdlog::sinks::null_sink_mt>()});
+        return created;
+    }();
+    return sink;
+}
+
+// Логгер из конфигурации: запись проходит через текущий набор reloadable_sink.
+// reload: 1 - пока идет замер, отдельный поток раз в миллисекунду публикует
+// новый набор, как при перечитывании файла конфигурации
+void BM_ReloadableSink(benchmark::State& state)
+{
+    static const auto logger = [] {
+        auto created = std::make_shared<spdlog::logger>("bench_reloadable", reloadableSink());
+        created->set_formatter(qt_spdlog::patterns::DEFAULT.make_formatter());
+        created->set_level(spdlog::level::info);
+        return created;
+    }();
+
+    std::atomic<bool> stop{false};
+    std::thread publisher;
+    if (state.thread_index() == 0 && state.range(0) != 0) {
+        publisher = std::thread([&stop] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto sink = std::make_shared<spdlog::sinks::null_sink_mt>();
+                sink->set_formatter(qt_spdlog::patterns::DEFAULT.make_formatter());
+                reloadableSink()->publish({std::move(sink)});
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+    runLogging(state, NullSink, [] { QT_LOGGER_INFO(logger, "Запись через reloadable_sink #{}", 1); });
+    if (publisher.joinable()) {
+        stop.store(true, std::memory_order_relaxed);
+        publisher.join();
+    }
+}
+BENCHMARK(BM_ReloadableSink)->ArgName("reload")->DenseRange(0, 1)->ThreadRange(1, 8)->UseRealTime();
+
+// ============================================================================
+// ФОРМАТТЕРЫ
+// ============================================================================
+
+const std::pair<const char*, const qt_spdlog::CompiledPattern*> presets[] = {
+    {"DEFAULT", &qt_spdlog::patterns::DEFAULT},
+    {"SIMPLE", &qt_spdlog::patterns::SIMPLE},
+    {"DETAILED", &qt_spdlog::patterns::DETAILED},
+    {"LOCATION", &qt_spdlog::patterns::LOCATION},
+    {"QT_STYLE", &qt_spdlog::patterns::QT_STYLE},
+    {"THREAD_ID", &qt_spdlog::patterns::THREAD_ID},
+    {"CONTEXT", &qt_spdlog::patterns::CONTEXT},
+    {"MESSAGE", &qt_spdlog::patterns::MESSAGE}
+};
+
+void runFormatter(benchmark::State& state, spdlog::formatter& formatter)
+{
+    const spdlog::details::log_msg msg(spdlog::source_loc{__FILE__, __LINE__, "runFormatter"},
+                                       "bench", spdlog::level::info, "Сообщение для бенчмарка форматирования");
+    spdlog::memory_buf_t buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        formatter.format(msg, buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(buffer.size()));
+}
+
+// preset: индекс в presets, reference: 1 - тот же паттерн через pattern_formatter
+void BM_Pattern(benchmark::State& state)
+{
+    const auto& preset = presets[state.range(0)];
+    state.SetLabel(preset.first);
+    auto formatter = state.range(1) != 0
+        ? qt_spdlog::make_pattern_formatter(preset.second->pattern())
+        : preset.second->make_formatter();
+    runFormatter(state, *formatter);
+}
+BENCHMARK(BM_Pattern)->ArgNames({"preset", "reference"})
+    ->ArgsProduct({benchmark::CreateDenseRange(0, static_cast<int>(std::size(presets)) - 1, 1), {0, 1}});
+
+void BM_JsonFormatter(benchmark::State& state)
+{
+    qt_spdlog::json_formatter formatter("\n");
+    runFormatter(state, formatter);
+}
+BENCHMARK(BM_JsonFormatter);
+
+void BM_CborFormatter(benchmark::State& state)
+{
+    qt_spdlog::cbor_formatter formatter;
+    runFormatter(state, formatter);
+}
+BENCHMARK(BM_CborFormatter);
+
+// ============================================================================
+// МЕТКИ ВРЕМЕНИ И ПОИСК ЛОГГЕРОВ
+// ============================================================================
+
+void BM_Timestamp(benchmark::State& state)
+{
+    const auto source = static_cast<qt_spdlog::timestamps::source>(state.range(0));
+    if (!qt_spdlog::timestamps::set_source(source)) {
+        state.SkipWithError("Источник времени недоступен");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(qt_spdlog::timestamps::now());
+    }
+    state.SetItemsProcessed(state.iterations());
+    qt_spdlog::timestamps::set_source(qt_spdlog::timestamps::source::realtime);
+}
+BENCHMARK(BM_Timestamp)->ArgName("source")->DenseRange(0, 2);
+
+void BM_RegistryGet(benchmark::State& state)
+{
+    benchLogger(NullSink);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(spdlog::get("bench_null"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegistryGet)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_HandleGet(benchmark::State& state)
+{
+    benchLogger(NullSink);
+    static const qt_spdlog::logger_handle handle("bench_null");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handle.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HandleGet)->ThreadRange(1, 8)->UseRealTime();
+
+// ============================================================================
+// СРАВНЕНИЕ С БАЗОВОЙ ЛИНИЕЙ
+// ============================================================================
+
+double toNanoseconds(double value, const QString& unit)
+{
+    if (unit == QLatin1String("us")) {
+        return value * 1e3;
+    }
+    if (unit == QLatin1String("ms")) {
+        return value * 1e6;
+    }
+    if (unit == QLatin1String("s")) {
+        return value * 1e9;
+    }
+    return value;
+}
+
+double toNanoseconds(double value, benchmark::TimeUnit unit)
+{
+    switch (unit) {
+    case benchmark::kMicrosecond: return value * 1e3;
+    case benchmark::kMillisecond: return value * 1e6;
+    case benchmark::kSecond: return value * 1e9;
+    default: return value;
+    }
+}
+
+// real_time каждого прогона (без агрегатов) в нс по имени из файла --benchmark_out
+bool loadBaseline(const QString& path, std::map<std::string, double>& baseline)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::fprintf(stderr, "baseline: cannot open %s\n", qPrintable(path));
+        return false;
+    }
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject()) {
+        std::fprintf(stderr, "baseline: %s: %s\n", qPrintable(path), qPrintable(error.errorString()));
+        return false;
+    }
+    const QJsonArray benchmarks = document.object().value(QStringLiteral("benchmarks")).toArray();
+    for (const auto& item : benchmarks) {
+        const QJsonObject run = item.toObject();
+        if (run.value(QStringLiteral("run_type")).toString() == QLatin1String("aggregate") ||
+            run.contains(QStringLiteral("error_occurred"))) {
+            continue;
+        }
+        baseline[run.value(QStringLiteral("name")).toString().toStdString()] =
+            toNanoseconds(run.value(QStringLiteral("real_time")).toDouble(),
+                          run.value(QStringLiteral("time_unit")).toString());
+    }
+    return true;
+}
+
+// Консольный вывод как обычно, плюс запоминание результатов для сравнения
+class BaselineReporter : public benchmark::ConsoleReporter {
+public:
+    void ReportRuns(const std::vector<Run>& runs) override
+    {
+        for (const auto& run : runs) {
+            if (run.run_type == Run::RT_Iteration && !run.error_occurred) {
+                results_.emplace_back(run.benchmark_name(), toNanoseconds(run.GetAdjustedRealTime(), run.time_unit));
+            }
+        }
+        ConsoleReporter::ReportRuns(runs);
+    }
+
+    const std::vector<std::pair<std::string, double>>& results() const { return results_; }
+
+private:
+    std::vector<std::pair<std::string, double>> results_;
+};
+
+int compareWithBaseline(const std::map<std::string, double>& baseline,
+                        const std::vector<std::pair<std::string, double>>& results, double maxRegression)
+{
+    int regressions = 0;
+    std::printf("\n%-60s %14s %14s %9s\n", "Benchmark", "Baseline, ns", "Current, ns", "Change");
+    for (const auto& [name, current] : results) {
+        const auto found = baseline.find(name);
+        if (found == baseline.end() || found->second <= 0) {
+            std::printf("%-60s %14s %14.1f %9s\n", name.c_str(), "-", current, "new");
+            continue;
+        }
+        const double change = (current - found->second) / found->second * 100.0;
+        const bool regressed = change > maxRegression;
+        regressions += regressed ? 1 : 0;
+        std::printf("%-60s %14.1f %14.1f %+8.1f%%%s\n", name.c_str(), found->second, current, change,
+                    regressed ? "  REGRESSION" : "");
+    }
+    std::printf("\n%d regression(s) above %.1f%%\n", regressions, maxRegression);
+    return regressions > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Свои ключи забираем до benchmark::Initialize, остальные - Google Benchmark
+    QString baselinePath;
+    double maxRegression = 10.0;
+    std::vector<char*> arguments;
+    for (int i = 0; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument.rfind("--baseline=", 0) == 0) {
+            baselinePath = QString::fromStdString(argument.substr(11));
+        } else if (argument.rfind("--max-regression=", 0) == 0) {
+            maxRegression = std::atof(argument.c_str() + 17);
+        } else if (argument == "--latency") {
+            latencyMode = true;
+        } else {
+            arguments.push_back(argv[i]);
+        }
+    }
+    int count = static_cast<int>(arguments.size());
+    benchmark::Initialize(&count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(count, arguments.data())) {
+        return 1;
+    }
+
+    int result = 0;
+    if (baselinePath.isEmpty()) {
+        benchmark::RunSpecifiedBenchmarks();
+    } else {
+        std::map<std::string, double> baseline;
+        if (!loadBaseline(baselinePath, baseline)) {
+            return 1;
+        }
+        BaselineReporter reporter;
+        benchmark::RunSpecifiedBenchmarks(&reporter);
+        result = compareWithBaseline(baseline, reporter.results(), maxRegression);
+    }
+
+    qt_spdlog::drop_all();
+    benchmark::Shutdown();
+    return result;
+}
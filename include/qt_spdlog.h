@@ -4,7 +4,9 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/pattern_formatter.h>
 #include <spdlog/fmt/bundled/format.h>
+#include <spdlog/details/os.h>
 #include <QString>
+#include <QStringView>
 #include <QMap>
 #include <QList>
 #include <QVector>
@@ -20,10 +22,51 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QJsonValue>
+#include <QCborValue>
+#include <QVariantHash>
+#include <QLoggingCategory>
 #include <type_traits>
 #include <tuple>
 #include <thread>
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <iterator>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <shared_mutex>
+#include <unordered_map>
+#include <map>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <optional>
+#include <functional>
+
+// Быстрый путь экранирования строк JSON
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QT_SPDLOG_JSON_SSE2
+#endif
+
+// Метки времени из счетчика тактов процессора
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#include <cpuid.h>
+#define QT_SPDLOG_HAS_TSC
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define QT_SPDLOG_HAS_TSC
+#endif
 
 // Использовать для настройки spdlog
 // Напр.
@@ -318,6 +361,47 @@ constexpr void log_with_conversion(LoggerFunc&& logger_func, Args&&... args) {
     }, converted);
 }
 
+// Перекодирование UTF-16 → UTF-8 прямо в буфер spdlog, без промежуточных QByteArray/std::string.
+// Одиночные суррогаты заменяются на U+FFFD
+inline void append_utf8(spdlog::memory_buf_t& buffer, QStringView text) {
+    const auto* data = reinterpret_cast<const char16_t*>(text.utf16());
+    const auto size = static_cast<std::size_t>(text.size());
+
+    // Худший случай - 3 байта на единицу UTF-16
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + size * 3);
+    char* out = buffer.data() + offset;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        char32_t code = data[i];
+        if (code < 0x80) {
+            *out++ = static_cast<char>(code);
+            continue;
+        }
+        if (code < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (code >> 6));
+            *out++ = static_cast<char>(0x80 | (code & 0x3F));
+            continue;
+        }
+        if (code >= 0xD800 && code <= 0xDFFF) {
+            if (code <= 0xDBFF && i + 1 < size && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF) {
+                code = 0x10000 + ((code - 0xD800) << 10) + (data[++i] - 0xDC00);
+                *out++ = static_cast<char>(0xF0 | (code >> 18));
+                *out++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                *out++ = static_cast<char>(0x80 | (code & 0x3F));
+                continue;
+            }
+            code = 0xFFFD;
+        }
+        *out++ = static_cast<char>(0xE0 | (code >> 12));
+        *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+
+    buffer.resize(static_cast<std::size_t>(out - buffer.data()));
+}
+
 inline QString format_exception_name(const char* name) {
     QString result(name);
 
@@ -350,62 +434,501 @@ inline QString get_exception_message(const QException& e) {
 
 namespace details {
 
-// Единая карта для преобразования строк <-> уровни spdlog
-inline const QMap<QString, spdlog::level::level_enum>& get_string_to_level_map() {
-    static const QMap<QString, spdlog::level::level_enum> map = {
-        {"trace", spdlog::level::trace},
-        {"debug", spdlog::level::debug},
-        {"info", spdlog::level::info},
-        {"warn", spdlog::level::warn},
-        {"warning", spdlog::level::warn},
-        {"error", spdlog::level::err},
-        {"critical", spdlog::level::critical},
-        {"off", spdlog::level::off},
-        {"always", spdlog::level::off}
-    };
-    return map;
-}
-
-inline const QMap<spdlog::level::level_enum, QString>& get_level_to_string_map() {
-    static const QMap<spdlog::level::level_enum, QString> map = {
-        {spdlog::level::trace, "trace"},
-        {spdlog::level::debug, "debug"},
-        {spdlog::level::info, "info"},
-        {spdlog::level::warn, "warn"},
-        {spdlog::level::err, "error"},
-        {spdlog::level::critical, "critical"},
-        {spdlog::level::off, "off"}
-    };
-    return map;
-}
-
-// Единая карта для преобразования QtMsgType <-> уровни spdlog
-inline const QMap<QtMsgType, spdlog::level::level_enum>& get_qt_to_spdlog_map() {
-    static const QMap<QtMsgType, spdlog::level::level_enum> map = {
-                                                                   {QtMsgType::QtDebugMsg, spdlog::level::debug},
-                                                                   {QtMsgType::QtInfoMsg, spdlog::level::info},
-                                                                   {QtMsgType::QtWarningMsg, spdlog::level::warn},
-                                                                   {QtMsgType::QtCriticalMsg, spdlog::level::err},
-                                                                   {QtMsgType::QtFatalMsg, spdlog::level::critical},
-                                                                   };
-    return map;
-}
-
-inline const QMap<spdlog::level::level_enum, QtMsgType>& get_spdlog_to_qt_map() {
-    static const QMap<spdlog::level::level_enum, QtMsgType> map = {
-        {spdlog::level::trace, QtMsgType::QtDebugMsg},
-        {spdlog::level::debug, QtMsgType::QtDebugMsg},
-        {spdlog::level::info, QtMsgType::QtInfoMsg},
-        {spdlog::level::warn, QtMsgType::QtWarningMsg},
-        {spdlog::level::err, QtMsgType::QtCriticalMsg},
-        {spdlog::level::critical, QtMsgType::QtFatalMsg},
-        {spdlog::level::off, QtMsgType::QtFatalMsg}
-    };
-    return map;
+struct level_name {
+    std::string_view name;
+    spdlog::level::level_enum level;
+};
+
+// Имена уровней и алиасы, по алфавиту (порядок get_available_levels)
+inline constexpr std::array<level_name, 9> level_names{{
+    {"always", spdlog::level::off},
+    {"critical", spdlog::level::critical},
+    {"debug", spdlog::level::debug},
+    {"error", spdlog::level::err},
+    {"info", spdlog::level::info},
+    {"off", spdlog::level::off},
+    {"trace", spdlog::level::trace},
+    {"warn", spdlog::level::warn},
+    {"warning", spdlog::level::warn},
+}};
+
+// Каноническое имя по значению уровня (trace..off)
+inline constexpr std::array<std::string_view, spdlog::level::n_levels> canonical_level_names{{
+    "trace", "debug", "info", "warn", "error", "critical", "off"
+}};
+
+inline constexpr std::array<QtMsgType, spdlog::level::n_levels> spdlog_to_qt_levels{{
+    QtDebugMsg, QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg, QtFatalMsg, QtFatalMsg
+}};
+
+template<typename Char>
+constexpr char32_t ascii_lower(Char c) {
+    const auto code = static_cast<char32_t>(static_cast<std::make_unsigned_t<Char>>(c));
+    return code >= 'A' && code <= 'Z' ? code + ('a' - 'A') : code;
+}
+
+// Совершенный хэш имен уровней: первая и последняя буква и длина, без учета регистра
+constexpr std::size_t level_hash_size = 16;
+
+template<typename Char>
+constexpr std::size_t level_hash(const Char* data, std::size_t size) {
+    return (ascii_lower(data[0]) + ascii_lower(data[size - 1]) + 9 * size) % level_hash_size;
+}
+
+// Слот хэша -> индекс в level_names, -1 - пусто
+constexpr std::array<int, level_hash_size> make_level_hash_table() {
+    std::array<int, level_hash_size> table{};
+    for (auto& slot : table) {
+        slot = -1;
+    }
+    for (std::size_t i = 0; i < level_names.size(); ++i) {
+        table[level_hash(level_names[i].name.data(), level_names[i].name.size())] = static_cast<int>(i);
+    }
+    return table;
+}
+
+inline constexpr std::array<int, level_hash_size> level_hash_table = make_level_hash_table();
+
+constexpr bool level_hash_is_perfect() {
+    std::size_t used = 0;
+    for (int slot : level_hash_table) {
+        used += slot >= 0;
+    }
+    return used == level_names.size();
+}
+
+static_assert(level_hash_is_perfect(), "level names collide in level_hash, change the hash");
+
+// Поиск имени уровня без выделений памяти, регистр не учитывается.
+// Возвращает индекс в level_names или -1
+template<typename Char>
+constexpr int find_level_name(const Char* data, std::size_t size) {
+    if (size == 0) {
+        return -1;
+    }
+    const int index = level_hash_table[level_hash(data, size)];
+    if (index < 0 || level_names[index].name.size() != size) {
+        return -1;
+    }
+    const auto& name = level_names[index].name;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (ascii_lower(data[i]) != static_cast<char32_t>(name[i])) {
+            return -1;
+        }
+    }
+    return index;
+}
+
+static_assert(level_names[find_level_name("Warning", 7)].level == spdlog::level::warn);
+static_assert(find_level_name("warm", 4) < 0);
+
+inline bool qt_to_spdlog(QtMsgType type, spdlog::level::level_enum& level) {
+    switch (type) {
+    case QtDebugMsg: level = spdlog::level::debug; return true;
+    case QtInfoMsg: level = spdlog::level::info; return true;
+    case QtWarningMsg: level = spdlog::level::warn; return true;
+    case QtCriticalMsg: level = spdlog::level::err; return true;
+    case QtFatalMsg: level = spdlog::level::critical; return true;
+    default: return false;
+    }
+}
+
+} // namespace details
+
+// ============================================================================
+// ИЕРАРХИЯ ЛОГГЕРОВ
+// ============================================================================
+
+// Имена вида "net.http.client" образуют дерево: уровень, заданный префиксу,
+// действует на всех потомков, пока у поддерева нет своего явного уровня.
+// Уровень разрешается по дереву в момент установки и записывается в атомарный
+// уровень каждого логгера, так что should_log по-прежнему - одна загрузка.
+
+namespace categories {
+// Пересчет включенности категорий Qt после смены уровней (определение ниже)
+inline void refresh();
+} // namespace categories
+
+namespace hierarchy {
+
+namespace details {
+
+struct attached_logger {
+    std::weak_ptr<spdlog::logger> logger;
+    // Уровень логгера до того, как на него подействовал явный уровень предка;
+    // возвращается, когда явных уровней выше не остается
+    std::optional<spdlog::level::level_enum> saved_level;
+};
+
+struct node {
+    std::optional<spdlog::level::level_enum> level;
+    std::vector<attached_logger> loggers;
+    std::unordered_map<std::string, std::unique_ptr<node>> children;
+};
+
+struct tree {
+    std::mutex mutex;
+    node root;
+};
+
+inline tree& get_tree() {
+    static tree instance;
+    return instance;
+}
+
+// Узел по имени; inherited - ближайший явный уровень среди предков (без самого узла).
+// Пустое имя - корень
+inline node* find(node& root, std::string_view name, bool create,
+                  std::optional<spdlog::level::level_enum>* inherited = nullptr) {
+    node* current = &root;
+    std::optional<spdlog::level::level_enum> level;
+    while (!name.empty()) {
+        const std::size_t dot = name.find('.');
+        const std::string segment(name.substr(0, dot));
+        name = dot == std::string_view::npos ? std::string_view() : name.substr(dot + 1);
+
+        auto it = current->children.find(segment);
+        if (it == current->children.end()) {
+            if (!create) {
+                return nullptr;
+            }
+            it = current->children.emplace(segment, std::make_unique<node>()).first;
+        }
+        level = current->level ? current->level : level;
+        current = it->second.get();
+    }
+    if (inherited) {
+        *inherited = current == &root ? std::nullopt : level;
+    }
+    return current;
+}
+
+inline void apply(attached_logger& entry, spdlog::logger& logger,
+                  std::optional<spdlog::level::level_enum> effective) {
+    if (effective) {
+        if (!entry.saved_level) {
+            entry.saved_level = logger.level();
+        }
+        logger.set_level(*effective);
+    }
+    else if (entry.saved_level) {
+        logger.set_level(*entry.saved_level);
+        entry.saved_level.reset();
+    }
+}
+
+// Имя равно префиксу или лежит под ним: "net" и "net.http", но не "network"
+constexpr bool under(std::string_view name, std::string_view prefix) {
+    return prefix.empty()
+        || (name.substr(0, prefix.size()) == prefix && (name.size() == prefix.size() || name[prefix.size()] == '.'));
+}
+
+static_assert(under("net.http", "net") && under("net", "net") && !under("network", "net"));
+
+// Проставляет действующий уровень всему поддереву. Потомки со своим явным
+// уровнем не затрагиваются; умершие логгеры по пути вычищаются
+inline void propagate(node& current, std::optional<spdlog::level::level_enum> inherited) {
+    const auto effective = current.level ? current.level : inherited;
+    auto& loggers = current.loggers;
+    loggers.erase(std::remove_if(loggers.begin(), loggers.end(),
+                                 [effective](attached_logger& entry) {
+                                     auto logger = entry.logger.lock();
+                                     if (logger) {
+                                         apply(entry, *logger, effective);
+                                     }
+                                     return !logger;
+                                 }),
+                  loggers.end());
+    for (auto& child : current.children) {
+        if (!child.second->level) {
+            propagate(*child.second, effective);
+        }
+    }
+}
+
+// Уровни логгеров, на которые действует явный уровень дерева, сменились снаружи
+// (set_level_spec): новый уровень становится сохраненным, явный ставится обратно
+template<typename BaseLevel>
+inline void rebase(node& current, std::optional<spdlog::level::level_enum> inherited, const BaseLevel& base_level) {
+    const auto effective = current.level ? current.level : inherited;
+    for (auto& entry : current.loggers) {
+        auto logger = entry.logger.lock();
+        if (!logger || !entry.saved_level) {
+            continue;
+        }
+        if (auto level = base_level(logger->name())) {
+            entry.saved_level = *level;
+        }
+        if (effective) {
+            logger->set_level(*effective);
+        }
+    }
+    for (auto& child : current.children) {
+        rebase(*child.second, effective, base_level);
+    }
+}
+
+} // namespace details
+
+// Подключает логгер к дереву по его имени; повторное подключение ничего не меняет.
+// Логгеры категорий, async::create_logger и config::apply подключаются сами, логгеры
+// фабрик spdlog (spdlog::stdout_color_mt и т.п.) - при установке уровня их префиксу
+inline void attach(const std::shared_ptr<spdlog::logger>& logger) {
+    if (!logger || logger->name().empty()) {
+        return;
+    }
+    auto& tree = details::get_tree();
+    std::lock_guard<std::mutex> lock(tree.mutex);
+    std::optional<spdlog::level::level_enum> inherited;
+    auto* node = details::find(tree.root, logger->name(), true, &inherited);
+    // Сравнение владельцев не трогает счетчик ссылок
+    for (const auto& entry : node->loggers) {
+        if (!entry.logger.owner_before(logger) && !logger.owner_before(entry.logger)) {
+            return;
+        }
+    }
+    node->loggers.push_back({logger, std::nullopt});
+    details::apply(node->loggers.back(), *logger, node->level ? node->level : inherited);
+}
+
+// Подключает логгеры реестра spdlog с именем prefix или под ним; пустой префикс -
+// все логгеры, кроме логгера по умолчанию
+inline void attach_registry(std::string_view prefix = {}) {
+    std::vector<std::shared_ptr<spdlog::logger>> loggers;
+    spdlog::apply_all([&loggers, prefix](const std::shared_ptr<spdlog::logger>& logger) {
+        if (details::under(logger->name(), prefix)) {
+            loggers.push_back(logger);
+        }
+    });
+    for (const auto& logger : loggers) {
+        attach(logger);
+    }
+}
+
+// Явный уровень префикса (nullopt - снять); возвращает прежний явный уровень.
+// Логгеры реестра под префиксом подключаются к дереву здесь же
+inline std::optional<spdlog::level::level_enum> exchange_level(std::string_view prefix,
+                                                               std::optional<spdlog::level::level_enum> level) {
+    if (level) {
+        attach_registry(prefix);
+    }
+    std::optional<spdlog::level::level_enum> previous;
+    {
+        auto& tree = details::get_tree();
+        std::lock_guard<std::mutex> lock(tree.mutex);
+        std::optional<spdlog::level::level_enum> inherited;
+        auto* node = details::find(tree.root, prefix, level.has_value(), &inherited);
+        if (!node) {
+            return std::nullopt;
+        }
+        previous = node->level;
+        node->level = level;
+        details::propagate(*node, inherited);
+    }
+    categories::refresh();
+    return previous;
+}
+
+inline void set_level(std::string_view prefix, spdlog::level::level_enum level) {
+    exchange_level(prefix, level);
+}
+
+inline void clear_level(std::string_view prefix) {
+    exchange_level(prefix, std::nullopt);
+}
+
+// Явный уровень, действующий на имя (свой или ближайшего предка)
+inline std::optional<spdlog::level::level_enum> effective_level(std::string_view name) {
+    auto& tree = details::get_tree();
+    std::lock_guard<std::mutex> lock(tree.mutex);
+    const details::node* current = &tree.root;
+    std::optional<spdlog::level::level_enum> level = current->level;
+    while (!name.empty()) {
+        const std::size_t dot = name.find('.');
+        auto it = current->children.find(std::string(name.substr(0, dot)));
+        if (it == current->children.end()) {
+            break;
+        }
+        current = it->second.get();
+        level = current->level ? current->level : level;
+        name = dot == std::string_view::npos ? std::string_view() : name.substr(dot + 1);
+    }
+    return level;
+}
+
+// Есть ли в дереве узел с таким именем (подключенный логгер или его предок)
+inline bool contains(std::string_view name) {
+    auto& tree = details::get_tree();
+    std::lock_guard<std::mutex> lock(tree.mutex);
+    return details::find(tree.root, name, false) != nullptr;
+}
+
+// Новые уровни логгеров после set_level_spec: base_level(имя) - уровень из спецификации
+template<typename BaseLevel>
+inline void rebase(const BaseLevel& base_level) {
+    auto& tree = details::get_tree();
+    std::lock_guard<std::mutex> lock(tree.mutex);
+    details::rebase(tree.root, std::nullopt, base_level);
+}
+
+} // namespace hierarchy
+
+// ============================================================================
+// ДЕСКРИПТОРЫ ЛОГГЕРОВ
+// ============================================================================
+
+// spdlog::get() на каждом вызове берет мьютекс реестра и ищет имя в хэш-таблице.
+// Дескриптор разрешает имя один раз на поток, дальше сверяет только поколение
+// реестра - без блокировок и выделений памяти. Поколение меняют register_logger()
+// и drop() ниже, логгеры категорий, async и конфигурации. Фабрики spdlog
+// (spdlog::stdout_color_mt и т.п.), spdlog::register_logger и spdlog::drop его не
+// меняют: ненайденное имя не кэшируется, поэтому логгер из фабрики находится
+// при следующем обращении, но после spdlog::drop дескриптор держит прежний логгер,
+// пока не вызван invalidate_logger_handles()
+
+namespace handles {
+
+namespace details {
+
+struct registry_state {
+    std::atomic<std::uint64_t> generation{1};
+    std::mutex mutex;
+    std::uint64_t next_serial = 0;
+    std::size_t slot_count = 0;
+    std::vector<std::size_t> free_slots;
+};
+
+inline registry_state& get_state() {
+    static registry_state state;
+    return state;
+}
+
+// Ненайденное имя перепроверяется в реестре раз в столько обращений потока:
+// логгер могла создать фабрика spdlog, не меняя поколения
+constexpr std::uint32_t miss_recheck_calls = 1024;
+
+// Запись кэша потока. serial отличает дескриптор, занявший освободившийся слот
+struct cached_logger {
+    std::uint64_t serial = 0;
+    std::uint64_t generation = 0;
+    std::shared_ptr<spdlog::logger> logger;
+    std::uint32_t misses = 0; // обращений к закэшированному промаху
+};
+
+inline std::vector<cached_logger>& thread_cache() {
+    thread_local std::vector<cached_logger> cache;
+    return cache;
 }
 
 } // namespace details
 
+} // namespace handles
+
+// Сбрасывает разрешенные дескрипторами логгеры во всех потоках
+inline void invalidate_logger_handles() {
+    handles::details::get_state().generation.fetch_add(1, std::memory_order_release);
+}
+
+inline void register_logger(std::shared_ptr<spdlog::logger> logger) {
+    spdlog::register_logger(std::move(logger));
+    invalidate_logger_handles();
+}
+
+inline void drop(const std::string& name) {
+    spdlog::drop(name);
+    invalidate_logger_handles();
+}
+
+inline void drop_all() {
+    spdlog::drop_all();
+    invalidate_logger_handles();
+}
+
+class logger_handle {
+public:
+    // Пустое имя - логгер по умолчанию
+    explicit logger_handle(std::string name)
+        : name_(std::move(name)) {
+        auto& state = handles::details::get_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        serial_ = ++state.next_serial;
+        if (state.free_slots.empty()) {
+            slot_ = state.slot_count++;
+        } else {
+            slot_ = state.free_slots.back();
+            state.free_slots.pop_back();
+        }
+    }
+
+    explicit logger_handle(const char* name)
+        : logger_handle(std::string(name)) {}
+
+    explicit logger_handle(const QString& name)
+        : logger_handle(name.toStdString()) {}
+
+    ~logger_handle() {
+        auto& state = handles::details::get_state();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.free_slots.push_back(slot_);
+    }
+
+    logger_handle(const logger_handle&) = delete;
+    logger_handle& operator=(const logger_handle&) = delete;
+
+    // Логгер с этим именем или логгер по умолчанию, если такого нет в реестре.
+    // Указатель действителен в этом потоке до следующего обращения к дескриптору
+    spdlog::logger* get() const {
+        spdlog::logger* logger = resolve().get();
+        return logger ? logger : spdlog::default_logger_raw();
+    }
+
+    spdlog::logger* operator->() const { return get(); }
+    spdlog::logger& operator*() const { return *get(); }
+
+    std::shared_ptr<spdlog::logger> shared() const {
+        const auto& logger = resolve();
+        return logger ? logger : spdlog::default_logger();
+    }
+
+    // Есть ли логгер с этим именем в реестре
+    bool resolved() const { return resolve() != nullptr; }
+
+    const std::string& name() const { return name_; }
+
+private:
+    const std::shared_ptr<spdlog::logger>& resolve() const {
+        auto& cache = handles::details::thread_cache();
+        const auto generation = handles::details::get_state().generation.load(std::memory_order_acquire);
+        if (slot_ < cache.size()) {
+            auto& entry = cache[slot_];
+            if (entry.serial == serial_ && entry.generation == generation &&
+                (entry.logger || name_.empty() || ++entry.misses < handles::details::miss_recheck_calls)) {
+                return entry.logger;
+            }
+        }
+        return refresh(cache, generation);
+    }
+
+    // Медленный путь: поколение сменилось, поток обращается впервые или пора
+    // перепроверить ненайденное имя
+    const std::shared_ptr<spdlog::logger>& refresh(std::vector<handles::details::cached_logger>& cache,
+                                                   std::uint64_t generation) const {
+        if (slot_ >= cache.size()) {
+            cache.resize(slot_ + 1);
+        }
+        auto& entry = cache[slot_];
+        entry.serial = serial_;
+        entry.generation = generation;
+        entry.logger = name_.empty() ? nullptr : spdlog::get(name_);
+        entry.misses = 0;
+        return entry.logger;
+    }
+
+    std::string name_;
+    std::uint64_t serial_ = 0;
+    std::size_t slot_ = 0;
+};
+
 namespace scoped {
 
 class ScopedLoggerLevel {
@@ -413,12 +936,27 @@ private:
     std::shared_ptr<spdlog::logger> logger_;
     spdlog::level::level_enum original_level_;
     bool active_;
+    // Имя узла иерархии, если уровень выставлен поддереву
+    std::string prefix_;
+    std::optional<spdlog::level::level_enum> original_prefix_level_;
 
 public:
-    // Конструктор с именем логгера
+    // Конструктор с именем логгера. Если имя есть в иерархии ("net" для "net.http"),
+    // уровень действует на все поддерево
     ScopedLoggerLevel(const std::string& logger_name, spdlog::level::level_enum level)
         : active_(false) {
 
+        // Логгеры реестра под этим именем (в том числе из фабрик spdlog) - в дерево
+        if (!logger_name.empty()) {
+            hierarchy::attach_registry(logger_name);
+        }
+        if (!logger_name.empty() && hierarchy::contains(logger_name)) {
+            prefix_ = logger_name;
+            original_prefix_level_ = hierarchy::exchange_level(prefix_, level);
+            active_ = true;
+            return;
+        }
+
         logger_ = logger_name.empty() ? spdlog::default_logger() : spdlog::get(logger_name);
 
         // Если логгер с указанным именем не существует, fallback на default
@@ -433,8 +971,23 @@ public:
         }
     }
 
+    // Конструктор с дескриптором: без обращения к реестру, только сам логгер
+    ScopedLoggerLevel(const logger_handle& handle, spdlog::level::level_enum level)
+        : logger_(handle.shared())
+        , active_(false) {
+
+        if (logger_) {
+            original_level_ = logger_->level();
+            logger_->set_level(level);
+            active_ = true;
+        }
+    }
+
     ~ScopedLoggerLevel() {
-        if (active_ && logger_) {
+        if (active_ && !prefix_.empty()) {
+            hierarchy::exchange_level(prefix_, original_prefix_level_);
+        }
+        else if (active_ && logger_) {
             logger_->set_level(original_level_);
         }
     }
@@ -449,451 +1002,4076 @@ public:
 };
 }
 
-namespace json {
-
-// Функции для JSON логирования
-inline void json_log(spdlog::level::level_enum level, const QString& message, const QVariantMap& fields = {}) {
-    QJsonObject jsonObj;
-    jsonObj["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
-    jsonObj["level"] = QString::fromStdString(spdlog::level::to_string_view(level).data());
-    jsonObj["message"] = message;
-
-    if (!fields.isEmpty()) {
-        jsonObj["fields"] = QJsonObject::fromVariantMap(fields);
-    }
+// ============================================================================
+// МЕТКИ ВРЕМЕНИ
+// ============================================================================
 
-    QJsonDocument doc(jsonObj);
-    QString jsonStr = doc.toJson(QJsonDocument::Compact);
+// Часы читаются один раз на запись: макросы QT_LOG_* и json_log берут время
+// из timestamps::now() и передают его в spdlog, JSON и текстовые паттерны
+// форматируют одно и то же значение. Источник выбирается на процесс
 
-    spdlog::default_logger()->log(level, jsonStr.toStdString());
-}
+namespace timestamps {
 
-// Удобные обертки
-inline void json_info(const QString& message, const QVariantMap& fields = {}) {
-    json_log(spdlog::level::info, message, fields);
-}
+enum class source {
+    realtime,        // system_clock, как в spdlog
+    realtime_coarse, // CLOCK_REALTIME_COARSE: точность - тик ядра (1-4 мс), без обращения к часам
+    tsc              // счетчик тактов процессора, откалиброванный по realtime
+};
 
-inline void json_error(const QString& message, const QVariantMap& fields = {}) {
-    json_log(spdlog::level::err, message, fields);
-}
+namespace details {
 
-inline void json_warn(const QString& message, const QVariantMap& fields = {}) {
-    json_log(spdlog::level::warn, message, fields);
-}
+#ifdef QT_SPDLOG_HAS_TSC
+// Прямая перевода тактов во время: ns = base_ns + (ticks - base_ticks) * ns_per_tick
+struct tsc_line {
+    std::uint64_t base_ticks = 0;
+    std::int64_t base_ns = 0;
+    double ns_per_tick = 0.0;
 
-inline void json_debug(const QString& message, const QVariantMap& fields = {}) {
-    json_log(spdlog::level::debug, message, fields);
-}
+    std::int64_t to_ns(std::uint64_t ticks) const {
+        const auto elapsed = static_cast<double>(static_cast<std::int64_t>(ticks - base_ticks));
+        return base_ns + static_cast<std::int64_t>(elapsed * ns_per_tick);
+    }
+};
 
-} // namespace json
+// Слот таблицы калибровок. Слоты перезаписываются по кругу, читатель сверяет
+// номер эпохи до и после чтения полей (seqlock) и не берет блокировок
+struct tsc_epoch {
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> base_ticks{0};
+    std::atomic<std::int64_t> base_ns{0};
+    std::atomic<double> ns_per_tick{0.0};
+};
 
-// ============================================================================
-// УПРАВЛЕНИЕ УРОВНЯМИ
-// ============================================================================
+// 256 эпох при перекалибровке раз в секунду - больше четырех минут истории
+// для записей, которые backend переводит во время позже
+constexpr std::uint64_t tsc_epoch_count = 256;
 
-// Преобразование строки в уровень spdlog
-inline spdlog::level::level_enum string_to_level(const QString& level_str) {
-    auto& map = details::get_string_to_level_map();
-    QString lower = level_str.toLower();
+struct tsc_sample {
+    std::uint64_t ticks = 0;
+    std::int64_t ns = 0;
+};
+#endif
 
-    if (map.contains(lower)) {
-        return map.value(lower);
+struct clock_state {
+    std::atomic<int> current{static_cast<int>(source::realtime)};
+    std::mutex mutex; // сериализует смену источника
+#ifdef QT_SPDLOG_HAS_TSC
+    std::atomic<std::uint64_t> tsc_sequence{0}; // последняя опубликованная эпоха, 0 - нет калибровки
+    std::array<tsc_epoch, tsc_epoch_count> epochs;
+
+    // Фоновая перекалибровка
+    std::mutex recalibration_mutex;
+    std::condition_variable recalibration_wake;
+    bool recalibration_stopping = false;
+    std::thread recalibrator;
+
+    void stop_recalibrator() {
+        if (!recalibrator.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(recalibration_mutex);
+            recalibration_stopping = true;
+        }
+        recalibration_wake.notify_all();
+        recalibrator.join();
+        recalibration_stopping = false;
     }
 
-    // Если уровень не найден, пробуем преобразовать через spdlog
-    try {
-        std::string std_str = level_str.toStdString();
-        return spdlog::level::from_str(std_str);
-    }
-    catch (...) {
-        return spdlog::level::info; // уровень по умолчанию
-    }
-}
+    ~clock_state() { stop_recalibrator(); }
+#endif
+};
 
-// Преобразование уровня spdlog в строку
-inline QString level_to_string(spdlog::level::level_enum level) {
-    auto& map = details::get_level_to_string_map();
+inline clock_state& get_state() {
+    static clock_state state;
+    return state;
+}
 
-    if (map.contains(level)) {
-        return map.value(level);
-    }
+inline std::int64_t realtime_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
-    return QString::fromStdString(spdlog::level::to_short_c_str(level));
+inline spdlog::log_clock::time_point from_ns(std::int64_t ns) {
+    return spdlog::log_clock::time_point(
+        std::chrono::duration_cast<spdlog::log_clock::duration>(std::chrono::nanoseconds(ns)));
 }
 
-// Преобразование QtMsgType в уровень spdlog
-inline spdlog::level::level_enum qt_to_spdlog_level(QtMsgType qt_level) {
-    auto& map = details::get_qt_to_spdlog_map();
-    return map.value(qt_level, spdlog::level::info);
+#ifdef QT_SPDLOG_HAS_TSC
+// lfence не дает rdtsc выполниться раньше предшествующих загрузок: метка, снятая
+// после чтения чужой метки, не окажется меньше нее
+inline std::uint64_t read_tsc() {
+    _mm_lfence();
+    return __rdtsc();
 }
 
-inline bool set_level(const QString& level) {
-    const auto& level_map = details::get_string_to_level_map();
-    auto it = level_map.find(level.toLower());
-    if (it != level_map.end()) {
-        spdlog::set_level(it.value());
-        return true;
+// Частота TSC не меняется с P-состояниями и не останавливается в C-состояниях
+inline bool has_invariant_tsc() {
+#if defined(_MSC_VER)
+    int registers[4] = {};
+    __cpuid(registers, 0x80000000);
+    if (static_cast<unsigned>(registers[0]) < 0x80000007u) {
+        return false;
     }
-    std::cerr << "Unknown log level: " << level.toStdString() << std::endl;
-    return false;
+    __cpuid(registers, 0x80000007);
+    return (registers[3] & (1 << 8)) != 0;
+#else
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u) {
+        return false;
+    }
+    __get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+#endif
 }
 
-inline QString get_level() {
-    auto level = spdlog::get_level();
-    const auto& level_map = details::get_level_to_string_map();
-    auto it = level_map.find(level);
-    return it != level_map.end() ? it.value() : "unknown";
+// Пара (TSC, realtime) с самым узким окном из нескольких попыток
+inline tsc_sample sample_tsc() {
+    tsc_sample result;
+    std::uint64_t best_window = std::numeric_limits<std::uint64_t>::max();
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        const std::uint64_t before = read_tsc();
+        const std::int64_t ns = realtime_ns();
+        const std::uint64_t after = read_tsc();
+        if (after - before < best_window) {
+            best_window = after - before;
+            result.ticks = before + (after - before) / 2;
+            result.ns = ns;
+        }
+    }
+    return result;
 }
 
-inline bool set_level(QtMsgType level) {
-    const auto& level_map = details::get_qt_to_spdlog_map();
-    auto it = level_map.find(level);
-    if (it != level_map.end()) {
-        spdlog::set_level(it.value());
-        return true;
-    }
-    std::cerr << "Unknown Qt message type: " << static_cast<int>(level) << std::endl;
-    return false;
+inline double ns_per_tick(const tsc_sample& from, const tsc_sample& to) {
+    return static_cast<double>(to.ns - from.ns) / static_cast<double>(to.ticks - from.ticks);
 }
 
-inline QtMsgType get_qt_level() {
-    auto level = spdlog::get_level();
-    const auto& level_map = details::get_spdlog_to_qt_map();
-    auto it = level_map.find(level);
-    return it != level_map.end() ? it.value() : QtMsgType::QtInfoMsg;
+// Единственный писатель - set_source или поток перекалибровки
+inline void publish_epoch(clock_state& state, const tsc_line& line) {
+    const std::uint64_t sequence = state.tsc_sequence.load(std::memory_order_relaxed) + 1;
+    auto& epoch = state.epochs[sequence % tsc_epoch_count];
+    epoch.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    epoch.base_ticks.store(line.base_ticks, std::memory_order_relaxed);
+    epoch.base_ns.store(line.base_ns, std::memory_order_relaxed);
+    epoch.ns_per_tick.store(line.ns_per_tick, std::memory_order_relaxed);
+    epoch.sequence.store(sequence, std::memory_order_release);
+    state.tsc_sequence.store(sequence, std::memory_order_release);
 }
 
-inline bool is_valid_level(const QString& level) {
-    const auto& level_map = details::get_string_to_level_map();
-    return level_map.contains(level.toLower());
+// false, если слот уже перезаписан более новой эпохой
+inline bool load_epoch(const clock_state& state, std::uint64_t sequence, tsc_line& line) {
+    const auto& epoch = state.epochs[sequence % tsc_epoch_count];
+    if (epoch.sequence.load(std::memory_order_acquire) != sequence) {
+        return false;
+    }
+    line.base_ticks = epoch.base_ticks.load(std::memory_order_relaxed);
+    line.base_ns = epoch.base_ns.load(std::memory_order_relaxed);
+    line.ns_per_tick = epoch.ns_per_tick.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return epoch.sequence.load(std::memory_order_relaxed) == sequence;
 }
 
-inline QString get_level_display_name(const QString& level_str) {
-    spdlog::level::level_enum level = string_to_level(level_str);
-    return level_to_string(level);
+// Такты переводятся по эпохе, действовавшей в момент их снятия, поэтому backend
+// получает то же время, что дал бы now() в потоке логирования
+inline std::int64_t tsc_to_ns(std::uint64_t ticks) {
+    const auto& state = get_state();
+    for (;;) {
+        std::uint64_t sequence = state.tsc_sequence.load(std::memory_order_acquire);
+        if (sequence == 0) {
+            return realtime_ns();
+        }
+        const std::uint64_t oldest = sequence > tsc_epoch_count ? sequence - tsc_epoch_count + 1 : 1;
+        tsc_line line;
+        while (load_epoch(state, sequence, line)) {
+            if (ticks >= line.base_ticks || sequence == oldest) {
+                return line.to_ns(ticks);
+            }
+            --sequence;
+        }
+    }
 }
 
-inline QStringList get_level_aliases(const QString& canonical_level) {
-    auto& map = details::get_string_to_level_map();
-    QStringList aliases;
+inline tsc_line latest_line(const clock_state& state) {
+    tsc_line line;
+    while (!load_epoch(state, state.tsc_sequence.load(std::memory_order_acquire), line)) {
+    }
+    return line;
+}
 
-    spdlog::level::level_enum target_level = string_to_level(canonical_level);
+// Перекалибровка раз в period. Новая эпоха начинается немного в будущем (чтобы
+// читатели не застали ее посреди своего перевода) и продолжает старую прямую
+// без разрыва: метки остаются монотонными, а расхождение с системными часами
+// выбирается наклоном не быстрее 1000 ppm. Частота считается от первой пары,
+// поэтому с каждым периодом становится точнее. Переставленные больше чем на
+// секунду системные часы - единственный случай, когда метка прыгает
+inline void recalibrate_loop(clock_state& state, std::chrono::milliseconds period, tsc_sample origin) {
+    constexpr double max_slew = 0.001;
+    constexpr std::int64_t step_threshold_ns = 1000000000;
+    const auto period_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(period).count());
+    const auto margin_ns = std::min<std::int64_t>(1000000, static_cast<std::int64_t>(period_ns / 4));
+
+    std::unique_lock<std::mutex> lock(state.recalibration_mutex);
+    while (!state.recalibration_wake.wait_for(lock, period, [&state] { return state.recalibration_stopping; })) {
+        const tsc_sample sample = sample_tsc();
+        const double rate = ns_per_tick(origin, sample);
+        const auto margin_ticks = static_cast<std::uint64_t>(static_cast<double>(margin_ns) / rate);
+
+        tsc_line next;
+        next.base_ticks = sample.ticks + margin_ticks;
+        next.base_ns = latest_line(state).to_ns(next.base_ticks);
+        next.ns_per_tick = rate;
+        const std::int64_t error = sample.ns + margin_ns - next.base_ns;
+        if (error > step_threshold_ns || error < -step_threshold_ns) {
+            next.base_ns = sample.ns + margin_ns;
+            origin = sample;
+        } else {
+            next.ns_per_tick = rate * (1.0 + std::clamp(static_cast<double>(error) / period_ns, -max_slew, max_slew));
+        }
 
-    for (auto it = map.begin(); it != map.end(); ++it) {
-        if (it.value() == target_level && it.key() != canonical_level) {
-            aliases.append(it.key());
+        // Поток вытеснили и начало эпохи уже наступило - пропускаем период
+        if (read_tsc() < next.base_ticks) {
+            publish_epoch(state, next);
         }
     }
-
-    return aliases;
 }
+#endif
 
-// Получение отображаемого имени с учетом алиасов
-inline QString get_level_display_name_with_aliases(const QString& level_str) {
-    QString canonical = get_level_display_name(level_str);
-    QStringList aliases = get_level_aliases(canonical);
+// Дата и время до секунд в местном времени: одна строка на поток на секунду,
+// общая для JSON и текстовых паттернов
+struct local_second {
+    std::time_t second = -1;
+    char text[20]; // "yyyy-MM-dd HH:mm:ss"
+};
 
-    if (aliases.isEmpty()) {
-        return canonical;
+inline const local_second& render_second(spdlog::log_clock::time_point time) {
+    thread_local local_second cache;
+    const std::time_t second = spdlog::log_clock::to_time_t(time);
+    if (second != cache.second) {
+        const std::tm local = spdlog::details::os::localtime(second);
+        fmt::format_to_n(cache.text, sizeof(cache.text), "{:04}-{:02}-{:02} {:02}:{:02}:{:02}",
+                         local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+                         local.tm_hour, local.tm_min, local.tm_sec);
+        cache.second = second;
     }
-
-    return QString("%1 (алиасы: %2)").arg(canonical).arg(aliases.join(", "));
+    return cache;
 }
 
-inline QStringList get_available_levels() {
-    const auto& level_map = details::get_string_to_level_map();
-    return level_map.keys();
+} // namespace details
+
+inline source current_source() {
+    return static_cast<source>(details::get_state().current.load(std::memory_order_acquire));
 }
 
-inline QStringList get_canonical_levels() {
-    auto& map = details::get_level_to_string_map();
-    QStringList levels;
-    levels.reserve(map.size());
+inline bool is_available(source value) {
+    switch (value) {
+    case source::realtime:
+        return true;
+    case source::realtime_coarse:
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+        return true;
+#else
+        return false;
+#endif
+    case source::tsc:
+#ifdef QT_SPDLOG_HAS_TSC
+        return details::has_invariant_tsc();
+#else
+        return false;
+#endif
+    }
+    return false;
+}
 
-    // Сохраняем порядок от trace до off
-    for (int i = static_cast<int>(spdlog::level::trace);
-         i <= static_cast<int>(spdlog::level::off);
-         ++i) {
-        auto level = static_cast<spdlog::level::level_enum>(i);
-        if (map.contains(level)) {
-            levels.append(map.value(level));
+// Меняет источник времени; false, если он недоступен на этой платформе (без
+// инвариантного TSC остается прежний источник). Для TSC поток спит calibration
+// на первую калибровку, затем фоновый поток уточняет ее каждые recalibration
+// (0 - без перекалибровки)
+inline bool set_source(source value,
+                       std::chrono::milliseconds calibration = std::chrono::milliseconds(20),
+                       std::chrono::milliseconds recalibration = std::chrono::seconds(1)) {
+    if (!is_available(value)) {
+        return false;
+    }
+    auto& state = details::get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+#ifdef QT_SPDLOG_HAS_TSC
+    state.stop_recalibrator();
+    if (value == source::tsc) {
+        const details::tsc_sample origin = details::sample_tsc();
+        std::this_thread::sleep_for(calibration);
+        const details::tsc_sample sample = details::sample_tsc();
+        details::publish_epoch(state, details::tsc_line{sample.ticks, sample.ns, details::ns_per_tick(origin, sample)});
+        if (recalibration.count() > 0) {
+            state.recalibrator = std::thread([&state, recalibration, origin] {
+                details::recalibrate_loop(state, recalibration, origin);
+            });
         }
     }
+#else
+    (void)calibration;
+    (void)recalibration;
+#endif
+    state.current.store(static_cast<int>(value), std::memory_order_release);
+    return true;
+}
 
-    return levels;
+// Одно чтение часов выбранного источника
+inline spdlog::log_clock::time_point now() {
+    switch (current_source()) {
+#if defined(__linux__) && defined(CLOCK_REALTIME_COARSE)
+    case source::realtime_coarse: {
+        timespec ts;
+        ::clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return details::from_ns(static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec);
+    }
+#endif
+#ifdef QT_SPDLOG_HAS_TSC
+    case source::tsc:
+        return details::from_ns(details::tsc_to_ns(details::read_tsc()));
+#endif
+    default:
+        return spdlog::log_clock::now();
+    }
 }
 
-inline QMap<QString, QString> get_levels_with_display_names() {
-    QMap<QString, QString> result;
-    const auto& level_map = details::get_string_to_level_map();
+// Сырое показание часов. Для TSC это такты: запись в очереди хранит их, а во
+// время их переводит to_time() в потоке backend по таблице калибровок
+struct stamp {
+    std::uint64_t ticks = 0; // 0 - время уже в time
+    spdlog::log_clock::time_point time;
+};
 
-    for (auto it = level_map.begin(); it != level_map.end(); ++it) {
-        result[it.key()] = get_level_display_name(it.key());
+inline stamp capture() {
+#ifdef QT_SPDLOG_HAS_TSC
+    if (current_source() == source::tsc) {
+        return stamp{details::read_tsc(), {}};
     }
+#endif
+    return stamp{0, now()};
+}
 
-    return result;
+inline spdlog::log_clock::time_point to_time(const stamp& value) {
+#ifdef QT_SPDLOG_HAS_TSC
+    if (value.ticks != 0) {
+        return details::from_ns(details::tsc_to_ns(value.ticks));
+    }
+#endif
+    return value.time;
 }
 
-inline void setup_display_always() {
-    auto& registry = spdlog::details::registry::instance();
+} // namespace timestamps
 
-    // Применяем функцию ко всем зарегистрированным логгерам
-    registry.apply_all([](const std::shared_ptr<spdlog::logger>& logger) {
-        // Для каждого логгера настраиваем цвета во всех console sink'ах
-        for (auto& sink : logger->sinks()) {
-            if (auto console_sink = std::dynamic_pointer_cast<spdlog::sinks::stdout_color_sink_mt>(sink)) {
+// ============================================================================
+// ГИСТОГРАММЫ ЗАДЕРЖЕК
+// ============================================================================
 
-#ifdef _WIN32
-                // Для Windows использовать Windows API цвета
-                console_sink->set_color(spdlog::level::off, 0x5); // cyan
+// Задержка каждого вызова в гистограмме в стиле HdrHistogram: 64 ячейки на
+// октаву (погрешность до 1/64, около 1.6%) до 2^40 тактов. Каждый поток пишет в
+// свою гистограмму, они складываются только при чтении отчета; гистограмма
+// завершившегося потока прибавляется к общей и освобождается. Замер - TSC, если он
+// инвариантный, иначе steady_clock; такты переводятся в нс при чтении отчета
+// по паре (TSC, steady_clock), снятой при создании первого recorder'а
+
+namespace latency {
+
+namespace details {
+
+constexpr unsigned sub_bucket_bits = 7;
+constexpr std::uint64_t sub_bucket_count = std::uint64_t(1) << sub_bucket_bits;
+constexpr std::uint64_t sub_bucket_half = sub_bucket_count / 2;
+constexpr unsigned value_bits = 40;
+constexpr std::uint64_t max_value = (std::uint64_t(1) << value_bits) - 1;
+constexpr std::size_t bucket_count = sub_bucket_count + (value_bits - sub_bucket_bits) * sub_bucket_half;
+
+inline unsigned highest_bit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
 #else
-                // Для Linux/Mac использовать ANSI коды
-                console_sink->set_color(spdlog::level::off, "\033[1;36m"); // bright cyan
+    unsigned bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
 #endif
-                // #define FOREGROUND_BLUE 0x1
-                // #define FOREGROUND_GREEN 0x2
-                // #define FOREGROUND_RED 0x4
-                // #define FOREGROUND_INTENSITY 0x8
-                // #define BACKGROUND_BLUE 0x10
-                // #define BACKGROUND_GREEN 0x20
-                // #define BACKGROUND_RED 0x40
-                // #define BACKGROUND_INTENSITY 0x80
+}
+
+inline std::size_t bucket_index(std::uint64_t value) {
+    value = std::min(value, max_value);
+    if (value < sub_bucket_count) {
+        return static_cast<std::size_t>(value);
+    }
+    const unsigned shift = highest_bit(value) - (sub_bucket_bits - 1);
+    return static_cast<std::size_t>(sub_bucket_count + (shift - 1) * sub_bucket_half + ((value >> shift) - sub_bucket_half));
+}
+
+// Наибольшее значение, попадающее в ячейку
+inline std::uint64_t bucket_upper(std::size_t index) {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+    const std::uint64_t offset = index - sub_bucket_count;
+    const std::uint64_t shift = offset / sub_bucket_half + 1;
+    const std::uint64_t top = offset % sub_bucket_half + sub_bucket_half;
+    return ((top + 1) << shift) - 1;
+}
+
+inline bool use_tsc() {
+    static const bool value = timestamps::is_available(timestamps::source::tsc);
+    return value;
+}
+
+inline std::int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline std::uint64_t now_ticks() {
+#ifdef QT_SPDLOG_HAS_TSC
+    if (use_tsc()) {
+        return timestamps::details::read_tsc();
+    }
+#endif
+    return static_cast<std::uint64_t>(steady_ns());
+}
+
+struct clock_origin {
+    std::uint64_t ticks = now_ticks();
+    std::int64_t ns = steady_ns();
+};
+
+inline const clock_origin& origin() {
+    static const clock_origin value;
+    return value;
+}
+
+// Чем позже читается отчет, тем длиннее база и точнее перевод
+inline double ns_per_tick() {
+    if (!use_tsc()) {
+        return 1.0;
+    }
+    const std::uint64_t ticks = now_ticks();
+    const std::int64_t ns = steady_ns();
+    const auto& start = origin();
+    return ticks > start.ticks ? static_cast<double>(ns - start.ns) / static_cast<double>(ticks - start.ticks) : 1.0;
+}
+
+// Гистограмма одного потока: пишет только владелец, поэтому запись - обычные
+// загрузка и сохранение без атомарного чтения-изменения-записи. Атомарность
+// нужна только для чтения отчетом из другого потока
+struct shard {
+    std::array<std::atomic<std::uint64_t>, bucket_count> counts{};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> max{0};
+
+    void add(std::uint64_t ticks) {
+        auto& count = counts[bucket_index(ticks)];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+        if (ticks > max.load(std::memory_order_relaxed)) {
+            max.store(ticks, std::memory_order_relaxed);
+        }
+    }
+
+    // Только под мьютексом shard_set: в накопитель пишет один поток за раз
+    void merge(const shard& other) {
+        for (std::size_t i = 0; i < bucket_count; ++i) {
+            counts[i].store(counts[i].load(std::memory_order_relaxed) + other.counts[i].load(std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+        }
+        sum.store(sum.load(std::memory_order_relaxed) + other.sum.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+        max.store(std::max(max.load(std::memory_order_relaxed), other.max.load(std::memory_order_relaxed)),
+                  std::memory_order_relaxed);
+    }
+
+    // Запись, идущая в момент сброса, может вернуть ячейке прежнее значение
+    void reset() {
+        for (auto& count : counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Гистограммы живых потоков одного recorder'а и сумма завершившихся
+struct shard_set {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<shard>> shards;
+    shard retired;
+};
+
+// Гистограммы потока по серийным номерам recorder'ов. При выходе потока каждая
+// прибавляется к retired своего recorder'а и освобождается; гистограммы уже
+// удаленных recorder'ов освобождены вместе с ними
+struct local_shards {
+    struct entry {
+        std::uint64_t serial;
+        shard* values;
+        std::weak_ptr<shard_set> owner;
+    };
+    std::vector<entry> entries;
+
+    local_shards() = default;
+    local_shards(const local_shards&) = delete;
+    local_shards& operator=(const local_shards&) = delete;
+
+    ~local_shards() {
+        for (const auto& entry : entries) {
+            const auto set = entry.owner.lock();
+            if (!set) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(set->mutex);
+            set->retired.merge(*entry.values);
+            auto& shards = set->shards;
+            shards.erase(std::find_if(shards.begin(), shards.end(),
+                                      [&entry](const auto& shard) { return shard.get() == entry.values; }));
+        }
+    }
+};
+
+} // namespace details
+
+// Сведенная гистограмма: значения в тактах, отчет - в наносекундах
+class histogram {
+public:
+    explicit histogram(double ns_per_tick = 1.0)
+        : counts_(details::bucket_count, 0)
+        , ns_per_tick_(ns_per_tick) {}
+
+    void record(std::uint64_t ticks, std::uint64_t count = 1) {
+        counts_[details::bucket_index(ticks)] += count;
+        total_ += count;
+        sum_ += ticks * count;
+        max_ = std::max(max_, ticks);
+    }
+
+    void merge(const histogram& other) {
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t count() const { return total_; }
+    double max() const { return static_cast<double>(max_) * ns_per_tick_; }
+    double mean() const { return total_ ? static_cast<double>(sum_) / static_cast<double>(total_) * ns_per_tick_ : 0.0; }
+
+    // percentile в процентах: 50, 99, 99.9
+    double percentile(double percentile) const {
+        if (total_ == 0) {
+            return 0.0;
+        }
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(
+            std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(total_))));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return static_cast<double>(std::min(details::bucket_upper(i), max_)) * ns_per_tick_;
+            }
+        }
+        return max();
+    }
+
+private:
+    friend class recorder;
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t total_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t max_ = 0;
+    double ns_per_tick_;
+};
+
+// Источник замеров: потоки пишут без блокировок, snapshot() сводит их гистограммы
+class recorder {
+public:
+    recorder()
+        : serial_(next_serial())
+        , shards_(std::make_shared<details::shard_set>()) {
+        details::origin();
+    }
+
+    recorder(const recorder&) = delete;
+    recorder& operator=(const recorder&) = delete;
+
+    // Замер области видимости
+    class scope {
+    public:
+        explicit scope(recorder& target) : target_(target), start_(details::now_ticks()) {}
+        ~scope() { target_.record_ticks(details::now_ticks() - start_); }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        recorder& target_;
+        std::uint64_t start_;
+    };
+
+    void record_ticks(std::uint64_t ticks) { local_shard().add(ticks); }
+
+    histogram snapshot() const {
+        histogram result(details::ns_per_tick());
+        const auto add = [&result](const details::shard& shard) {
+            for (std::size_t i = 0; i < details::bucket_count; ++i) {
+                result.counts_[i] += shard.counts[i].load(std::memory_order_relaxed);
+            }
+            result.sum_ += shard.sum.load(std::memory_order_relaxed);
+            result.max_ = std::max(result.max_, shard.max.load(std::memory_order_relaxed));
+        };
+        std::lock_guard<std::mutex> lock(shards_->mutex);
+        add(shards_->retired);
+        for (const auto& shard : shards_->shards) {
+            add(*shard);
+        }
+        for (const auto count : result.counts_) {
+            result.total_ += count;
+        }
+        return result;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(shards_->mutex);
+        shards_->retired.reset();
+        for (auto& shard : shards_->shards) {
+            shard->reset();
+        }
+    }
+
+private:
+    static std::uint64_t next_serial() {
+        static std::atomic<std::uint64_t> serial{1};
+        return serial.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Гистограмма потока ищется по серийному номеру recorder'а: номера не
+    // повторяются, поэтому записи удаленных recorder'ов в кэше никогда не совпадут
+    details::shard& local_shard() {
+        thread_local details::local_shards cache;
+        for (const auto& entry : cache.entries) {
+            if (entry.serial == serial_) {
+                return *entry.values;
+            }
+        }
+        std::lock_guard<std::mutex> lock(shards_->mutex);
+        shards_->shards.push_back(std::make_unique<details::shard>());
+        cache.entries.push_back({serial_, shards_->shards.back().get(), shards_});
+        return *shards_->shards.back();
+    }
+
+    const std::uint64_t serial_;
+    // Общий с кэшами потоков: поток, завершившийся после recorder'а, его не трогает
+    const std::shared_ptr<details::shard_set> shards_;
+};
+
+// Строка отчета: "name: count=N p50=.. p99=.. p99.9=.. max=.. ns"
+inline std::string format(const std::string& name, const histogram& values) {
+    return fmt::format("{}: count={} p50={:.0f} p99={:.0f} p99.9={:.0f} max={:.0f} mean={:.1f} ns",
+                       name, values.count(), values.percentile(50), values.percentile(99),
+                       values.percentile(99.9), values.max(), values.mean());
+}
+
+namespace details {
+
+// Именованные recorder'ы живут до конца процесса
+struct registry_state {
+    std::mutex mutex;
+    std::map<std::string, std::shared_ptr<recorder>> recorders;
+    std::atomic<recorder*> logging{nullptr};
+};
+
+inline registry_state& get_registry() {
+    static registry_state state;
+    return state;
+}
+
+} // namespace details
+
+inline std::shared_ptr<recorder> get(const std::string& name) {
+    auto& state = details::get_registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto& entry = state.recorders[name];
+    if (!entry) {
+        entry = std::make_shared<recorder>();
+    }
+    return entry;
+}
+
+// Отчет по всем именованным recorder'ам, по строке на каждый
+inline std::string report() {
+    auto& state = details::get_registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    std::string result;
+    for (const auto& [name, entry] : state.recorders) {
+        result += format(name, entry->snapshot());
+        result += '\n';
+    }
+    return result;
+}
+
+inline void reset_all() {
+    auto& state = details::get_registry();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (const auto& [name, entry] : state.recorders) {
+        entry->reset();
+    }
+}
+
+// Замер каждого вызова макросов QT_LOG_*/QT_LOGGER_* (в том числе _KV, _JSON,
+// _LOCATION, ALWAYS и исключений), прошедшего проверку уровня, в recorder
+// "qt_spdlog.log": от проверки уровня до возврата, с преобразованием аргументов
+// и контекстным окном. Выключенный замер стоит одной атомарной загрузки
+inline void instrument_logging(bool enabled) {
+    details::get_registry().logging.store(enabled ? get("qt_spdlog.log").get() : nullptr,
+                                          std::memory_order_release);
+}
+
+namespace details {
+
+class call_timer {
+public:
+    call_timer() : recorder_(get_registry().logging.load(std::memory_order_acquire)) {
+        if (recorder_) {
+            start_ = now_ticks();
+        }
+    }
+
+    ~call_timer() {
+        if (recorder_) {
+            recorder_->record_ticks(now_ticks() - start_);
+        }
+    }
+
+    call_timer(const call_timer&) = delete;
+    call_timer& operator=(const call_timer&) = delete;
+
+private:
+    recorder* recorder_;
+    std::uint64_t start_ = 0;
+};
+
+} // namespace details
+
+} // namespace latency
+
+namespace details {
+
+// Запись макросов QT_LOG_*: сообщение форматируется здесь, метка времени - из
+// timestamps::now(). Ошибку формата повторный вызов через spdlog передает
+// обработчику ошибок логгера, как и раньше
+template<typename First, typename... Args>
+inline void format_and_log(spdlog::logger& logger, spdlog::level::level_enum level, First&& first, Args&&... args) {
+    if constexpr (sizeof...(Args) == 0) {
+        if constexpr (std::is_convertible_v<const std::decay_t<First>&, spdlog::string_view_t>) {
+            logger.log(timestamps::now(), spdlog::source_loc{}, level, spdlog::string_view_t(first));
+        } else {
+            format_and_log(logger, level, "{}", first);
+        }
+    } else {
+        spdlog::memory_buf_t buffer;
+        try {
+            fmt::vformat_to(std::back_inserter(buffer), fmt::string_view(first), fmt::make_format_args(args...));
+        }
+        catch (const std::exception&) {
+            logger.log(level, std::forward<First>(first), std::forward<Args>(args)...);
+            return;
+        }
+        logger.log(timestamps::now(), spdlog::source_loc{}, level, spdlog::string_view_t(buffer.data(), buffer.size()));
+    }
+}
+
+} // namespace details
+
+namespace json {
+
+// ----------------------------------------------------------------------------
+// Потоковая запись JSON прямо в буфер spdlog.
+// Вывод побайтно совпадает с QJsonDocument::toJson(QJsonDocument::Compact):
+// ключи объектов в порядке QJsonObject, те же правила экранирования и чисел.
+// Типы, которые writer не знает, сериализуются через QJsonValue::fromVariant
+// ----------------------------------------------------------------------------
+
+namespace details {
+
+inline char hex_digit(unsigned value) {
+    return static_cast<char>(value < 10 ? '0' + value : 'a' + value - 10);
+}
+
+inline void append_unicode_escape(spdlog::memory_buf_t& buffer, char16_t code) {
+    const char escaped[6] = {'\\', 'u', hex_digit((code >> 12) & 0xF), hex_digit((code >> 8) & 0xF),
+                             hex_digit((code >> 4) & 0xF), hex_digit(code & 0xF)};
+    buffer.append(escaped, escaped + 6);
+}
+
+// Экранирует одну единицу UTF-16 (или суррогатную пару) так же, как writer QJsonDocument.
+// Возвращает число использованных единиц
+inline std::size_t append_escaped_char(char*& out, const char16_t* data, std::size_t index, std::size_t size) {
+    char16_t code = data[index];
+    if (code < 0x80) {
+        if (code >= 0x20 && code != '"' && code != '\\') {
+            *out++ = static_cast<char>(code);
+            return 1;
+        }
+        *out++ = '\\';
+        switch (code) {
+        case '"': *out++ = '"'; break;
+        case '\\': *out++ = '\\'; break;
+        case '\b': *out++ = 'b'; break;
+        case '\f': *out++ = 'f'; break;
+        case '\n': *out++ = 'n'; break;
+        case '\r': *out++ = 'r'; break;
+        case '\t': *out++ = 't'; break;
+        default:
+            *out++ = 'u';
+            *out++ = '0';
+            *out++ = '0';
+            *out++ = hex_digit(code >> 4);
+            *out++ = hex_digit(code & 0xF);
+        }
+        return 1;
+    }
+    if (code < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (code >> 6));
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+        return 1;
+    }
+    if (code >= 0xD800 && code <= 0xDFFF) {
+        if (code <= 0xDBFF && index + 1 < size && data[index + 1] >= 0xDC00 && data[index + 1] <= 0xDFFF) {
+            char32_t full = 0x10000 + ((char32_t(code) - 0xD800) << 10) + (data[index + 1] - 0xDC00);
+            *out++ = static_cast<char>(0xF0 | (full >> 18));
+            *out++ = static_cast<char>(0x80 | ((full >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((full >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (full & 0x3F));
+            return 2;
+        }
+        // Одиночный суррогат Qt записывает escape-последовательностью
+        const char escaped[6] = {'\\', 'u', hex_digit((code >> 12) & 0xF), hex_digit((code >> 8) & 0xF),
+                                 hex_digit((code >> 4) & 0xF), hex_digit(code & 0xF)};
+        std::memcpy(out, escaped, 6);
+        out += 6;
+        return 1;
+    }
+    *out++ = static_cast<char>(0xE0 | (code >> 12));
+    *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    return 1;
+}
+
+// Строка в кавычках. Быстрый путь SSE2: блоки по 8 единиц без символов,
+// требующих экранирования, и без не-ASCII упаковываются в байты одной инструкцией
+inline void append_string(spdlog::memory_buf_t& buffer, QStringView text) {
+    const auto* data = reinterpret_cast<const char16_t*>(text.utf16());
+    const auto size = static_cast<std::size_t>(text.size());
+
+    // Худший случай - 6 байт на единицу UTF-16 (\u00XX) плюс кавычки
+    const std::size_t offset = buffer.size();
+    buffer.resize(offset + size * 6 + 2);
+    char* out = buffer.data() + offset;
+    *out++ = '"';
+
+    std::size_t i = 0;
+#ifdef QT_SPDLOG_JSON_SSE2
+    const __m128i sign = _mm_set1_epi16(static_cast<short>(0x8000));
+    const __m128i control = _mm_set1_epi16(static_cast<short>(0x20 ^ 0x8000));
+    const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0x7F ^ 0x8000));
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i backslash = _mm_set1_epi16('\\');
+    while (i + 8 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Беззнаковое сравнение 16-битных значений через сдвиг знакового бита
+        __m128i biased = _mm_xor_si128(chunk, sign);
+        __m128i special = _mm_or_si128(_mm_cmplt_epi16(biased, control), _mm_cmpgt_epi16(biased, non_ascii));
+        special = _mm_or_si128(special, _mm_or_si128(_mm_cmpeq_epi16(chunk, quote), _mm_cmpeq_epi16(chunk, backslash)));
+        if (_mm_movemask_epi8(special) != 0) {
+            i += append_escaped_char(out, data, i, size);
+            continue;
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(chunk, chunk));
+        out += 8;
+        i += 8;
+    }
+#endif
+    while (i < size) {
+        i += append_escaped_char(out, data, i, size);
+    }
+
+    *out++ = '"';
+    buffer.resize(static_cast<std::size_t>(out - buffer.data()));
+}
+
+inline void append_string(spdlog::memory_buf_t& buffer, spdlog::string_view_t ascii) {
+    buffer.push_back('"');
+    buffer.append(ascii);
+    buffer.push_back('"');
+}
+
+// Целые числа без дробной части QJsonDocument печатает как целые, остальные - кратчайшими
+// цифрами в более короткой из десятичной и экспоненциальной форм (при равенстве - десятичная,
+// порядок не короче двух цифр), как QByteArray::number(d, 'g', QLocale::FloatingPointShortest).
+// Бесконечность и NaN становятся null
+inline void append_double(spdlog::memory_buf_t& buffer, double value) {
+    if (!std::isfinite(value)) {
+        buffer.append(spdlog::string_view_t("null"));
+        return;
+    }
+    if (std::signbit(value)) {
+        buffer.push_back('-');
+    }
+    const double magnitude = std::fabs(value);
+    if (magnitude < 18446744073709551616.0 && std::floor(magnitude) == magnitude) {
+        fmt::format_to(std::back_inserter(buffer), "{}", static_cast<unsigned long long>(magnitude));
+        return;
+    }
+
+    // Кратчайшие значащие цифры и позиция точки из представления fmt
+    fmt::basic_memory_buffer<char, 32> shortest;
+    fmt::format_to(std::back_inserter(shortest), "{}", magnitude);
+    char digits[32];
+    int digit_count = 0;
+    int decimal_point = 0; // число цифр до точки
+    bool seen_point = false;
+    bool leading = true;
+    const char* it = shortest.data();
+    const char* end = it + shortest.size();
+    for (; it != end && *it != 'e'; ++it) {
+        if (*it == '.') {
+            seen_point = true;
+        } else if (leading && *it == '0') {
+            if (seen_point) {
+                --decimal_point;
+            }
+        } else {
+            leading = false;
+            digits[digit_count++] = *it;
+            if (!seen_point) {
+                ++decimal_point;
+            }
+        }
+    }
+    if (it != end) {
+        // Буфер fmt не завершен нулем, порядок разбирается до конца представления
+        bool negative = *++it == '-';
+        int exponent = 0;
+        for (it += (*it == '-' || *it == '+'); it != end; ++it) {
+            exponent = exponent * 10 + (*it - '0');
+        }
+        decimal_point += negative ? -exponent : exponent;
+    }
+    while (digit_count > 1 && digits[digit_count - 1] == '0') {
+        --digit_count;
+    }
+
+    const int exponent = decimal_point - 1;
+    const int exponent_digits = std::abs(exponent) >= 100 ? 3 : 2;
+    const int exponent_length = digit_count + (digit_count > 1 ? 1 : 0) + 2 + exponent_digits;
+    const int decimal_length = decimal_point <= 0 ? 2 - decimal_point + digit_count
+                             : decimal_point < digit_count ? digit_count + 1
+                             : decimal_point;
+
+    if (decimal_length <= exponent_length) {
+        if (decimal_point <= 0) {
+            buffer.append(spdlog::string_view_t("0."));
+            for (int i = decimal_point; i < 0; ++i) {
+                buffer.push_back('0');
+            }
+            buffer.append(digits, digits + digit_count);
+        } else if (decimal_point < digit_count) {
+            buffer.append(digits, digits + decimal_point);
+            buffer.push_back('.');
+            buffer.append(digits + decimal_point, digits + digit_count);
+        } else {
+            buffer.append(digits, digits + digit_count);
+            for (int i = digit_count; i < decimal_point; ++i) {
+                buffer.push_back('0');
+            }
+        }
+        return;
+    }
+
+    buffer.push_back(digits[0]);
+    if (digit_count > 1) {
+        buffer.push_back('.');
+        buffer.append(digits + 1, digits + digit_count);
+    }
+    fmt::format_to(std::back_inserter(buffer), "e{}{:02}", exponent < 0 ? '-' : '+', std::abs(exponent));
+}
+
+inline void append_fallback(spdlog::memory_buf_t& buffer, const QVariant& value) {
+    QByteArray encoded = QJsonDocument(QJsonArray{QJsonValue::fromVariant(value)}).toJson(QJsonDocument::Compact);
+    // Снимаем обертку массива "[...]"
+    buffer.append(encoded.constData() + 1, encoded.constData() + encoded.size() - 1);
+}
+
+} // namespace details
+
+inline void write_value(spdlog::memory_buf_t& buffer, const QVariant& value);
+
+inline void write_value(spdlog::memory_buf_t& buffer, const QString& value) {
+    details::append_string(buffer, value);
+}
+
+inline void write_object(spdlog::memory_buf_t& buffer, const QVariantMap& object) {
+    buffer.push_back('{');
+    bool first = true;
+    for (auto it = object.cbegin(); it != object.cend(); ++it) {
+        if (!first) {
+            buffer.push_back(',');
+        }
+        first = false;
+        details::append_string(buffer, it.key());
+        buffer.push_back(':');
+        write_value(buffer, it.value());
+    }
+    buffer.push_back('}');
+}
+
+// QJsonObject хранит ключи отсортированными, поэтому ключи QVariantHash упорядочиваются
+inline void write_object(spdlog::memory_buf_t& buffer, const QVariantHash& object) {
+    std::vector<QVariantHash::const_iterator> entries;
+    entries.reserve(static_cast<std::size_t>(object.size()));
+    for (auto it = object.cbegin(); it != object.cend(); ++it) {
+        entries.push_back(it);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& left, const auto& right) { return left.key() < right.key(); });
+
+    buffer.push_back('{');
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (i > 0) {
+            buffer.push_back(',');
+        }
+        details::append_string(buffer, entries[i].key());
+        buffer.push_back(':');
+        write_value(buffer, entries[i].value());
+    }
+    buffer.push_back('}');
+}
+
+template<typename Container>
+inline void write_array(spdlog::memory_buf_t& buffer, const Container& array) {
+    buffer.push_back('[');
+    bool first = true;
+    for (const auto& item : array) {
+        if (!first) {
+            buffer.push_back(',');
+        }
+        first = false;
+        write_value(buffer, item);
+    }
+    buffer.push_back(']');
+}
+
+// Значение QVariant по правилам QJsonValue::fromVariant
+inline void write_value(spdlog::memory_buf_t& buffer, const QVariant& value) {
+    switch (value.typeId()) {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        buffer.append(spdlog::string_view_t("null"));
+        break;
+    case QMetaType::Bool:
+        buffer.append(spdlog::string_view_t(value.toBool() ? "true" : "false"));
+        break;
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        fmt::format_to(std::back_inserter(buffer), "{}", value.toLongLong());
+        break;
+    case QMetaType::UInt:
+        fmt::format_to(std::back_inserter(buffer), "{}", value.toUInt());
+        break;
+    case QMetaType::ULongLong: {
+        // Не помещающиеся в qint64 значения QJsonValue хранит как double
+        const qulonglong number = value.toULongLong();
+        if (number <= static_cast<qulonglong>(std::numeric_limits<qint64>::max())) {
+            fmt::format_to(std::back_inserter(buffer), "{}", number);
+        } else {
+            details::append_double(buffer, static_cast<double>(number));
+        }
+        break;
+    }
+    case QMetaType::Double:
+    case QMetaType::Float:
+        details::append_double(buffer, value.toDouble());
+        break;
+    case QMetaType::QString:
+        details::append_string(buffer, *static_cast<const QString*>(value.constData()));
+        break;
+    case QMetaType::QStringList:
+        write_array(buffer, *static_cast<const QStringList*>(value.constData()));
+        break;
+    case QMetaType::QVariantList:
+        write_array(buffer, *static_cast<const QVariantList*>(value.constData()));
+        break;
+    case QMetaType::QVariantMap:
+        write_object(buffer, *static_cast<const QVariantMap*>(value.constData()));
+        break;
+    case QMetaType::QVariantHash:
+        write_object(buffer, *static_cast<const QVariantHash*>(value.constData()));
+        break;
+    default:
+        details::append_fallback(buffer, value);
+        break;
+    }
+}
+
+// Метка времени в формате Qt::ISODateWithMs локального времени ("yyyy-MM-ddTHH:mm:ss.zzz").
+// Часть до секунд берется из общего кэша timestamps и пересчитывается раз в секунду
+inline void write_timestamp(spdlog::memory_buf_t& buffer, spdlog::log_clock::time_point time) {
+    const auto& second = timestamps::details::render_second(time);
+    const auto since_epoch = time.time_since_epoch();
+    const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            since_epoch - std::chrono::duration_cast<std::chrono::seconds>(since_epoch)).count();
+    const char fraction[4] = {'.', static_cast<char>('0' + millis / 100),
+                              static_cast<char>('0' + millis / 10 % 10), static_cast<char>('0' + millis % 10)};
+    buffer.push_back('"');
+    buffer.append(second.text, second.text + 10);
+    buffer.push_back('T');
+    buffer.append(second.text + 11, second.text + 19);
+    buffer.append(fraction, fraction + 4);
+    buffer.push_back('"');
+}
+
+// Запись целиком, как ее собрал бы QJsonObject: {"fields":{...},"level":"...","message":"...","timestamp":"..."}
+inline void write_record(spdlog::memory_buf_t& buffer, spdlog::level::level_enum level, const QString& message,
+                         const QVariantMap& fields, spdlog::log_clock::time_point time = timestamps::now()) {
+    buffer.push_back('{');
+    if (!fields.isEmpty()) {
+        buffer.append(spdlog::string_view_t("\"fields\":"));
+        write_object(buffer, fields);
+        buffer.push_back(',');
+    }
+    buffer.append(spdlog::string_view_t("\"level\":"));
+    details::append_string(buffer, spdlog::level::to_string_view(level));
+    buffer.append(spdlog::string_view_t(",\"message\":"));
+    details::append_string(buffer, message);
+    buffer.append(spdlog::string_view_t(",\"timestamp\":"));
+    write_timestamp(buffer, time);
+    buffer.push_back('}');
+}
+
+// Включен ли уровень для JSON записи в логгер по умолчанию
+inline bool should_log(spdlog::level::level_enum level) {
+    return spdlog::default_logger_raw()->should_log(level);
+}
+
+} // namespace json
+
+// ============================================================================
+// ПОТОКОВЫЙ КОДИРОВЩИК CBOR
+// ============================================================================
+
+// Запись CBOR (RFC 8949) прямо в буфер spdlog. Результат читается QCborValue::fromCbor
+// и QCborStreamReader; записи идут подряд как CBOR sequence (RFC 8742)
+namespace cbor {
+
+enum major_type : std::uint8_t {
+    unsigned_integer = 0,
+    negative_integer = 1,
+    byte_string = 2,
+    text_string = 3,
+    array = 4,
+    map = 5,
+    simple = 7
+};
+
+// Заголовок элемента: тип и аргумент в кратчайшей форме
+inline void write_head(spdlog::memory_buf_t& buffer, major_type type, std::uint64_t value) {
+    const auto prefix = static_cast<char>(type << 5);
+    if (value < 24) {
+        buffer.push_back(static_cast<char>(prefix | value));
+        return;
+    }
+    int bytes = value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFFull ? 4 : 8;
+    char head[9];
+    head[0] = static_cast<char>(prefix | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27));
+    for (int i = 0; i < bytes; ++i) {
+        head[bytes - i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    buffer.append(head, head + bytes + 1);
+}
+
+inline void write_uint(spdlog::memory_buf_t& buffer, std::uint64_t value) {
+    write_head(buffer, unsigned_integer, value);
+}
+
+inline void write_int(spdlog::memory_buf_t& buffer, std::int64_t value) {
+    if (value >= 0) {
+        write_head(buffer, unsigned_integer, static_cast<std::uint64_t>(value));
+    } else {
+        write_head(buffer, negative_integer, static_cast<std::uint64_t>(-1 - value));
+    }
+}
+
+inline void write_bool(spdlog::memory_buf_t& buffer, bool value) {
+    buffer.push_back(static_cast<char>(value ? 0xF5 : 0xF4));
+}
+
+inline void write_null(spdlog::memory_buf_t& buffer) {
+    buffer.push_back(static_cast<char>(0xF6));
+}
+
+inline void write_double(spdlog::memory_buf_t& buffer, double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    char encoded[9];
+    encoded[0] = static_cast<char>(0xFB);
+    for (int i = 0; i < 8; ++i) {
+        encoded[8 - i] = static_cast<char>((bits >> (8 * i)) & 0xFF);
+    }
+    buffer.append(encoded, encoded + 9);
+}
+
+inline void write_text(spdlog::memory_buf_t& buffer, spdlog::string_view_t text) {
+    write_head(buffer, text_string, text.size());
+    buffer.append(text);
+}
+
+// Длина в UTF-8 считается заранее, затем текст перекодируется прямо в буфер
+inline void write_text(spdlog::memory_buf_t& buffer, QStringView text) {
+    const auto* data = reinterpret_cast<const char16_t*>(text.utf16());
+    const auto size = static_cast<std::size_t>(text.size());
+    std::size_t length = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        char16_t code = data[i];
+        if (code < 0x80) {
+            length += 1;
+        } else if (code < 0x800) {
+            length += 2;
+        } else if (code >= 0xD800 && code <= 0xDBFF && i + 1 < size && data[i + 1] >= 0xDC00 && data[i + 1] <= 0xDFFF) {
+            length += 4;
+            ++i;
+        } else {
+            length += 3; // в том числе U+FFFD вместо одиночного суррогата
+        }
+    }
+    write_head(buffer, text_string, length);
+    utils::append_utf8(buffer, text);
+}
+
+inline void write_array_head(spdlog::memory_buf_t& buffer, std::size_t count) {
+    write_head(buffer, array, count);
+}
+
+inline void write_map_head(spdlog::memory_buf_t& buffer, std::size_t count) {
+    write_head(buffer, map, count);
+}
+
+inline void write_value(spdlog::memory_buf_t& buffer, const QVariant& value);
+
+template<typename Container>
+inline void write_variant_array(spdlog::memory_buf_t& buffer, const Container& values) {
+    write_array_head(buffer, static_cast<std::size_t>(values.size()));
+    for (const auto& item : values) {
+        write_value(buffer, QVariant(item));
+    }
+}
+
+// Значение QVariant. Частые типы кодируются напрямую, остальные - через QCborValue::fromVariant
+inline void write_value(spdlog::memory_buf_t& buffer, const QVariant& value) {
+    switch (value.typeId()) {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        write_null(buffer);
+        break;
+    case QMetaType::Bool:
+        write_bool(buffer, value.toBool());
+        break;
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        write_int(buffer, value.toLongLong());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+        write_uint(buffer, value.toULongLong());
+        break;
+    case QMetaType::Double:
+    case QMetaType::Float:
+        write_double(buffer, value.toDouble());
+        break;
+    case QMetaType::QString:
+        write_text(buffer, QStringView(*static_cast<const QString*>(value.constData())));
+        break;
+    case QMetaType::QStringList: {
+        const auto& list = *static_cast<const QStringList*>(value.constData());
+        write_array_head(buffer, static_cast<std::size_t>(list.size()));
+        for (const auto& item : list) {
+            write_text(buffer, QStringView(item));
+        }
+        break;
+    }
+    case QMetaType::QVariantList:
+        write_variant_array(buffer, *static_cast<const QVariantList*>(value.constData()));
+        break;
+    case QMetaType::QVariantMap: {
+        const auto& object = *static_cast<const QVariantMap*>(value.constData());
+        write_map_head(buffer, static_cast<std::size_t>(object.size()));
+        for (auto it = object.cbegin(); it != object.cend(); ++it) {
+            write_text(buffer, QStringView(it.key()));
+            write_value(buffer, it.value());
+        }
+        break;
+    }
+    default: {
+        QByteArray encoded = QCborValue::fromVariant(value).toCbor();
+        buffer.append(encoded.constData(), encoded.constData() + encoded.size());
+        break;
+    }
+    }
+}
+
+} // namespace cbor
+
+// ============================================================================
+// СТРУКТУРИРОВАННОЕ ЛОГИРОВАНИЕ КЛЮЧ-ЗНАЧЕНИЕ
+// ============================================================================
+
+// QT_LOG_INFO_KV("Вход", kv("user_id", id), kv("latency_ms", ms)) - ключи только
+// строковые литералы, значения передаются по ссылке в исходном типе, без QVariant
+// и контейнеров. Текст записи - "сообщение key=value ..." в стиле logfmt, поэтому
+// любой sink выводит поля. Во время записи поля доступны через structured::current(),
+// и форматтеры sink'ов могут отрисовать их в другом формате (JSON, logfmt, CBOR)
+namespace structured {
+
+enum class value_format {
+    logfmt, // значение logfmt: в кавычках, только если нужно
+    json,   // значение JSON
+    cbor    // элемент CBOR
+};
+
+namespace details {
+
+// Кавычки нужны пустому значению и значению с пробелами, '=', '"' или управляющими символами
+inline bool needs_logfmt_quotes(spdlog::string_view_t text) {
+    if (text.size() == 0) {
+        return true;
+    }
+    for (char c : text) {
+        if (static_cast<unsigned char>(c) <= ' ' || c == '=' || c == '"' || c == '\\') {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void append_logfmt_string(spdlog::memory_buf_t& buffer, spdlog::string_view_t text) {
+    if (!needs_logfmt_quotes(text)) {
+        buffer.append(text);
+        return;
+    }
+    buffer.push_back('"');
+    for (char c : text) {
+        switch (c) {
+        case '"': buffer.append(spdlog::string_view_t("\\\"")); break;
+        case '\\': buffer.append(spdlog::string_view_t("\\\\")); break;
+        case '\n': buffer.append(spdlog::string_view_t("\\n")); break;
+        case '\r': buffer.append(spdlog::string_view_t("\\r")); break;
+        case '\t': buffer.append(spdlog::string_view_t("\\t")); break;
+        default: buffer.push_back(c);
+        }
+    }
+    buffer.push_back('"');
+}
+
+// Строка UTF-8 в кавычках JSON: экранируются только кавычки, '\\' и управляющие символы
+inline void append_json_utf8(spdlog::memory_buf_t& buffer, spdlog::string_view_t text) {
+    buffer.push_back('"');
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    for (const char* it = begin; it != end; ++it) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        buffer.append(begin, it);
+        begin = it + 1;
+        switch (c) {
+        case '"': buffer.append(spdlog::string_view_t("\\\"")); break;
+        case '\\': buffer.append(spdlog::string_view_t("\\\\")); break;
+        case '\b': buffer.append(spdlog::string_view_t("\\b")); break;
+        case '\f': buffer.append(spdlog::string_view_t("\\f")); break;
+        case '\n': buffer.append(spdlog::string_view_t("\\n")); break;
+        case '\r': buffer.append(spdlog::string_view_t("\\r")); break;
+        case '\t': buffer.append(spdlog::string_view_t("\\t")); break;
+        default: json::details::append_unicode_escape(buffer, static_cast<char16_t>(c));
+        }
+    }
+    buffer.append(begin, end);
+    buffer.push_back('"');
+}
+
+inline void append_string(spdlog::memory_buf_t& buffer, spdlog::string_view_t text, value_format format) {
+    if (format == value_format::json) {
+        append_json_utf8(buffer, text);
+    } else if (format == value_format::cbor) {
+        cbor::write_text(buffer, text);
+    } else {
+        append_logfmt_string(buffer, text);
+    }
+}
+
+inline void append_string(spdlog::memory_buf_t& buffer, QStringView text, value_format format) {
+    if (format == value_format::json) {
+        json::details::append_string(buffer, text);
+        return;
+    }
+    if (format == value_format::cbor) {
+        cbor::write_text(buffer, text);
+        return;
+    }
+    spdlog::memory_buf_t utf8;
+    utils::append_utf8(utf8, text);
+    append_logfmt_string(buffer, spdlog::string_view_t(utf8.data(), utf8.size()));
+}
+
+} // namespace details
+
+// Запись значения в нужном формате. Числа и bool пишутся как есть, строки Qt и STL -
+// как строки, QVariant и контейнеры QVariant - через json::write_value/cbor::write_value,
+// остальные типы - текстом своего fmt::formatter
+template<typename T>
+inline void write_value(spdlog::memory_buf_t& buffer, const T& value, value_format format) {
+    using type = std::decay_t<T>;
+    if constexpr (std::is_same_v<type, bool>) {
+        if (format == value_format::cbor) {
+            cbor::write_bool(buffer, value);
+        } else {
+            buffer.append(spdlog::string_view_t(value ? "true" : "false"));
+        }
+    } else if constexpr (std::is_integral_v<type> && !std::is_same_v<type, char>) {
+        if (format != value_format::cbor) {
+            fmt::format_to(std::back_inserter(buffer), "{}", value);
+        } else if constexpr (std::is_signed_v<type>) {
+            cbor::write_int(buffer, static_cast<std::int64_t>(value));
+        } else {
+            cbor::write_uint(buffer, static_cast<std::uint64_t>(value));
+        }
+    } else if constexpr (std::is_floating_point_v<type>) {
+        if (format == value_format::json) {
+            json::details::append_double(buffer, static_cast<double>(value));
+        } else if (format == value_format::cbor) {
+            cbor::write_double(buffer, static_cast<double>(value));
+        } else {
+            fmt::format_to(std::back_inserter(buffer), "{}", value);
+        }
+    } else if constexpr (std::is_same_v<type, QString> || std::is_same_v<type, QStringView>) {
+        details::append_string(buffer, QStringView(value), format);
+    } else if constexpr (std::is_same_v<type, QByteArray>) {
+        details::append_string(buffer, spdlog::string_view_t(value.constData(), static_cast<std::size_t>(value.size())), format);
+    } else if constexpr (std::is_convertible_v<const type&, spdlog::string_view_t>) {
+        details::append_string(buffer, spdlog::string_view_t(value), format);
+    } else if constexpr (std::is_same_v<type, QVariant> || std::is_same_v<type, QVariantMap>
+                         || std::is_same_v<type, QVariantList> || std::is_same_v<type, QStringList>) {
+        if constexpr (std::is_same_v<type, QVariant>) {
+            // Строка в QVariant пишется строкой, а не текстом JSON в кавычках logfmt
+            if (format == value_format::logfmt && value.typeId() == QMetaType::QString) {
+                details::append_string(buffer, QStringView(*static_cast<const QString*>(value.constData())), format);
+                return;
+            }
+        }
+        if (format == value_format::json) {
+            json::write_value(buffer, QVariant::fromValue(value));
+        } else if (format == value_format::cbor) {
+            cbor::write_value(buffer, QVariant::fromValue(value));
+        } else {
+            spdlog::memory_buf_t text;
+            json::write_value(text, QVariant::fromValue(value));
+            details::append_logfmt_string(buffer, spdlog::string_view_t(text.data(), text.size()));
+        }
+    } else if constexpr (std::is_same_v<type, QDateTime>) {
+        details::append_string(buffer, value.toString(Qt::ISODateWithMs), format);
+    } else {
+        spdlog::memory_buf_t text;
+        fmt::format_to(std::back_inserter(text), "{}", value);
+        details::append_string(buffer, spdlog::string_view_t(text.data(), text.size()), format);
+    }
+}
+
+struct value_ops;
+
+// Поле без типа: ключ, адрес значения и функция его записи. ops - как скопировать
+// значение для отложенной записи (nullptr - тип не копируется, значение отрисовывается сразу)
+struct field_ref {
+    spdlog::string_view_t key;
+    const void* value = nullptr;
+    void (*write)(spdlog::memory_buf_t& buffer, const void* value, value_format format) = nullptr;
+    const value_ops* ops = nullptr;
+
+    void write_to(spdlog::memory_buf_t& buffer, value_format format) const { write(buffer, value, format); }
+};
+
+// Копирование значения в хранилище captured_fields и запись копии. stored - операции
+// над самой копией (для повторного захвата уже восстановленных полей)
+struct value_ops {
+    std::size_t size;
+    std::size_t align;
+    void (*copy)(void* storage, const void* value);
+    void (*destroy)(void* storage);
+    void (*write)(spdlog::memory_buf_t& buffer, const void* stored, value_format format);
+    const value_ops* stored;
+};
+
+namespace details {
+
+template<typename T>
+constexpr bool is_string_view_v = std::is_same_v<T, std::string_view> || std::is_same_v<T, spdlog::string_view_t>;
+
+// Строки без владения копируются во владеющий тип, остальное - в своем типе
+template<typename T>
+using stored_value_t = std::conditional_t<
+    std::is_array_v<T> || std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>
+        || is_string_view_v<std::decay_t<T>>,
+    std::string, std::conditional_t<std::is_same_v<std::decay_t<T>, QStringView>, QString, std::decay_t<T>>>;
+
+template<typename T, typename Stored = stored_value_t<T>>
+struct stored_value {
+    static void copy(void* storage, const void* value) {
+        const T& source = *static_cast<const T*>(value);
+        if constexpr (is_string_view_v<std::decay_t<T>>) {
+            new (storage) Stored(source.data(), source.size());
+        } else if constexpr (std::is_same_v<std::decay_t<T>, QStringView>) {
+            new (storage) Stored(source.toString());
+        } else {
+            new (storage) Stored(source);
+        }
+    }
+    static void destroy(void* storage) { static_cast<Stored*>(storage)->~Stored(); }
+    static void write(spdlog::memory_buf_t& buffer, const void* stored, value_format format) {
+        write_value(buffer, *static_cast<const Stored*>(stored), format);
+    }
+
+    static constexpr value_ops ops{sizeof(Stored), alignof(Stored), &copy, &destroy, &write,
+                                   &stored_value<Stored, Stored>::ops};
+};
+
+} // namespace details
+
+// Операции копирования для типа T или nullptr, если его нельзя хранить копией
+template<typename T>
+inline const value_ops* value_ops_for() {
+    using stored = details::stored_value_t<T>;
+    if constexpr (std::is_copy_constructible_v<stored> && alignof(stored) <= alignof(std::max_align_t)) {
+        return &details::stored_value<T>::ops;
+    } else {
+        return nullptr;
+    }
+}
+
+// Поле с типом значения. Живет до конца выражения логирования
+template<typename T>
+struct field {
+    spdlog::string_view_t key;
+    const T& value;
+
+    field_ref ref() const {
+        return {key, &value,
+                [](spdlog::memory_buf_t& buffer, const void* erased, value_format format) {
+                    write_value(buffer, *static_cast<const T*>(erased), format);
+                },
+                value_ops_for<T>()};
+    }
+};
+
+// Поля текущей записи. message_size - длина сообщения в начале payload, дальше идут поля
+struct record {
+    std::size_t message_size = 0;
+    const field_ref* fields = nullptr;
+    std::size_t count = 0;
+
+    spdlog::string_view_t message(const spdlog::details::log_msg& msg) const {
+        return spdlog::string_view_t(msg.payload.data(), std::min(message_size, msg.payload.size()));
+    }
+};
+
+namespace details {
+inline const record*& current_record() {
+    thread_local const record* current = nullptr;
+    return current;
+}
+} // namespace details
+
+// Поля записи, которая сейчас передается в sink'и этого потока (или nullptr)
+inline const record* current() {
+    return details::current_record();
+}
+
+// Делает поля текущими на время передачи записи в sink'и
+class record_scope {
+public:
+    explicit record_scope(const record* fields)
+        : previous_(details::current_record()) {
+        details::current_record() = fields;
+    }
+    ~record_scope() { details::current_record() = previous_; }
+
+    record_scope(const record_scope&) = delete;
+    record_scope& operator=(const record_scope&) = delete;
+
+private:
+    const record* previous_;
+};
+
+// Поля как объект JSON в порядке передачи: {"user_id":42,"latency_ms":1.5}
+inline void write_json(spdlog::memory_buf_t& buffer, const record& fields) {
+    buffer.push_back('{');
+    for (std::size_t i = 0; i < fields.count; ++i) {
+        if (i > 0) {
+            buffer.push_back(',');
+        }
+        details::append_json_utf8(buffer, fields.fields[i].key);
+        buffer.push_back(':');
+        fields.fields[i].write_to(buffer, value_format::json);
+    }
+    buffer.push_back('}');
+}
+
+// Поля в формате logfmt: user_id=42 latency_ms=1.5
+inline void write_logfmt(spdlog::memory_buf_t& buffer, const record& fields) {
+    for (std::size_t i = 0; i < fields.count; ++i) {
+        if (i > 0) {
+            buffer.push_back(' ');
+        }
+        buffer.append(fields.fields[i].key);
+        buffer.push_back('=');
+        fields.fields[i].write_to(buffer, value_format::logfmt);
+    }
+}
+
+namespace details {
+
+// Значение типа без копирования: logfmt, JSON и CBOR отрисованы при захвате
+struct prerendered_value {
+    std::string text;
+    std::size_t logfmt_size = 0;
+    std::size_t json_size = 0;
+
+    static void write(spdlog::memory_buf_t& buffer, const void* stored, value_format format) {
+        const auto& value = *static_cast<const prerendered_value*>(stored);
+        const char* text = value.text.data();
+        const std::size_t cbor_offset = value.logfmt_size + value.json_size;
+        if (format == value_format::json) {
+            buffer.append(text + value.logfmt_size, text + cbor_offset);
+        } else if (format == value_format::cbor) {
+            buffer.append(text + cbor_offset, text + value.text.size());
+        } else {
+            buffer.append(text, text + value.logfmt_size);
+        }
+    }
+};
+
+inline constexpr value_ops prerendered_ops{sizeof(prerendered_value), alignof(prerendered_value),
+                                           &stored_value<prerendered_value>::copy,
+                                           &stored_value<prerendered_value>::destroy, &prerendered_value::write,
+                                           &prerendered_ops};
+
+} // namespace details
+
+// Копия полей для отложенной записи (асинхронные логгеры, снимки mdc): значения копируются
+// один раз в общий буфер, в logfmt, JSON и CBOR их отрисовывает поток записи через restore()
+class captured_fields {
+public:
+    captured_fields() = default;
+    ~captured_fields() { clear(); }
+
+    captured_fields(captured_fields&& other) noexcept
+        : message_size_(other.message_size_)
+        , keys_(std::move(other.keys_))
+        , storage_(std::move(other.storage_))
+        , entries_(std::move(other.entries_)) {
+        other.entries_.clear();
+    }
+
+    captured_fields& operator=(captured_fields&& other) noexcept {
+        if (this != &other) {
+            clear();
+            message_size_ = other.message_size_;
+            keys_ = std::move(other.keys_);
+            storage_ = std::move(other.storage_);
+            entries_ = std::move(other.entries_);
+            other.entries_.clear();
+        }
+        return *this;
+    }
+
+    captured_fields(const captured_fields&) = delete;
+    captured_fields& operator=(const captured_fields&) = delete;
+
+    bool empty() const { return entries_.empty(); }
+
+    void capture(const record& fields) {
+        clear();
+        message_size_ = fields.message_size;
+        // Первый проход - размещение ключей и значений, второй - копирование
+        std::size_t keys_size = 0;
+        std::size_t storage_size = 0;
+        entries_.reserve(fields.count);
+        for (std::size_t i = 0; i < fields.count; ++i) {
+            const field_ref& field = fields.fields[i];
+            const value_ops* ops = field.ops ? field.ops : &details::prerendered_ops;
+            storage_size = (storage_size + ops->align - 1) / ops->align * ops->align;
+            entries_.push_back({keys_size, field.key.size(), storage_size, ops});
+            keys_size += field.key.size();
+            storage_size += ops->size;
+        }
+        keys_.reserve(keys_size);
+        const std::size_t cells = (storage_size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+        storage_.reset(cells > 0 ? new std::max_align_t[cells] : nullptr);
+        auto* base = reinterpret_cast<unsigned char*>(storage_.get());
+        spdlog::memory_buf_t buffer;
+        for (std::size_t i = 0; i < fields.count; ++i) {
+            const field_ref& field = fields.fields[i];
+            keys_.append(field.key.data(), field.key.size());
+            void* storage = base + entries_[i].offset;
+            if (field.ops) {
+                field.ops->copy(storage, field.value);
+                continue;
+            }
+            auto* value = new (storage) details::prerendered_value;
+            buffer.clear();
+            field.write_to(buffer, value_format::logfmt);
+            value->logfmt_size = buffer.size();
+            field.write_to(buffer, value_format::json);
+            value->json_size = buffer.size() - value->logfmt_size;
+            field.write_to(buffer, value_format::cbor);
+            value->text.assign(buffer.data(), buffer.size());
+        }
+    }
+
+    // Ссылки в результате действительны, пока живы этот объект и refs
+    record restore(std::vector<field_ref>& refs) const {
+        refs.clear();
+        const auto* base = reinterpret_cast<const unsigned char*>(storage_.get());
+        for (const auto& item : entries_) {
+            refs.push_back({spdlog::string_view_t(keys_.data() + item.key_offset, item.key_size), base + item.offset,
+                            item.ops->write, item.ops->stored});
+        }
+        return {message_size_, refs.data(), refs.size()};
+    }
+
+private:
+    struct entry {
+        std::size_t key_offset = 0;
+        std::size_t key_size = 0;
+        std::size_t offset = 0;
+        const value_ops* ops = nullptr;
+    };
+
+    void clear() {
+        auto* base = reinterpret_cast<unsigned char*>(storage_.get());
+        for (const auto& item : entries_) {
+            item.ops->destroy(base + item.offset);
+        }
+        entries_.clear();
+        keys_.clear();
+        message_size_ = 0;
+    }
+
+    std::size_t message_size_ = 0;
+    std::string keys_;
+    std::unique_ptr<std::max_align_t[]> storage_;
+    std::vector<entry> entries_;
+};
+
+// Поля как map CBOR в порядке передачи
+inline void write_cbor(spdlog::memory_buf_t& buffer, const record& fields) {
+    cbor::write_map_head(buffer, fields.count);
+    for (std::size_t i = 0; i < fields.count; ++i) {
+        cbor::write_text(buffer, fields.fields[i].key);
+        fields.fields[i].write_to(buffer, value_format::cbor);
+    }
+}
+
+template<typename Message>
+inline void append_message(spdlog::memory_buf_t& buffer, const Message& message) {
+    if constexpr (std::is_same_v<std::decay_t<Message>, QString>) {
+        utils::append_utf8(buffer, message);
+    } else {
+        buffer.append(spdlog::string_view_t(message));
+    }
+}
+
+// Запись с готовыми полями: текстовые sink'и получают "сообщение key=value ...",
+// форматтеры - те же поля через current()
+template<typename Message>
+inline void log_refs(spdlog::logger& logger, spdlog::source_loc location, spdlog::level::level_enum level,
+                     const Message& message, const field_ref* refs, std::size_t count) {
+    spdlog::memory_buf_t payload;
+    append_message(payload, message);
+    record current_fields{payload.size(), refs, count};
+    if (count > 0) {
+        payload.push_back(' ');
+        write_logfmt(payload, current_fields);
+    }
+
+    record_scope scope(&current_fields);
+    logger.log(timestamps::now(), location, level, spdlog::string_view_t(payload.data(), payload.size()));
+}
+
+// Запись с полями. Уровень проверяет вызывающий код (макросы QT_LOG_*_KV)
+template<typename Message, typename... Values>
+inline void log(spdlog::logger& logger, spdlog::source_loc location, spdlog::level::level_enum level,
+                const Message& message, const field<Values>&... fields) {
+    const std::array<field_ref, sizeof...(Values)> refs{{fields.ref()...}};
+    log_refs(logger, location, level, message, refs.data(), refs.size());
+}
+
+} // namespace structured
+
+// Поле структурированной записи: ключ - строковый литерал, значение - по ссылке
+template<std::size_t N, typename T>
+inline structured::field<T> kv(const char (&key)[N], const T& value) {
+    static_assert(N > 1, "kv: key must be a non-empty string literal");
+    return {spdlog::string_view_t(key, N - 1), value};
+}
+
+namespace json {
+
+// Функции для JSON логирования. Уровень проверяется до построения записи.
+// Поля QVariantMap идут тем же путем, что и QT_LOG_*_KV: json_formatter пишет их
+// объектом "fields", cbor_formatter - map "f", текстовые sink'и - "сообщение key=value"
+inline void json_log(spdlog::level::level_enum level, const QString& message, const QVariantMap& fields = {}) {
+    auto* logger = spdlog::default_logger_raw();
+    if (!logger->should_log(level)) {
+        return;
+    }
+    // Ключи QVariantMap в UTF-8 одним буфером, значения - QVariant по ссылке
+    spdlog::memory_buf_t keys;
+    std::vector<std::size_t> key_ends;
+    key_ends.reserve(static_cast<std::size_t>(fields.size()));
+    for (auto it = fields.cbegin(); it != fields.cend(); ++it) {
+        utils::append_utf8(keys, it.key());
+        key_ends.push_back(keys.size());
+    }
+    std::vector<structured::field_ref> refs;
+    refs.reserve(key_ends.size());
+    std::size_t key_begin = 0;
+    std::size_t index = 0;
+    for (auto it = fields.cbegin(); it != fields.cend(); ++it, ++index) {
+        refs.push_back({spdlog::string_view_t(keys.data() + key_begin, key_ends[index] - key_begin), &it.value(),
+                        [](spdlog::memory_buf_t& buffer, const void* value, structured::value_format format) {
+                            structured::write_value(buffer, *static_cast<const QVariant*>(value), format);
+                        },
+                        structured::value_ops_for<QVariant>()});
+        key_begin = key_ends[index];
+    }
+    structured::log_refs(*logger, spdlog::source_loc{}, level, message, refs.data(), refs.size());
+}
+
+// Ленивые поля: фабрика QVariantMap вызывается, только если уровень включен
+template<typename FieldsFactory,
+         std::enable_if_t<std::is_invocable_r_v<QVariantMap, FieldsFactory&>, int> = 0>
+inline void json_log(spdlog::level::level_enum level, const QString& message, FieldsFactory&& make_fields) {
+    if (!should_log(level)) {
+        return;
+    }
+    json_log(level, message, static_cast<const QVariantMap&>(make_fields()));
+}
+
+// Удобные обертки (принимают QVariantMap или фабрику полей)
+template<typename Fields = QVariantMap>
+inline void json_info(const QString& message, Fields&& fields = {}) {
+    json_log(spdlog::level::info, message, std::forward<Fields>(fields));
+}
+
+template<typename Fields = QVariantMap>
+inline void json_error(const QString& message, Fields&& fields = {}) {
+    json_log(spdlog::level::err, message, std::forward<Fields>(fields));
+}
+
+template<typename Fields = QVariantMap>
+inline void json_warn(const QString& message, Fields&& fields = {}) {
+    json_log(spdlog::level::warn, message, std::forward<Fields>(fields));
+}
+
+template<typename Fields = QVariantMap>
+inline void json_debug(const QString& message, Fields&& fields = {}) {
+    json_log(spdlog::level::debug, message, std::forward<Fields>(fields));
+}
+
+} // namespace json
+
+// ============================================================================
+// КОНТЕКСТ ПОТОКА (MDC)
+// ============================================================================
+
+// auto ctx = qt_spdlog::context(kv("request_id", id), kv("user_id", user)) - ключи-значения,
+// которые до конца области видимости добавляются к каждой записи потока: флаг %& паттерна,
+// "context" в json_formatter, "ctx" в cbor_formatter. Значения копируются в объект области
+// на стеке, стек контекста - связный список этих объектов, поэтому вход и выход из области
+// не выделяют память (кроме копий типов, которые выделяют сами). Внутренний ключ
+// перекрывает внешний с тем же именем. Области должны вкладываться строго (RAII)
+namespace mdc {
+
+// Ограничение глубины: более внешние ключи отбрасываются
+constexpr std::size_t max_fields = 32;
+
+// Снимок контекста для другого потока: значения скопированы, поля готовы к выводу,
+// поэтому установка снимка в потоке записи или задачи - O(1)
+class snapshot {
+public:
+    explicit snapshot(const structured::record& fields) {
+        data_.capture(fields);
+        fields_ = data_.restore(refs_);
+    }
+
+    snapshot(const snapshot&) = delete;
+    snapshot& operator=(const snapshot&) = delete;
+
+    const structured::record& fields() const { return fields_; }
+
+private:
+    structured::captured_fields data_;
+    std::vector<structured::field_ref> refs_;
+    structured::record fields_;
+};
+
+using snapshot_ptr = std::shared_ptr<const snapshot>;
+
+namespace details {
+
+struct node {
+    structured::field_ref field;
+    const node* parent = nullptr;
+    mutable snapshot_ptr snapshot; // снимок контекста до этого узла включительно, создается при первом запросе
+};
+
+inline const node*& top() {
+    thread_local const node* current = nullptr;
+    return current;
+}
+
+// Снимок из другого потока, под областями этого потока (restore_scope)
+inline const snapshot_ptr*& base() {
+    thread_local const snapshot_ptr* current = nullptr;
+    return current;
+}
+
+// Строковые литералы и const char* хранятся копией, остальное - в своем типе
+template<typename T>
+using stored_t = std::conditional_t<std::is_array_v<T> || std::is_same_v<std::decay_t<T>, const char*>
+                                        || std::is_same_v<std::decay_t<T>, char*>,
+                                    std::string, std::decay_t<T>>;
+
+inline bool shadowed(const std::array<structured::field_ref, max_fields>& refs, std::size_t count,
+                     spdlog::string_view_t key) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (refs[max_fields - 1 - i].key == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace details
+
+// Контекст текущей записи: record из refs, от внешних ключей к внутренним
+inline structured::record current(std::array<structured::field_ref, max_fields>& refs) {
+    std::size_t count = 0;
+    for (const auto* item = details::top(); item && count < max_fields; item = item->parent) {
+        if (!details::shadowed(refs, count, item->field.key)) {
+            refs[max_fields - 1 - count++] = item->field;
+        }
+    }
+    if (const auto* captured = details::base(); captured && *captured) {
+        const auto& fields = (*captured)->fields();
+        if (count == 0) {
+            return fields;
+        }
+        for (std::size_t i = fields.count; i > 0 && count < max_fields; --i) {
+            if (!details::shadowed(refs, count, fields.fields[i - 1].key)) {
+                refs[max_fields - 1 - count++] = fields.fields[i - 1];
+            }
+        }
+    }
+    return {0, refs.data() + (max_fields - count), count};
+}
+
+inline bool empty() {
+    const auto* captured = details::base();
+    return details::top() == nullptr && (!captured || !*captured || (*captured)->fields().count == 0);
+}
+
+// Снимок текущего контекста. Пока контекст не меняется, возвращается один и тот же снимок
+inline snapshot_ptr capture() {
+    const auto* item = details::top();
+    if (!item) {
+        const auto* captured = details::base();
+        return captured ? *captured : nullptr;
+    }
+    if (!item->snapshot) {
+        std::array<structured::field_ref, max_fields> refs;
+        item->snapshot = std::make_shared<snapshot>(current(refs));
+    }
+    return item->snapshot;
+}
+
+// Заменяет контекст потока снимком до конца области: запись асинхронного backend'а,
+// задача в пуле потоков. Снимок должен жить до конца области
+class restore_scope {
+public:
+    explicit restore_scope(const snapshot_ptr& captured)
+        : previous_top_(details::top())
+        , previous_base_(details::base()) {
+        details::top() = nullptr;
+        details::base() = &captured;
+    }
+    ~restore_scope() {
+        details::top() = previous_top_;
+        details::base() = previous_base_;
+    }
+
+    restore_scope(const restore_scope&) = delete;
+    restore_scope& operator=(const restore_scope&) = delete;
+
+private:
+    const details::node* previous_top_;
+    const snapshot_ptr* previous_base_;
+};
+
+// Область контекста: значения хранятся внутри объекта, узлы стека указывают на них
+template<typename... Values>
+class scope {
+public:
+    explicit scope(const structured::field<Values>&... fields)
+        : values_(fields.value...) {
+        const std::array<spdlog::string_view_t, sizeof...(Values)> keys{{fields.key...}};
+        link(keys, std::index_sequence_for<Values...>{});
+    }
+
+    ~scope() {
+        details::top() = nodes_.front().parent;
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+private:
+    using values_type = std::tuple<details::stored_t<Values>...>;
+
+    template<std::size_t... I>
+    void link(const std::array<spdlog::string_view_t, sizeof...(Values)>& keys, std::index_sequence<I...>) {
+        const details::node* parent = details::top();
+        ((nodes_[I].field = structured::field<std::tuple_element_t<I, values_type>>{keys[I], std::get<I>(values_)}.ref(),
+          nodes_[I].parent = parent,
+          parent = &nodes_[I]), ...);
+        details::top() = parent;
+    }
+
+    values_type values_;
+    std::array<details::node, sizeof...(Values)> nodes_;
+};
+
+// Контекст как logfmt: request_id=42 user=alice
+inline void write_logfmt(spdlog::memory_buf_t& buffer) {
+    std::array<structured::field_ref, max_fields> refs;
+    structured::write_logfmt(buffer, current(refs));
+}
+
+// Флаг %& паттерна spdlog (как в новых версиях spdlog): контекст в формате logfmt
+class flag_formatter final : public spdlog::custom_flag_formatter {
+public:
+    void format(const spdlog::details::log_msg&, const std::tm&, spdlog::memory_buf_t& dest) override {
+        write_logfmt(dest);
+    }
+
+    std::unique_ptr<spdlog::custom_flag_formatter> clone() const override {
+        return std::make_unique<flag_formatter>();
+    }
+};
+
+} // namespace mdc
+
+// Область контекста потока из полей kv(); живет до конца области видимости переменной
+template<typename... Values>
+inline mdc::scope<Values...> context(const structured::field<Values>&... fields) {
+    static_assert(sizeof...(Values) > 0, "context: at least one kv() field is required");
+    return mdc::scope<Values...>(fields...);
+}
+
+// ============================================================================
+// УПРАВЛЕНИЕ УРОВНЯМИ
+// ============================================================================
+
+// Разбор имени уровня (каноническое имя или алиас, регистр не учитывается) без выделений памяти
+constexpr bool parse_level(std::string_view name, spdlog::level::level_enum& level) {
+    const int index = details::find_level_name(name.data(), name.size());
+    if (index >= 0) {
+        level = details::level_names[index].level;
+    }
+    return index >= 0;
+}
+
+inline bool parse_level(QStringView name, spdlog::level::level_enum& level) {
+    const int index = details::find_level_name(name.utf16(), static_cast<std::size_t>(name.size()));
+    if (index >= 0) {
+        level = details::level_names[index].level;
+    }
+    return index >= 0;
+}
+
+// Каноническое имя уровня: trace, debug, info, warn, error, critical, off
+constexpr std::string_view level_name(spdlog::level::level_enum level) {
+    return level >= spdlog::level::trace && level < spdlog::level::n_levels
+        ? details::canonical_level_names[static_cast<std::size_t>(level)]
+        : std::string_view();
+}
+
+// Преобразование строки в уровень spdlog. Неизвестное имя разбирает spdlog::level::from_str
+inline spdlog::level::level_enum string_to_level(std::string_view level_str) {
+    spdlog::level::level_enum level = spdlog::level::info;
+    if (parse_level(level_str, level)) {
+        return level;
+    }
+    return spdlog::level::from_str(std::string(level_str));
+}
+
+inline spdlog::level::level_enum string_to_level(QStringView level_str) {
+    spdlog::level::level_enum level = spdlog::level::info;
+    if (parse_level(level_str, level)) {
+        return level;
+    }
+    return spdlog::level::from_str(level_str.toString().toStdString());
+}
+
+// Преобразование уровня spdlog в строку
+inline QString level_to_string(spdlog::level::level_enum level) {
+    switch (level) {
+    case spdlog::level::trace: return QStringLiteral("trace");
+    case spdlog::level::debug: return QStringLiteral("debug");
+    case spdlog::level::info: return QStringLiteral("info");
+    case spdlog::level::warn: return QStringLiteral("warn");
+    case spdlog::level::err: return QStringLiteral("error");
+    case spdlog::level::critical: return QStringLiteral("critical");
+    case spdlog::level::off: return QStringLiteral("off");
+    default: return QString::fromLatin1(spdlog::level::to_short_c_str(level));
+    }
+}
+
+// Преобразование QtMsgType в уровень spdlog
+inline spdlog::level::level_enum qt_to_spdlog_level(QtMsgType qt_level) {
+    spdlog::level::level_enum level = spdlog::level::info;
+    details::qt_to_spdlog(qt_level, level);
+    return level;
+}
+
+inline bool set_level(std::string_view level) {
+    spdlog::level::level_enum parsed = spdlog::level::info;
+    if (parse_level(level, parsed)) {
+        spdlog::set_level(parsed);
+        categories::refresh();
+        return true;
+    }
+    std::cerr << "Unknown log level: " << level << std::endl;
+    return false;
+}
+
+inline bool set_level(QStringView level) {
+    spdlog::level::level_enum parsed = spdlog::level::info;
+    if (parse_level(level, parsed)) {
+        spdlog::set_level(parsed);
+        categories::refresh();
+        return true;
+    }
+    std::cerr << "Unknown log level: " << level.toString().toStdString() << std::endl;
+    return false;
+}
+
+inline QString get_level() {
+    auto level = spdlog::get_level();
+    return level >= spdlog::level::trace && level < spdlog::level::n_levels ? level_to_string(level) : "unknown";
+}
+
+inline bool set_level(QtMsgType level) {
+    spdlog::level::level_enum parsed = spdlog::level::info;
+    if (details::qt_to_spdlog(level, parsed)) {
+        spdlog::set_level(parsed);
+        categories::refresh();
+        return true;
+    }
+    std::cerr << "Unknown Qt message type: " << static_cast<int>(level) << std::endl;
+    return false;
+}
+
+inline QtMsgType get_qt_level() {
+    auto level = spdlog::get_level();
+    return level >= spdlog::level::trace && level < spdlog::level::n_levels
+        ? details::spdlog_to_qt_levels[static_cast<std::size_t>(level)]
+        : QtMsgType::QtInfoMsg;
+}
+
+constexpr bool is_valid_level(std::string_view level) {
+    return details::find_level_name(level.data(), level.size()) >= 0;
+}
+
+inline bool is_valid_level(QStringView level) {
+    return details::find_level_name(level.utf16(), static_cast<std::size_t>(level.size())) >= 0;
+}
+
+inline QString get_level_display_name(QStringView level_str) {
+    return level_to_string(string_to_level(level_str));
+}
+
+inline QStringList get_level_aliases(QStringView canonical_level) {
+    QStringList aliases;
+    spdlog::level::level_enum target_level = string_to_level(canonical_level);
+
+    for (const auto& entry : details::level_names) {
+        const bool same_name = static_cast<std::size_t>(canonical_level.size()) == entry.name.size()
+            && std::equal(entry.name.begin(), entry.name.end(), canonical_level.utf16());
+        if (entry.level == target_level && !same_name) {
+            aliases.append(QLatin1String(entry.name.data(), static_cast<int>(entry.name.size())));
+        }
+    }
+
+    return aliases;
+}
+
+// Получение отображаемого имени с учетом алиасов
+inline QString get_level_display_name_with_aliases(QStringView level_str) {
+    QString canonical = get_level_display_name(level_str);
+    QStringList aliases = get_level_aliases(canonical);
+
+    if (aliases.isEmpty()) {
+        return canonical;
+    }
+
+    return QString("%1 (алиасы: %2)").arg(canonical).arg(aliases.join(", "));
+}
+
+inline QStringList get_available_levels() {
+    QStringList levels;
+    levels.reserve(static_cast<qsizetype>(details::level_names.size()));
+    for (const auto& entry : details::level_names) {
+        levels.append(QLatin1String(entry.name.data(), static_cast<int>(entry.name.size())));
+    }
+    return levels;
+}
+
+inline QStringList get_canonical_levels() {
+    QStringList levels;
+    levels.reserve(spdlog::level::n_levels);
+
+    // Сохраняем порядок от trace до off
+    for (int i = static_cast<int>(spdlog::level::trace);
+         i <= static_cast<int>(spdlog::level::off);
+         ++i) {
+        levels.append(level_to_string(static_cast<spdlog::level::level_enum>(i)));
+    }
+
+    return levels;
+}
+
+inline QMap<QString, QString> get_levels_with_display_names() {
+    QMap<QString, QString> result;
+
+    for (const auto& entry : details::level_names) {
+        result.insert(QLatin1String(entry.name.data(), static_cast<int>(entry.name.size())),
+                      level_to_string(entry.level));
+    }
+
+    return result;
+}
+
+inline void setup_display_always() {
+    auto& registry = spdlog::details::registry::instance();
+
+    // Применяем функцию ко всем зарегистрированным логгерам
+    registry.apply_all([](const std::shared_ptr<spdlog::logger>& logger) {
+        // Для каждого логгера настраиваем цвета во всех console sink'ах
+        for (auto& sink : logger->sinks()) {
+            if (auto console_sink = std::dynamic_pointer_cast<spdlog::sinks::stdout_color_sink_mt>(sink)) {
+
+#ifdef _WIN32
+                // Для Windows использовать Windows API цвета
+                console_sink->set_color(spdlog::level::off, 0x5); // cyan
+#else
+                // Для Linux/Mac использовать ANSI коды
+                console_sink->set_color(spdlog::level::off, "\033[1;36m"); // bright cyan
+#endif
+                // #define FOREGROUND_BLUE 0x1
+                // #define FOREGROUND_GREEN 0x2
+                // #define FOREGROUND_RED 0x4
+                // #define FOREGROUND_INTENSITY 0x8
+                // #define BACKGROUND_BLUE 0x10
+                // #define BACKGROUND_GREEN 0x20
+                // #define BACKGROUND_RED 0x40
+                // #define BACKGROUND_INTENSITY 0x80
+
+                // default win console level colors
+                // colors_[level::trace] = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;     // white
+                // colors_[level::debug] = FOREGROUND_GREEN | FOREGROUND_BLUE;                      // cyan
+                // colors_[level::info] = FOREGROUND_GREEN;                                         // green
+                // colors_[level::warn] = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY; // intense yellow
+                // colors_[level::err] = FOREGROUND_RED | FOREGROUND_INTENSITY;                     // intense red
+                // colors_[level::critical] =
+                //     BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY; // intense white on red background
+                // colors_[level::off] = 0;
+
+                // console_sink->set_color(spdlog::level::off, "\033[1;36m");      // ALWAYS - яркий cyan
+                // console_sink->set_color(spdlog::level::critical, "\033[1;31m"); // CRITICAL - яркий red
+                // console_sink->set_color(spdlog::level::err, "\033[1;31m");      // ERROR - яркий red
+                // console_sink->set_color(spdlog::level::warn, "\033[1;33m");     // WARN - яркий yellow
+                // console_sink->set_color(spdlog::level::info, "\033[1;32m");     // INFO - яркий green
+                // console_sink->set_color(spdlog::level::debug, "\033[1;34m");    // DEBUG - яркий blue
+                // console_sink->set_color(spdlog::level::trace, "\033[1;37m");    // TRACE - яркий white
+
+            }
+        }
+    });
+}
+
+// ============================================================================
+// УРОВНИ ПО СТРОКЕ СПЕЦИФИКАЦИИ ("net=debug,db.*=warn,*=info")
+// ============================================================================
+
+namespace levels {
+
+namespace details {
+
+// Глоб: '*' - любая последовательность, '?' - один символ
+constexpr bool glob_match(std::string_view pattern, std::string_view name) {
+    std::size_t p = 0;
+    std::size_t n = 0;
+    std::size_t star = std::string_view::npos;
+    std::size_t resume = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            ++p;
+            ++n;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            resume = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+static_assert(glob_match("net.*", "net.http") && glob_match("*", "") && glob_match("d?_*", "db_pool"));
+static_assert(!glob_match("net.*", "network") && !glob_match("db", "db2"));
+
+constexpr std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace details
+
+struct rule {
+    std::string pattern;
+    spdlog::level::level_enum level;
+};
+
+// Разобранная и предкомпилированная спецификация. Побеждает самое конкретное
+// правило: точное имя, затем глоб с большим числом обычных символов, при
+// равенстве - более позднее. Поиск не перебирает правила: точные имена и
+// глобы вида "префикс*" лежат в хэш-таблицах, на имя приходится один поиск
+// на каждую различную длину префикса. Перебираются только глобы с '?' или
+// '*' не в конце
+class spec {
+public:
+    spec() = default;
+    spec(spec&&) = default;
+    spec& operator=(spec&&) = default;
+    // Ключи таблиц указывают на строки rules_
+    spec(const spec&) = delete;
+    spec& operator=(const spec&) = delete;
+
+    // Элементы через запятую: "шаблон=уровень" или просто "уровень" (то же, что "*=уровень")
+    static std::optional<spec> parse(std::string_view text, QString* error = nullptr) {
+        spec result;
+        while (!text.empty()) {
+            const std::size_t comma = text.find(',');
+            const std::string_view item = details::trim(text.substr(0, comma));
+            text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+            if (item.empty()) {
+                continue;
+            }
+
+            const std::size_t equals = item.find('=');
+            const std::string_view pattern = equals == std::string_view::npos ? "*" : details::trim(item.substr(0, equals));
+            const std::string_view level_name = equals == std::string_view::npos ? item : details::trim(item.substr(equals + 1));
+            spdlog::level::level_enum level = spdlog::level::info;
+            if (pattern.empty() || !parse_level(level_name, level)) {
+                if (error) {
+                    *error = QString("invalid level spec item '%1'")
+                                 .arg(QString::fromUtf8(item.data(), static_cast<qsizetype>(item.size())));
+                }
+                return std::nullopt;
+            }
+            result.rules_.push_back({std::string(pattern), level});
+        }
+
+        for (std::size_t i = 0; i < result.rules_.size(); ++i) {
+            result.compile_(i);
+        }
+        return result;
+    }
+
+    std::optional<spdlog::level::level_enum> level_for(std::string_view name) const {
+        const candidate* best = nullptr;
+        auto consider = [&best](const candidate& found) {
+            if (!best || found.score > best->score || (found.score == best->score && found.order > best->order)) {
+                best = &found;
+            }
+        };
+
+        if (auto it = exact_.find(name); it != exact_.end()) {
+            return it->second.level;
+        }
+        // Самый длинный подходящий префикс: проверяются только длины, для которых есть правила
+        for (std::size_t length : prefix_lengths_) {
+            if (length > name.size()) {
+                continue;
+            }
+            if (auto it = prefixes_.find(name.substr(0, length)); it != prefixes_.end()) {
+                consider(it->second);
+                break;
+            }
+        }
+        for (const auto& [pattern, found] : globs_) {
+            if ((!best || found.score >= best->score) && details::glob_match(pattern, name)) {
+                consider(found);
+            }
+        }
+
+        if (!best) {
+            return std::nullopt;
+        }
+        return best->level;
+    }
+
+    const std::vector<rule>& rules() const { return rules_; }
+    bool empty() const { return rules_.empty(); }
+
+    // Правило "*" без других символов: общий уровень для логгеров без своего правила
+    std::optional<spdlog::level::level_enum> default_level() const {
+        auto it = prefixes_.find(std::string_view());
+        return it != prefixes_.end() ? std::optional(it->second.level) : std::nullopt;
+    }
+
+    // Точные имена - для реестра spdlog (логгеры из фабрик spdlog::*_mt)
+    std::unordered_map<std::string, spdlog::level::level_enum> exact_levels() const {
+        std::unordered_map<std::string, spdlog::level::level_enum> result;
+        for (const auto& [name, found] : exact_) {
+            result[std::string(name)] = found.level;
+        }
+        return result;
+    }
+
+private:
+    struct candidate {
+        spdlog::level::level_enum level;
+        std::size_t score; // число обычных символов шаблона
+        std::size_t order; // номер правила
+    };
+
+    void compile_(std::size_t index) {
+        const std::string_view pattern = rules_[index].pattern;
+        const std::size_t wildcard = pattern.find_first_of("*?");
+        const std::size_t literals = static_cast<std::size_t>(
+            std::count_if(pattern.begin(), pattern.end(), [](char c) { return c != '*' && c != '?'; }));
+        const candidate found{rules_[index].level, literals, index};
+
+        if (wildcard == std::string_view::npos) {
+            exact_.insert_or_assign(pattern, found);
+        } else if (wildcard == pattern.size() - 1 && pattern.back() == '*') {
+            prefixes_.insert_or_assign(pattern.substr(0, wildcard), found);
+            // Длины по убыванию, без повторов
+            auto position = std::lower_bound(prefix_lengths_.begin(), prefix_lengths_.end(), wildcard, std::greater<>());
+            if (position == prefix_lengths_.end() || *position != wildcard) {
+                prefix_lengths_.insert(position, wildcard);
+            }
+        } else {
+            globs_.emplace_back(pattern, found);
+        }
+    }
+
+    std::vector<rule> rules_;
+    std::unordered_map<std::string_view, candidate> exact_;
+    std::unordered_map<std::string_view, candidate> prefixes_;
+    std::vector<std::size_t> prefix_lengths_;
+    std::vector<std::pair<std::string_view, candidate>> globs_;
+};
+
+namespace details {
+
+struct spec_state {
+    std::mutex mutex; // сериализует смену спецификации
+    std::shared_ptr<const spec> current = std::make_shared<const spec>();
+    std::atomic<std::uint64_t> generation{0};
+};
+
+inline spec_state& get_spec_state() {
+    static spec_state state;
+    return state;
+}
+
+} // namespace details
+
+inline std::shared_ptr<const spec> current() {
+    return std::atomic_load_explicit(&details::get_spec_state().current, std::memory_order_acquire);
+}
+
+// Меняется при каждой установке спецификации (thread-local логгеры сверяются с ним)
+inline std::uint64_t generation() {
+    return details::get_spec_state().generation.load(std::memory_order_acquire);
+}
+
+// Уровень из текущей спецификации для логгера, созданного после ее установки.
+// match_name - имя для сопоставления (для thread-local логгеров - модуль)
+inline bool apply_pending(spdlog::logger& logger, std::string_view match_name) {
+    const auto compiled = current();
+    if (compiled->empty()) {
+        return false;
+    }
+    if (auto level = compiled->level_for(match_name)) {
+        logger.set_level(*level);
+        return true;
+    }
+    return false;
+}
+
+inline bool apply_pending(spdlog::logger& logger) {
+    return apply_pending(logger, logger.name());
+}
+
+} // namespace levels
+
+// Применяет спецификацию ко всем логгерам реестра и сохраняет ее для логгеров,
+// созданных позже (категории, thread-local, асинхронные, из конфигурации).
+// Спецификация заменяет предыдущую целиком; при ошибке ничего не меняется
+inline bool set_level_spec(std::string_view text, QString* error = nullptr) {
+    auto parsed = levels::spec::parse(text, error);
+    if (!parsed) {
+        return false;
+    }
+    auto compiled = std::make_shared<const levels::spec>(std::move(*parsed));
+
+    auto& state = levels::details::get_spec_state();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::atomic_store_explicit(&state.current, compiled, std::memory_order_release);
+        state.generation.fetch_add(1, std::memory_order_acq_rel);
+
+        // Уровни существующих логгеров передаются в set_levels вместе с точными
+        // правилами: каждый логгер сразу получает итоговый уровень, а логгеры из
+        // фабрик spdlog получат свой при создании
+        auto resolved = compiled->exact_levels();
+        spdlog::apply_all([&](const std::shared_ptr<spdlog::logger>& logger) {
+            if (auto level = compiled->level_for(logger->name())) {
+                resolved[logger->name()] = *level;
+            }
+        });
+        auto default_level = compiled->default_level();
+        spdlog::details::registry::instance().set_levels(std::move(resolved),
+                                                         default_level ? &*default_level : nullptr);
+
+        // Явные уровни иерархии остаются поверх спецификации, а ее уровень логгер
+        // получит, когда явный уровень снимут (а не тот, что был до него)
+        hierarchy::rebase([&compiled, &default_level](std::string_view name) {
+            auto level = compiled->level_for(name);
+            return level ? level : default_level;
+        });
+    }
+
+    categories::refresh();
+    return true;
+}
+
+inline bool set_level_spec(QStringView text, QString* error = nullptr) {
+    const QByteArray utf8 = text.toUtf8();
+    return set_level_spec(std::string_view(utf8.constData(), static_cast<std::size_t>(utf8.size())), error);
+}
+
+// Спецификация из переменной окружения (по умолчанию QT_SPDLOG_LEVEL). Пустая
+// или отсутствующая переменная ничего не меняет
+inline bool load_level_spec_from_env(const char* variable = "QT_SPDLOG_LEVEL", QString* error = nullptr) {
+    const QByteArray value = qgetenv(variable);
+    if (value.trimmed().isEmpty()) {
+        return true;
+    }
+    return set_level_spec(std::string_view(value.constData(), static_cast<std::size_t>(value.size())), error);
+}
+
+// ============================================================================
+// ВРЕМЕННЫЕ ЛОГГЕРЫ
+// ============================================================================
+
+namespace details {
+
+// Основной логгер "qt" (или логгер по умолчанию, если "qt" не зарегистрирован)
+inline const logger_handle& qt_logger_handle() {
+    static const logger_handle handle("qt");
+    return handle;
+}
+
+} // namespace details
+
+// Для основного логгера "qt" с уровнем из строки
+inline scoped::ScopedLoggerLevel create_scoped_logger(const QString& level_name) {
+    if (!is_valid_level(level_name)) {
+        // Возвращаем неактивный объект
+        return scoped::ScopedLoggerLevel("", spdlog::level::info);
+    }
+    spdlog::level::level_enum level = string_to_level(level_name);
+    return scoped::ScopedLoggerLevel(details::qt_logger_handle(), level);
+}
+
+// Для основного логгера "qt" с уровнем spdlog
+inline scoped::ScopedLoggerLevel create_scoped_logger(spdlog::level::level_enum level) {
+    return scoped::ScopedLoggerLevel(details::qt_logger_handle(), level);
+}
+
+// Для логгера по дескриптору (горячие пути без spdlog::get)
+inline scoped::ScopedLoggerLevel create_scoped_logger(const logger_handle& handle, spdlog::level::level_enum level) {
+    return scoped::ScopedLoggerLevel(handle, level);
+}
+
+// Для конкретного логгера по имени с уровнем из строки
+inline scoped::ScopedLoggerLevel create_scoped_logger(const QString& logger_name, const QString& level_name) {
+    if (!is_valid_level(level_name)) {
+        return scoped::ScopedLoggerLevel("", spdlog::level::info);
+    }
+    spdlog::level::level_enum level = string_to_level(level_name);
+    return scoped::ScopedLoggerLevel(logger_name.toStdString(), level);
+}
+
+// Для конкретного логгера с уровнем spdlog
+inline scoped::ScopedLoggerLevel create_scoped_logger(const QString& logger_name, spdlog::level::level_enum level) {
+    return scoped::ScopedLoggerLevel(logger_name.toStdString(), level);
+}
+
+// ============================================================================
+// THREAD-LOCAL ЛОГГЕРЫ
+// ============================================================================
+
+// Простое thread-local хранилище для модуля
+inline QThreadStorage<QString>& get_module_storage() {
+    static QThreadStorage<QString> storage;
+    return storage;
+}
+
+// Thread-local storage для имени модуля
+inline QString get_current_module_name() {
+    auto& storage = get_module_storage();
+    if (storage.hasLocalData()) {
+        return storage.localData();
+    }
+    return "unknown";
+}
+
+inline void set_current_module_name(const QString& module) {
+    auto& storage = get_module_storage();
+    storage.setLocalData(module);
+}
+
+// QThreadStorage для thread-local логгеров
+inline QThreadStorage<std::shared_ptr<spdlog::logger>>& get_logger_storage() {
+    static QThreadStorage<std::shared_ptr<spdlog::logger>> storage;
+    return storage;
+}
+
+inline std::shared_ptr<spdlog::logger> get_thread_local_logger() {
+    auto& storage = get_logger_storage();
+    // Модуль, под которым создан логгер потока, и версия спецификации уровней
+    thread_local std::string logger_module;
+    thread_local std::uint64_t level_generation = 0;
+
+    if (!storage.hasLocalData()) {
+        // Используем хэш std::thread::id для уникальности
+        auto thread_id = std::this_thread::get_id();
+        std::hash<std::thread::id> hasher;
+        auto thread_hash = hasher(thread_id);
+
+        logger_module = get_current_module_name().toStdString();
+        auto logger_name = logger_module + "_" + std::to_string(thread_hash);
+
+        auto logger = spdlog::default_logger()->clone(logger_name);
+        level_generation = levels::generation();
+        levels::apply_pending(*logger, logger_module);
+        storage.setLocalData(logger);
+    }
+
+    const auto& logger = storage.localData();
+    // Спецификация сменилась после создания логгера: одна атомарная загрузка на вызов
+    if (const auto generation = levels::generation(); generation != level_generation) {
+        level_generation = generation;
+        if (!levels::apply_pending(*logger, logger_module)) {
+            logger->set_level(spdlog::default_logger()->level());
+        }
+    }
+    return logger;
+}
+
+// Алиасы для удобства
+inline QString get_current_module() {
+    return get_current_module_name();
+}
+
+inline void set_current_module(const QString& module) {
+    set_current_module_name(module);
+}
+
+namespace scoped {
+
+// RAII-обертка для временной смены модуля
+class ScopedModule {
+public:
+    ScopedModule(const QString& module)
+        : m_previous_module(get_current_module_name())
+        , m_new_module(module) {
+        set_current_module_name(module);
+    }
+
+    ~ScopedModule() {
+        set_current_module_name(m_previous_module);
+    }
+
+    // Методы для получения информации
+    QString previous_module() const { return m_previous_module; }
+    QString current_module() const { return m_new_module; }
+
+private:
+    QString m_previous_module;
+    QString m_new_module;
+};
+
+}
+
+// Основной фабричный метод
+inline scoped::ScopedModule module(const QString& module_name) {
+    return scoped::ScopedModule(module_name);
+}
+
+// ============================================================================
+// ПЕРЕНОС КОНТЕКСТА В ЗАДАЧИ ПУЛА ПОТОКОВ
+// ============================================================================
+
+// Номер логической операции, уникальный в процессе
+inline std::uint64_t next_correlation_id() {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Начало логической операции: область контекста с новым correlation_id.
+// Вместе с wrap()/run_with_context() номер виден во всех задачах операции
+inline mdc::scope<std::uint64_t> begin_operation() {
+    return context(kv("correlation_id", next_correlation_id()));
+}
+
+namespace scoped {
+
+// Модуль и контекст потока, захваченные при создании задачи (копии O(1):
+// QString разделяется, снимок контекста общий)
+struct task_context {
+    std::optional<QString> module;
+    mdc::snapshot_ptr context;
+
+    static task_context capture() {
+        task_context captured;
+        if (get_module_storage().hasLocalData()) {
+            captured.module = get_module_storage().localData();
+        }
+        captured.context = mdc::capture();
+        return captured;
+    }
+};
+
+// Устанавливает захваченные модуль и контекст в потоке задачи, по выходу
+// восстанавливает прежние: поток пула может выполнять чужие задачи дальше
+class TaskContextScope {
+public:
+    explicit TaskContextScope(const task_context& captured)
+        : m_previous_module(get_current_module_name())
+        , m_context(captured.context) {
+        set_current_module_name(captured.module ? *captured.module : QStringLiteral("unknown"));
+    }
+
+    ~TaskContextScope() {
+        set_current_module_name(m_previous_module);
+    }
+
+    TaskContextScope(const TaskContextScope&) = delete;
+    TaskContextScope& operator=(const TaskContextScope&) = delete;
+
+private:
+    QString m_previous_module;
+    mdc::restore_scope m_context;
+};
+
+// Функция вместе с контекстом потока, в котором она создана
+template<typename Function>
+class ContextTask {
+public:
+    ContextTask(Function function, task_context captured)
+        : m_function(std::move(function))
+        , m_context(std::move(captured)) {}
+
+    template<typename... Args>
+    decltype(auto) operator()(Args&&... args) {
+        TaskContextScope scope(m_context);
+        return std::invoke(m_function, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    decltype(auto) operator()(Args&&... args) const {
+        TaskContextScope scope(m_context);
+        return std::invoke(m_function, std::forward<Args>(args)...);
+    }
+
+private:
+    Function m_function;
+    task_context m_context;
+};
+
+}
+
+// Оборачивает функцию: при вызове в другом потоке действуют модуль и контекст
+// (qt_spdlog::context) потока, где вызван wrap. Подходит для QThreadPool::start,
+// QtConcurrent::run/map, QTimer::singleShot и т.п.
+template<typename Function>
+inline scoped::ContextTask<std::decay_t<Function>> wrap(Function&& function) {
+    return scoped::ContextTask<std::decay_t<Function>>(std::forward<Function>(function),
+                                                       scoped::task_context::capture());
+}
+
+// ============================================================================
+// JSON ФОРМАТТЕР
+// ============================================================================
+
+namespace details {
+
+// Модуль записи, захваченный в потоке логирования (для асинхронных логгеров)
+inline const QString*& record_module_override() {
+    thread_local const QString* module = nullptr;
+    return module;
+}
+
+// Модуль текущей записи: захваченный или ScopedModule этого потока.
+// "unknown" (значение по умолчанию и после выхода из ScopedModule) не выводится
+inline bool record_module(QString& module) {
+    if (const QString* captured = record_module_override()) {
+        module = *captured;
+    } else if (get_module_storage().hasLocalData()) {
+        module = get_module_storage().localData();
+    } else {
+        return false;
+    }
+    return !module.isEmpty() && module != QLatin1String("unknown");
+}
+
+} // namespace details
+
+// spdlog::formatter, который пишет каждую запись строкой JSON:
+// {"timestamp":"...","level":"info","logger":"app","thread":123,"module":"db","context":{...},
+//  "source":{"file":"a.cpp","line":10,"function":"f"},"message":"...","fields":{...}}
+// module, context (qt_spdlog::context), source и fields пишутся, только если заданы. Поля QT_LOG_*_KV
+// выводятся в "fields" в исходных типах, сообщение - без хвоста key=value.
+// Форматтер задается отдельно для каждого sink'а
+class json_formatter final : public spdlog::formatter {
+public:
+    explicit json_formatter(std::string eol = spdlog::details::os::default_eol)
+        : eol_(std::move(eol)) {}
+
+    void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override {
+        const auto* fields = structured::current();
+
+        dest.append(spdlog::string_view_t("{\"timestamp\":"));
+        json::write_timestamp(dest, msg.time);
+        dest.append(spdlog::string_view_t(",\"level\":"));
+        json::details::append_string(dest, spdlog::level::to_string_view(msg.level));
+        dest.append(spdlog::string_view_t(",\"logger\":"));
+        structured::details::append_json_utf8(dest, msg.logger_name);
+        dest.append(spdlog::string_view_t(",\"thread\":"));
+        fmt::format_to(std::back_inserter(dest), "{}", msg.thread_id);
+
+        QString module;
+        if (details::record_module(module)) {
+            dest.append(spdlog::string_view_t(",\"module\":"));
+            json::details::append_string(dest, module);
+        }
+
+        std::array<structured::field_ref, mdc::max_fields> context_refs;
+        const structured::record context = mdc::current(context_refs);
+        if (context.count > 0) {
+            dest.append(spdlog::string_view_t(",\"context\":"));
+            structured::write_json(dest, context);
+        }
+
+        if (!msg.source.empty()) {
+            dest.append(spdlog::string_view_t(",\"source\":{\"file\":"));
+            structured::details::append_json_utf8(dest, msg.source.filename);
+            fmt::format_to(std::back_inserter(dest), ",\"line\":{}", msg.source.line);
+            if (msg.source.funcname) {
+                dest.append(spdlog::string_view_t(",\"function\":"));
+                structured::details::append_json_utf8(dest, msg.source.funcname);
+            }
+            dest.push_back('}');
+        }
+
+        dest.append(spdlog::string_view_t(",\"message\":"));
+        structured::details::append_json_utf8(dest, fields ? fields->message(msg) : msg.payload);
+        if (fields && fields->count > 0) {
+            dest.append(spdlog::string_view_t(",\"fields\":"));
+            structured::write_json(dest, *fields);
+        }
+        dest.push_back('}');
+        dest.append(eol_.data(), eol_.data() + eol_.size());
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override {
+        return std::make_unique<json_formatter>(eol_);
+    }
+
+private:
+    std::string eol_;
+};
+
+// Форматтер CBOR: каждая запись - map CBOR, записи идут подряд (CBOR sequence).
+// Ключи короткие: "ts" - время в нс от эпохи, "lvl" - уровень spdlog числом,
+// "log" - имя логгера, "tid" - поток, "mod" - модуль, "ctx" - контекст потока (map),
+// "src" - [файл, строка, функция],
+// "msg" - сообщение, "f" - поля QT_LOG_*_KV в исходных типах.
+// Для файлов используется с basic_file_sink и др.; в JSON Lines переводится qt_spdlog_cbor2json
+class cbor_formatter final : public spdlog::formatter {
+public:
+    void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override {
+        const auto* fields = structured::current();
+        QString module;
+        const bool has_module = details::record_module(module);
+        std::array<structured::field_ref, mdc::max_fields> context_refs;
+        const structured::record context = mdc::current(context_refs);
+        const bool has_context = context.count > 0;
+        const bool has_source = !msg.source.empty();
+        const bool has_fields = fields && fields->count > 0;
+
+        cbor::write_map_head(dest, 5 + has_module + has_context + has_source + has_fields);
+        cbor::write_text(dest, spdlog::string_view_t("ts"));
+        cbor::write_uint(dest, static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(msg.time.time_since_epoch()).count()));
+        cbor::write_text(dest, spdlog::string_view_t("lvl"));
+        cbor::write_uint(dest, static_cast<std::uint64_t>(msg.level));
+        cbor::write_text(dest, spdlog::string_view_t("log"));
+        cbor::write_text(dest, msg.logger_name);
+        cbor::write_text(dest, spdlog::string_view_t("tid"));
+        cbor::write_uint(dest, msg.thread_id);
+
+        if (has_module) {
+            cbor::write_text(dest, spdlog::string_view_t("mod"));
+            cbor::write_text(dest, QStringView(module));
+        }
+        if (has_context) {
+            cbor::write_text(dest, spdlog::string_view_t("ctx"));
+            structured::write_cbor(dest, context);
+        }
+        if (has_source) {
+            cbor::write_text(dest, spdlog::string_view_t("src"));
+            cbor::write_array_head(dest, msg.source.funcname ? 3 : 2);
+            cbor::write_text(dest, spdlog::string_view_t(msg.source.filename));
+            cbor::write_uint(dest, static_cast<std::uint64_t>(msg.source.line));
+            if (msg.source.funcname) {
+                cbor::write_text(dest, spdlog::string_view_t(msg.source.funcname));
+            }
+        }
+
+        cbor::write_text(dest, spdlog::string_view_t("msg"));
+        cbor::write_text(dest, fields ? fields->message(msg) : msg.payload);
+        if (has_fields) {
+            cbor::write_text(dest, spdlog::string_view_t("f"));
+            structured::write_cbor(dest, *fields);
+        }
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override {
+        return std::make_unique<cbor_formatter>();
+    }
+};
+
+// ============================================================================
+// УПРАВЛЕНИЕ ПАТТЕРНАМИ
+// ============================================================================
+
+namespace patterns {
+
+// Вид паттерна: быстрые пути не запускают pattern_formatter
+enum class layout {
+    general,        // произвольный паттерн - pattern_formatter spdlog
+    message_only,   // "%v"
+    prefix_message  // постоянный текст и "%v" в конце
+};
+
+namespace details {
+
+// Флаги pattern_formatter spdlog и флаг контекста qt_spdlog (%&)
+constexpr bool is_known_flag(char flag) {
+    constexpr std::string_view flags = "+tvaAbhBcCYDxmdHIMSeEfFpPrRTXznlL^$@sg#!%uioO&";
+    return flags.find(flag) != std::string_view::npos;
+}
+
+// Разобранный и проверенный паттерн, общий для всех копий CompiledPattern
+struct compiled_state {
+    std::string pattern;
+    std::string formatter_pattern; // pattern с флагами общего кэша даты и времени
+    layout kind = layout::general;
+    std::string prefix; // текст до %v с раскрытыми %%
+    std::string eol = spdlog::details::os::default_eol;
+};
+
+// Служебные флаги: пользователь их не задаст, compile() отвергает неизвестные флаги
+constexpr char datetime_flag = '\x01'; // "%Y-%m-%d %H:%M:%S"
+constexpr char time_flag = '\x02';     // "%T", "%H:%M:%S"
+
+// Дата и время до секунд из кэша timestamps, общего с JSON: строка строится
+// раз в секунду на поток, а не из полей std::tm на каждую запись
+class cached_datetime_flag final : public spdlog::custom_flag_formatter {
+public:
+    explicit cached_datetime_flag(bool with_date)
+        : with_date_(with_date) {}
+
+    void format(const spdlog::details::log_msg& msg, const std::tm&, spdlog::memory_buf_t& dest) override {
+        const auto& second = timestamps::details::render_second(msg.time);
+        dest.append(second.text + (with_date_ ? 0 : 11), second.text + 19);
+    }
+
+    std::unique_ptr<spdlog::custom_flag_formatter> clone() const override {
+        return std::make_unique<cached_datetime_flag>(with_date_);
+    }
+
+private:
+    bool with_date_;
+};
+
+inline std::unique_ptr<spdlog::pattern_formatter> make_pattern_formatter(const std::string& pattern) {
+    auto formatter = std::make_unique<spdlog::pattern_formatter>();
+    formatter->add_flag<mdc::flag_formatter>('&')
+        .add_flag<cached_datetime_flag>(datetime_flag, true)
+        .add_flag<cached_datetime_flag>(time_flag, false)
+        .set_pattern(pattern);
+    return formatter;
+}
+
+// Быстрый путь: префикс, текст сообщения и перевод строки без разбора флагов и времени
+class message_formatter final : public spdlog::formatter {
+public:
+    explicit message_formatter(std::shared_ptr<const compiled_state> state)
+        : state_(std::move(state)) {}
+
+    void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override {
+        const auto& state = *state_;
+        dest.append(state.prefix.data(), state.prefix.data() + state.prefix.size());
+        dest.append(msg.payload.begin(), msg.payload.end());
+        dest.append(state.eol.data(), state.eol.data() + state.eol.size());
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override {
+        return std::make_unique<message_formatter>(state_);
+    }
+
+private:
+    std::shared_ptr<const compiled_state> state_;
+};
+
+} // namespace details
+
+} // namespace patterns
+
+// Паттерн, разобранный и проверенный один раз. Копии разделяют разобранное состояние;
+// make_formatter() дает formatter для отдельного sink'а (у pattern_formatter есть
+// кэш времени, поэтому один экземпляр на несколько sink'ов не годится)
+class CompiledPattern {
+public:
+    // Неизвестный флаг, '%' в конце или ширина больше 64 - ошибка, а не текст в выводе
+    static std::optional<CompiledPattern> compile(std::string_view pattern, QString* error = nullptr) {
+        auto state = std::make_shared<patterns::details::compiled_state>();
+        state->pattern = std::string(pattern);
+
+        auto fail = [&](std::size_t position, const QString& message) {
+            if (error) {
+                *error = QString("pattern '%1', position %2: %3")
+                             .arg(QString::fromStdString(state->pattern))
+                             .arg(position)
+                             .arg(message);
+            }
+            return std::nullopt;
+        };
+
+        bool constant_prefix = true;
+        std::size_t messages = 0;
+        for (std::size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] != '%') {
+                if (messages > 0) {
+                    constant_prefix = false;
+                }
+                state->prefix += pattern[i];
+                state->formatter_pattern += pattern[i];
+                continue;
+            }
+
+            // Дата и время целиком - одним флагом из общего кэша
+            const std::string_view rest = pattern.substr(i);
+            const std::pair<std::string_view, char> cached[] = {
+                {"%Y-%m-%d %H:%M:%S", patterns::details::datetime_flag},
+                {"%H:%M:%S", patterns::details::time_flag},
+                {"%T", patterns::details::time_flag}};
+            bool replaced = false;
+            for (const auto& [sequence, flag] : cached) {
+                if (rest.substr(0, sequence.size()) == sequence) {
+                    state->formatter_pattern += '%';
+                    state->formatter_pattern += flag;
+                    i += sequence.size() - 1;
+                    constant_prefix = false;
+                    replaced = true;
+                    break;
+                }
+            }
+            if (replaced) {
+                continue;
+            }
+
+            const std::size_t start = i++;
+            bool padded = false;
+            if (i < pattern.size() && (pattern[i] == '-' || pattern[i] == '=')) {
+                ++i;
+            }
+            std::size_t width = 0;
+            while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9') {
+                width = width * 10 + static_cast<std::size_t>(pattern[i++] - '0');
+                padded = true;
+                if (width > 64) {
+                    return fail(start, QStringLiteral("padding width exceeds 64"));
+                }
+            }
+            // '!' после ширины - усечение; без ширины это флаг %! (имя функции)
+            if (padded && i < pattern.size() && pattern[i] == '!' && i + 1 < pattern.size()) {
+                ++i;
+            }
+            if (i >= pattern.size()) {
+                return fail(start, QStringLiteral("incomplete flag at the end"));
+            }
+            if (!patterns::details::is_known_flag(pattern[i])) {
+                return fail(start, QString("unknown flag '%%1'").arg(QChar(pattern[i])));
+            }
+
+            state->formatter_pattern.append(pattern.substr(start, i - start + 1));
+            if (pattern[i] == '%' && !padded && messages == 0) {
+                state->prefix += '%';
+            } else if (pattern[i] == 'v' && !padded) {
+                ++messages;
+            } else {
+                constant_prefix = false;
+            }
+        }
+
+        if (constant_prefix && messages == 1 && pattern.size() >= 2 && pattern.substr(pattern.size() - 2) == "%v") {
+            state->kind = state->prefix.empty() ? patterns::layout::message_only : patterns::layout::prefix_message;
+        } else {
+            state->prefix.clear();
+        }
+        return CompiledPattern(std::move(state));
+    }
+
+    static std::optional<CompiledPattern> compile(const QString& pattern, QString* error = nullptr) {
+        return compile(pattern.toStdString(), error);
+    }
+
+    QString pattern() const { return QString::fromStdString(state_->pattern); }
+    patterns::layout layout() const { return state_->kind; }
+
+    // Новый formatter для sink'а; для быстрых путей без разбора паттерна
+    std::unique_ptr<spdlog::formatter> make_formatter() const {
+        if (state_->kind != patterns::layout::general) {
+            return std::make_unique<patterns::details::message_formatter>(state_);
+        }
+        return patterns::details::make_pattern_formatter(state_->formatter_pattern);
+    }
+
+private:
+    explicit CompiledPattern(std::shared_ptr<const patterns::details::compiled_state> state)
+        : state_(std::move(state)) {}
+
+    std::shared_ptr<const patterns::details::compiled_state> state_;
+};
+
+namespace patterns {
+
+namespace details {
+
+// Встроенные паттерны заведомо корректны
+inline CompiledPattern preset(std::string_view pattern) {
+    return *CompiledPattern::compile(pattern);
+}
+
+class swappable_formatter;
+
+// Общий паттерн, на который ссылаются formatter'ы всех sink'ов после set_pattern():
+// смена паттерна не обходит реестр под его мьютексом. formatters - живые
+// swappable_formatter, каждому новый formatter собирается до публикации
+struct pattern_slot {
+    std::mutex mutex; // сериализует set_pattern, создание и удаление formatter'ов
+    std::atomic<std::uint64_t> generation{0};
+    std::shared_ptr<const CompiledPattern> current;
+    std::vector<swappable_formatter*> formatters;
+};
+
+// Не разрушается: formatter'ы реестра spdlog удаляются при выходе позже статических объектов
+inline pattern_slot& global_slot() {
+    static auto* slot = new pattern_slot;
+    return *slot;
+}
+
+// Formatter sink'а, следящий за общим паттерном. format() вызывается под мьютексом
+// sink'а и при смене поколения только забирает готовый formatter, без разбора паттерна
+class swappable_formatter final : public spdlog::formatter {
+public:
+    swappable_formatter() {
+        auto& slot = global_slot();
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        generation_ = slot.generation.load(std::memory_order_relaxed);
+        if (slot.current) {
+            formatter_ = slot.current->make_formatter();
+        }
+        slot.formatters.push_back(this);
+    }
+
+    ~swappable_formatter() override {
+        auto& slot = global_slot();
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            slot.formatters.erase(std::find(slot.formatters.begin(), slot.formatters.end(), this));
+        }
+        delete pending_.load(std::memory_order_acquire);
+    }
+
+    swappable_formatter(const swappable_formatter&) = delete;
+    swappable_formatter& operator=(const swappable_formatter&) = delete;
+
+    void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override {
+        const auto generation = global_slot().generation.load(std::memory_order_acquire);
+        if (generation != generation_) {
+            generation_ = generation;
+            if (auto* next = pending_.exchange(nullptr, std::memory_order_acquire)) {
+                formatter_.reset(next);
+            }
+        }
+        if (formatter_) {
+            formatter_->format(msg, dest);
+        }
+    }
+
+    std::unique_ptr<spdlog::formatter> clone() const override {
+        return std::make_unique<swappable_formatter>();
+    }
+
+    // Под мьютексом слота, до смены поколения. Невостребованный прежний formatter удаляется
+    void publish(std::unique_ptr<spdlog::formatter> formatter) {
+        delete pending_.exchange(formatter.release(), std::memory_order_acq_rel);
+    }
+
+private:
+    std::uint64_t generation_ = 0;
+    std::unique_ptr<spdlog::formatter> formatter_;
+    std::atomic<spdlog::formatter*> pending_{nullptr};
+};
+
+} // namespace details
+
+// Предустановленные паттерны, разобранные один раз
+inline const CompiledPattern DEFAULT = details::preset("%^[%T] [%l]%$ %v");
+inline const CompiledPattern SIMPLE = details::preset("[%H:%M:%S] [%l] %v");
+inline const CompiledPattern DETAILED = details::preset("%^[%Y-%m-%d %H:%M:%S.%e] [%l] [%n]%$ %v");
+inline const CompiledPattern LOCATION = details::preset("%^[%Y-%m-%d %H:%M:%S.%e] [%l] [TID=%t] [%s:%#] [%!]%$ %v");
+inline const CompiledPattern QT_STYLE = details::preset("%^[%T] [%l]%$ %v");
+inline const CompiledPattern THREAD_ID = details::preset("%^[%T] [%l] [TID=%t]%$ %v");
+inline const CompiledPattern CONTEXT = details::preset("%^[%T] [%l]%$ [%&] %v");
+inline const CompiledPattern MESSAGE = details::preset("%v");
+}
+
+// pattern_formatter с флагами qt_spdlog (%& - контекст потока) для set_formatter sink'а
+inline std::unique_ptr<spdlog::pattern_formatter> make_pattern_formatter(const QString& pattern) {
+    return patterns::details::make_pattern_formatter(pattern.toStdString());
+}
+
+// Общий паттерн для всех логгеров. Sink'и, уже следящие за общим паттерном
+// (в том числе логгеров вне реестра), получают собранный здесь formatter и
+// переключаются на него атомарно на следующей записи. Затем через реестр
+// (spdlog::set_formatter) formatter ставится всем зарегистрированным логгерам:
+// так паттерн доходит и до логгеров из register_logger/set_default_logger, и до
+// sink'ов, чей formatter заменили напрямую (logger->set_pattern/set_formatter)
+inline bool set_pattern(const CompiledPattern& pattern) {
+    auto& slot = patterns::details::global_slot();
+    try {
+        auto next = std::make_shared<const CompiledPattern>(pattern);
+        std::vector<std::unique_ptr<spdlog::formatter>> formatters;
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        formatters.reserve(slot.formatters.size());
+        for (std::size_t i = 0; i < slot.formatters.size(); ++i) {
+            formatters.push_back(next->make_formatter());
+        }
+        // Дальше исключений нет: паттерн публикуется всем sink'ам сразу
+        for (std::size_t i = 0; i < slot.formatters.size(); ++i) {
+            slot.formatters[i]->publish(std::move(formatters[i]));
+        }
+        slot.current = std::move(next);
+        slot.generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to set log pattern '" << pattern.pattern().toStdString() << "': " << e.what() << std::endl;
+        return false;
+    }
+
+    // Новые swappable_formatter собираются из slot.current, мьютекс слота уже отпущен
+    try {
+        spdlog::set_formatter(std::make_unique<patterns::details::swappable_formatter>());
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Failed to set log pattern '" << pattern.pattern().toStdString() << "': " << e.what() << std::endl;
+        return false;
+    }
+}
+
+inline bool set_pattern(const QString& pattern) {
+    QString error;
+    const auto compiled = CompiledPattern::compile(pattern, &error);
+    if (!compiled) {
+        std::cerr << "Failed to set log pattern: " << error.toStdString() << std::endl;
+        return false;
+    }
+    return set_pattern(*compiled);
+}
+
+inline bool set_default_pattern() {
+    return set_pattern(patterns::DEFAULT);
+}
+
+inline bool set_simple_pattern() {
+    return set_pattern(patterns::SIMPLE);
+}
+
+inline bool set_detailed_pattern() {
+    return set_pattern(patterns::DETAILED);
+}
+
+inline bool set_location_pattern() {
+    return set_pattern(patterns::LOCATION);
+}
+
+inline bool set_qt_style_pattern() {
+    return set_pattern(patterns::QT_STYLE);
+}
+
+inline bool set_thread_id_pattern() {
+    return set_pattern(patterns::THREAD_ID);
+}
+
+// ============================================================================
+// КАТЕГОРИИ QT: ОТДЕЛЬНЫЙ ЛОГГЕР НА QLoggingCategory
+// ============================================================================
+
+namespace categories {
+
+namespace details {
+
+struct bridge_state {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<spdlog::logger>> by_name;
+    QLoggingCategory::CategoryFilter previous_filter = nullptr;
+    std::atomic<bool> installed{false};
+};
+
+inline bridge_state& get_state() {
+    static bridge_state state;
+    return state;
+}
+
+// Логгер категории: уже зарегистрированный в spdlog с тем же именем
+// или клон логгера по умолчанию (те же sink'и, его уровень)
+inline std::shared_ptr<spdlog::logger> create_logger(const std::string& name) {
+    if (name == "default") {
+        return spdlog::default_logger();
+    }
+    if (auto existing = spdlog::get(name)) {
+        hierarchy::attach(existing);
+        return existing;
+    }
+    auto logger = spdlog::default_logger()->clone(name);
+    levels::apply_pending(*logger);
+    try {
+        spdlog::register_logger(logger);
+    }
+    catch (const spdlog::spdlog_ex&) {
+        // Зарегистрирован параллельно из другого места
+        if (auto existing = spdlog::get(name)) {
+            return existing;
+        }
+    }
+    hierarchy::attach(logger);
+    invalidate_logger_handles();
+    return logger;
+}
+
+inline void category_filter(QLoggingCategory* category);
+
+// Кэш потока: логгер категории по указателю на ее имя. Qt передает один и тот же
+// указатель и в фильтр, и в QMessageLogContext::category, но имя категории из QML
+// или динамической QLoggingCategory может освободиться, а адрес - достаться другой.
+// Поэтому запись сверяется еще и по тексту имени и по поколению дескрипторов
+struct cached_category {
+    const char* pointer = nullptr;
+    std::uint64_t generation = 0;
+    std::string name;
+    std::shared_ptr<spdlog::logger> logger;
+};
+
+inline constexpr std::size_t category_cache_size = 64;
+
+inline cached_category& cache_slot(const char* category) {
+    thread_local std::array<cached_category, category_cache_size> cache;
+    auto hash = reinterpret_cast<std::uintptr_t>(category);
+    return cache[(hash ^ (hash >> 7)) % category_cache_size];
+}
+
+} // namespace details
+
+inline bool is_installed() {
+    return details::get_state().installed.load(std::memory_order_acquire);
+}
+
+// Логгер для имени категории из QMessageLogContext. Повторные сообщения категории
+// берут логгер из кэша потока без блокировок; общая таблица ключуется по имени
+inline std::shared_ptr<spdlog::logger> logger_for(const char* category) {
+    if (!category) {
+        return spdlog::default_logger();
+    }
+    auto& entry = details::cache_slot(category);
+    const auto generation = handles::details::get_state().generation.load(std::memory_order_acquire);
+    if (entry.pointer == category && entry.generation == generation && entry.name == category) {
+        return entry.logger;
+    }
+
+    auto& state = details::get_state();
+    std::string name(category);
+    std::shared_ptr<spdlog::logger> logger;
+    {
+        std::shared_lock<std::shared_mutex> lock(state.mutex);
+        auto it = state.by_name.find(name);
+        if (it != state.by_name.end()) {
+            logger = it->second;
+        }
+    }
+    if (!logger) {
+        std::unique_lock<std::shared_mutex> lock(state.mutex);
+        auto& by_name = state.by_name[name];
+        if (!by_name) {
+            by_name = details::create_logger(name);
+        }
+        logger = by_name;
+    }
+
+    // Поколение читается до поиска: смена логгеров во время поиска не закрепится в кэше
+    entry.pointer = category;
+    entry.generation = generation;
+    entry.name = std::move(name);
+    entry.logger = logger;
+    return logger;
+}
+
+inline std::shared_ptr<spdlog::logger> get_logger(const QString& category) {
+    auto& state = details::get_state();
+    std::string name = category.toStdString();
+    std::unique_lock<std::shared_mutex> lock(state.mutex);
+    auto& logger = state.by_name[name];
+    if (!logger) {
+        logger = details::create_logger(name);
+    }
+    return logger;
+}
+
+// Qt заново вызывает фильтр для всех категорий и обновляет isDebugEnabled() и т.д.
+inline void refresh() {
+    if (is_installed()) {
+        QLoggingCategory::installFilter(&details::category_filter);
+    }
+}
+
+inline void set_level(const QString& category, spdlog::level::level_enum level) {
+    get_logger(category)->set_level(level);
+    refresh();
+}
+
+// Уровни логгеров становятся единственным источником включенности категорий:
+// отключенные qCDebug отсекаются встроенной проверкой Qt до построения сообщения
+inline void install() {
+    auto& state = details::get_state();
+    if (state.installed.exchange(true)) {
+        refresh();
+        return;
+    }
+    state.previous_filter = QLoggingCategory::installFilter(&details::category_filter);
+}
+
+inline void uninstall() {
+    auto& state = details::get_state();
+    if (state.installed.exchange(false)) {
+        QLoggingCategory::installFilter(state.previous_filter);
+        state.previous_filter = nullptr;
+    }
+}
+
+// Сбрасывает кэш логгеров категорий (например, после смены логгера по умолчанию)
+inline void reset() {
+    auto& state = details::get_state();
+    {
+        std::unique_lock<std::shared_mutex> lock(state.mutex);
+        for (const auto& entry : state.by_name) {
+            if (entry.first != "default" && entry.second && entry.second != spdlog::default_logger()) {
+                spdlog::drop(entry.first);
+            }
+        }
+        state.by_name.clear();
+    }
+    invalidate_logger_handles();
+    refresh();
+}
+
+inline void details::category_filter(QLoggingCategory* category) {
+    auto logger = logger_for(category->categoryName());
+    category->setEnabled(QtDebugMsg, logger->should_log(spdlog::level::debug));
+    category->setEnabled(QtInfoMsg, logger->should_log(spdlog::level::info));
+    category->setEnabled(QtWarningMsg, logger->should_log(spdlog::level::warn));
+    category->setEnabled(QtCriticalMsg, logger->should_log(spdlog::level::err));
+}
+
+} // namespace categories
+
+// ============================================================================
+// ИНТЕГРАЦИЯ С QT MESSAGE HANDLER
+// ============================================================================
+
+namespace details {
+
+inline spdlog::level::level_enum qt_message_level(QtMsgType type) {
+    switch (type) {
+    case QtDebugMsg: return spdlog::level::debug;
+    case QtInfoMsg: return spdlog::level::info;
+    case QtWarningMsg: return spdlog::level::warn;
+    case QtCriticalMsg: return spdlog::level::err;
+    case QtFatalMsg: return spdlog::level::critical;
+    default: return spdlog::level::info;  // для будущих типов
+    }
+}
+
+inline void format_qt_payload(spdlog::memory_buf_t& buffer, const char* category, const QString& msg,
+                              bool tag_category) {
+    if (tag_category && category && std::strcmp(category, "default") != 0) {
+        buffer.push_back('[');
+        buffer.append(spdlog::string_view_t(category));
+        buffer.append(spdlog::string_view_t("] "));
+    }
+    utils::append_utf8(buffer, msg);
+}
+
+// Сообщение Qt с file/line/function из контекста. Категория (кроме "default")
+// добавляется префиксом [category], если запись идет не в логгер категории;
+// текст перекодируется сразу в буфер записи
+inline void log_qt_message(spdlog::logger& logger, QtMsgType type, const QMessageLogContext& context,
+                           const QString& msg, bool tag_category = true) {
+    auto level = qt_message_level(type);
+    if (!logger.should_log(level)) {
+        return;
+    }
+
+    spdlog::memory_buf_t buffer;
+    format_qt_payload(buffer, context.category, msg, tag_category);
+
+    spdlog::source_loc location{context.file, context.line, context.function};
+    logger.log(location, level, spdlog::string_view_t(buffer.data(), buffer.size()));
+}
+
+} // namespace details
+
+namespace details {
+
+// Обработчик Qt, действовавший до установки нашего
+inline QtMessageHandler& original_qt_handler() {
+    static QtMessageHandler handler = nullptr;
+    return handler;
+}
+
+inline void save_original_qt_handler(bool preserve_original) {
+    if (preserve_original && !original_qt_handler()) {
+        original_qt_handler() = qInstallMessageHandler(nullptr);
+    }
+}
+
+inline bool& qt_handler_active() {
+    thread_local bool active = false;
+    return active;
+}
+
+// Защита от рекурсии: sink, вызвавший qWarning() во время записи,
+// не должен снова попасть в логгер (рекурсия или взаимоблокировка на мьютексе sink'а)
+class qt_handler_guard {
+public:
+    qt_handler_guard() : previous_(qt_handler_active()) { qt_handler_active() = true; }
+    ~qt_handler_guard() { qt_handler_active() = previous_; }
+
+    qt_handler_guard(const qt_handler_guard&) = delete;
+    qt_handler_guard& operator=(const qt_handler_guard&) = delete;
+
+    bool reentered() const { return previous_; }
+
+private:
+    bool previous_;
+};
+
+// Повторный вход уходит в исходный обработчик Qt или в stderr
+inline void write_reentrant_qt_message(QtMsgType type, const QMessageLogContext& context, const QString& msg) {
+    if (original_qt_handler()) {
+        original_qt_handler()(type, context, msg);
+    } else {
+        std::cerr << "qt_spdlog (reentrant): " << msg.toStdString() << std::endl;
+    }
+}
 
-                // default win console level colors
-                // colors_[level::trace] = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;     // white
-                // colors_[level::debug] = FOREGROUND_GREEN | FOREGROUND_BLUE;                      // cyan
-                // colors_[level::info] = FOREGROUND_GREEN;                                         // green
-                // colors_[level::warn] = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY; // intense yellow
-                // colors_[level::err] = FOREGROUND_RED | FOREGROUND_INTENSITY;                     // intense red
-                // colors_[level::critical] =
-                //     BACKGROUND_RED | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY; // intense white on red background
-                // colors_[level::off] = 0;
+} // namespace details
 
-                // console_sink->set_color(spdlog::level::off, "\033[1;36m");      // ALWAYS - яркий cyan
-                // console_sink->set_color(spdlog::level::critical, "\033[1;31m"); // CRITICAL - яркий red
-                // console_sink->set_color(spdlog::level::err, "\033[1;31m");      // ERROR - яркий red
-                // console_sink->set_color(spdlog::level::warn, "\033[1;33m");     // WARN - яркий yellow
-                // console_sink->set_color(spdlog::level::info, "\033[1;32m");     // INFO - яркий green
-                // console_sink->set_color(spdlog::level::debug, "\033[1;34m");    // DEBUG - яркий blue
-                // console_sink->set_color(spdlog::level::trace, "\033[1;37m");    // TRACE - яркий white
+inline void setup_qt_message_handler(bool preserve_original = true) {
+    details::save_original_qt_handler(preserve_original);
+
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+        details::qt_handler_guard guard;
+        if (guard.reentered()) {
+            details::write_reentrant_qt_message(type, context, msg);
+            return;
+        }
+
+        try {
+            // При установленном мосте категорий каждая категория пишет в свой логгер
+            bool bridged = categories::is_installed();
+            auto logger = bridged ? categories::logger_for(context.category) : spdlog::default_logger();
+            details::log_qt_message(*logger, type, context, msg, !bridged);
+
+            if (type == QtFatalMsg) {
+                logger->flush();
+                std::abort();
+            }
 
+        } catch (const std::exception& e) {
+            std::cerr << "Qt logging failed: " << e.what() << std::endl;
+            if (details::original_qt_handler()) {
+                details::original_qt_handler()(type, context, msg);
             }
         }
     });
 }
 
+// Мост категорий вместе с обработчиком сообщений: один набор уровней spdlog
+// управляет и логгерами, и включенностью QLoggingCategory
+inline void setup_qt_category_bridge(bool preserve_original = true) {
+    categories::install();
+    setup_qt_message_handler(preserve_original);
+}
+
 // ============================================================================
-// ВРЕМЕННЫЕ ЛОГГЕРЫ
+// КОНТЕКСТНОЕ ОКНО: ДАМП ИСТОРИИ ПРИ ОШИБКЕ
 // ============================================================================
 
-// Для основного логгера "qt" с уровнем из строки
-inline scoped::ScopedLoggerLevel create_scoped_logger(const QString& level_name) {
-    if (!is_valid_level(level_name)) {
-        // Возвращаем неактивный объект
-        return scoped::ScopedLoggerLevel("", spdlog::level::info);
+namespace details {
+
+// Отправка готовой записи напрямую в sink'и логгера, минуя проверку уровня логгера
+inline void dispatch_to_sinks(spdlog::logger& logger, const spdlog::details::log_msg& msg) {
+    for (auto& sink : logger.sinks()) {
+        if (!sink->should_log(msg.level)) {
+            continue;
+        }
+        try {
+            sink->log(msg);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "qt_spdlog: sink failed: " << e.what() << std::endl;
+        }
     }
-    spdlog::level::level_enum level = string_to_level(level_name);
-    return scoped::ScopedLoggerLevel("qt", level);
 }
 
-// Для основного логгера "qt" с уровнем spdlog
-inline scoped::ScopedLoggerLevel create_scoped_logger(spdlog::level::level_enum level) {
-    return scoped::ScopedLoggerLevel("qt", level);
-}
+} // namespace details
 
-// Для конкретного логгера по имени с уровнем из строки
-inline scoped::ScopedLoggerLevel create_scoped_logger(const QString& logger_name, const QString& level_name) {
-    if (!is_valid_level(level_name)) {
-        return scoped::ScopedLoggerLevel("", spdlog::level::info);
+namespace backtrace {
+
+// Чьи записи выводятся перед ошибкой
+enum class dump_scope {
+    current_thread, // только история потока, в котором произошла ошибка
+    all_threads     // история всех потоков
+};
+
+namespace details {
+
+// Размер встроенного буфера под аргументы одной записи
+inline constexpr std::size_t record_storage_size = 160;
+
+// "Сырая" запись: аргументы хранятся как есть, форматирование откладывается до дампа
+struct raw_record {
+    const spdlog::logger* owner = nullptr; // логгер, отбросивший запись; только для сравнения
+    spdlog::level::level_enum level{spdlog::level::off};
+    spdlog::log_clock::time_point time;
+    void (*render)(const void* args, spdlog::memory_buf_t& dest) = nullptr;
+    void (*destroy)(void* args) = nullptr;
+    alignas(std::max_align_t) unsigned char storage[record_storage_size];
+
+    void reset() {
+        if (destroy) {
+            destroy(storage);
+        }
+        render = nullptr;
+        destroy = nullptr;
+        owner = nullptr;
     }
-    spdlog::level::level_enum level = string_to_level(level_name);
-    return scoped::ScopedLoggerLevel(logger_name.toStdString(), level);
-}
+};
 
-// Для конкретного логгера с уровнем spdlog
-inline scoped::ScopedLoggerLevel create_scoped_logger(const QString& logger_name, spdlog::level::level_enum level) {
-    return scoped::ScopedLoggerLevel(logger_name.toStdString(), level);
-}
+// Отрендеренная копия записи: выводится в sink'и уже после освобождения кольца
+struct rendered_record {
+    spdlog::level::level_enum level;
+    spdlog::log_clock::time_point time;
+    std::size_t thread_id;
+    std::string text;
+};
 
-// ============================================================================
-// THREAD-LOCAL ЛОГГЕРЫ
-// ============================================================================
+struct state {
+    std::atomic<bool> enabled{false};
+    std::atomic<std::size_t> capacity{32};
+    std::atomic<std::uint64_t> generation{0};
+    std::atomic<int> scope{static_cast<int>(dump_scope::current_thread)};
+};
 
-// Простое thread-local хранилище для модуля
-inline QThreadStorage<QString>& get_module_storage() {
-    static QThreadStorage<QString> storage;
-    return storage;
+inline state& get_state() {
+    static state instance;
+    return instance;
 }
 
-// Thread-local storage для имени модуля
-inline QString get_current_module_name() {
-    auto& storage = get_module_storage();
-    if (storage.hasLocalData()) {
-        return storage.localData();
+// Все C-строки копируем: по типу const char[N] литерал не отличить от
+// константного локального буфера, а время жизни к моменту дампа не гарантировано
+template<typename T>
+auto store_arg(T&& arg) {
+    using bare_t = std::remove_reference_t<T>;
+    using decayed_t = std::decay_t<T>;
+    if constexpr (std::is_array_v<bare_t>) {
+        return std::string(arg, std::char_traits<char>::length(arg));
+    } else if constexpr (std::is_same_v<decayed_t, const char*> || std::is_same_v<decayed_t, char*>) {
+        return std::string(arg ? arg : "");
+    } else {
+        return decayed_t(std::forward<T>(arg));
     }
-    return "unknown";
 }
 
-inline void set_current_module_name(const QString& module) {
-    auto& storage = get_module_storage();
-    storage.setLocalData(module);
+template<typename First, typename... Rest>
+void format_payload(spdlog::memory_buf_t& dest, const First& first, const Rest&... rest) {
+    if constexpr (sizeof...(Rest) == 0) {
+        if constexpr (std::is_convertible_v<const First&, spdlog::string_view_t>) {
+            spdlog::string_view_t text(first);
+            dest.append(text.data(), text.data() + text.size());
+        } else {
+            fmt::format_to(std::back_inserter(dest), "{}", first);
+        }
+    } else {
+        fmt::vformat_to(std::back_inserter(dest), spdlog::string_view_t(first), fmt::make_format_args(rest...));
+    }
 }
 
-// QThreadStorage для thread-local логгеров
-inline QThreadStorage<std::shared_ptr<spdlog::logger>>& get_logger_storage() {
-    static QThreadStorage<std::shared_ptr<spdlog::logger>> storage;
-    return storage;
+template<typename Tuple>
+void render_tuple(const void* args, spdlog::memory_buf_t& dest) {
+    try {
+        std::apply([&dest](const auto&... stored) {
+            utils::log_with_conversion([&dest](auto... converted_args) {
+                format_payload(dest, converted_args...);
+            }, stored...);
+        }, *static_cast<const Tuple*>(args));
+    }
+    catch (const std::exception& e) {
+        fmt::format_to(std::back_inserter(dest), "[qt_spdlog: ошибка форматирования: {}]", e.what());
+    }
 }
 
-inline std::shared_ptr<spdlog::logger> get_thread_local_logger() {
-    auto& storage = get_logger_storage();
-
-    if (!storage.hasLocalData()) {
-        // Используем хэш std::thread::id для уникальности
-        auto thread_id = std::this_thread::get_id();
-        std::hash<std::thread::id> hasher;
-        auto thread_hash = hasher(thread_id);
+template<typename Tuple>
+void destroy_tuple(void* args) {
+    static_cast<Tuple*>(args)->~Tuple();
+}
 
-        auto current_module = get_current_module_name().toStdString();
-        auto logger_name = current_module + "_" + std::to_string(thread_hash);
+// Кольцо последних записей одного потока.
+// Пишет только поток-владелец; флаг busy_ захватывается им без конкуренции
+// и становится спорным лишь во время дампа всех потоков из чужого потока.
+class thread_ring {
+public:
+    thread_ring() : thread_id_(spdlog::details::os::thread_id()) {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.rings.push_back(this);
+    }
 
-        auto logger = spdlog::default_logger()->clone(logger_name);
-        storage.setLocalData(logger);
+    ~thread_ring() {
+        {
+            auto& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.rings.erase(std::remove(reg.rings.begin(), reg.rings.end(), this), reg.rings.end());
+        }
+        clear();
     }
 
-    return storage.localData();
-}
+    thread_ring(const thread_ring&) = delete;
+    thread_ring& operator=(const thread_ring&) = delete;
 
-// Алиасы для удобства
-inline QString get_current_module() {
-    return get_current_module_name();
-}
+    template<typename... Args>
+    void push(const spdlog::logger& owner, spdlog::level::level_enum level, Args&&... args) {
+        guard lock(busy_);
+        sync_with_config();
+        if (!slots_) {
+            return;
+        }
 
-inline void set_current_module(const QString& module) {
-    set_current_module_name(module);
-}
+        raw_record& record = slots_[head_ & mask_];
+        if (head_ - tail_ == capacity_) {
+            ++tail_;
+        }
+        record.reset();
+        record.owner = &owner;
+        record.level = level;
+        record.time = timestamps::now();
+        emplace_args(record, std::forward<Args>(args)...);
+        ++head_;
+    }
 
-namespace scoped {
+    // Рендерит записи логгера owner от старых к новым в out и удаляет их из кольца.
+    // Записи других логгеров остаются до их собственной ошибки
+    void drain(const spdlog::logger& owner, std::vector<rendered_record>& out) {
+        guard lock(busy_);
+        if (generation_ != get_state().generation.load(std::memory_order_acquire)) {
+            // Записи сделаны до последнего enable() - они больше не актуальны
+            clear_unlocked();
+            return;
+        }
+        for (std::uint64_t pos = tail_; pos != head_; ++pos) {
+            raw_record& record = slots_[pos & mask_];
+            if (record.owner != &owner || !record.render) {
+                continue;
+            }
+            spdlog::memory_buf_t buf;
+            record.render(record.storage, buf);
+            out.push_back(rendered_record{record.level, record.time, thread_id_, std::string(buf.data(), buf.size())});
+            record.reset();
+        }
+        // Сдвигаем хвост через уже выведенные записи
+        while (tail_ != head_ && !slots_[tail_ & mask_].render) {
+            ++tail_;
+        }
+    }
 
-// RAII-обертка для временной смены модуля
-class ScopedModule {
-public:
-    ScopedModule(const QString& module)
-        : m_previous_module(get_current_module_name())
-        , m_new_module(module) {
-        set_current_module_name(module);
+    void clear() {
+        guard lock(busy_);
+        clear_unlocked();
     }
 
-    ~ScopedModule() {
-        set_current_module_name(m_previous_module);
+    static thread_ring& local() {
+        thread_local thread_ring ring;
+        return ring;
     }
 
-    // Методы для получения информации
-    QString previous_module() const { return m_previous_module; }
-    QString current_module() const { return m_new_module; }
+    template<typename Visitor>
+    static void for_each_ring(Visitor&& visitor) {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (thread_ring* ring : reg.rings) {
+            visitor(*ring);
+        }
+    }
 
 private:
-    QString m_previous_module;
-    QString m_new_module;
-};
-
-}
+    struct ring_registry {
+        std::mutex mutex;
+        std::vector<thread_ring*> rings;
+    };
 
-// Основной фабричный метод
-inline scoped::ScopedModule module(const QString& module_name) {
-    return scoped::ScopedModule(module_name);
-}
+    static ring_registry& registry() {
+        static ring_registry instance;
+        return instance;
+    }
 
-// ============================================================================
-// УПРАВЛЕНИЕ ПАТТЕРНАМИ
-// ============================================================================
+    class guard {
+    public:
+        explicit guard(std::atomic_flag& flag) : flag_(flag) {
+            while (flag_.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+        ~guard() { flag_.clear(std::memory_order_release); }
+    private:
+        std::atomic_flag& flag_;
+    };
 
-// Предустановленные паттерны
-namespace patterns {
-inline const QString DEFAULT = "%^[%T] [%l]%$ %v";
-inline const QString SIMPLE = "[%H:%M:%S] [%l] %v";
-inline const QString DETAILED = "%^[%Y-%m-%d %H:%M:%S.%e] [%l] [%n]%$ %v";
-inline const QString LOCATION = "%^[%Y-%m-%d %H:%M:%S.%e] [%l] [TID=%t] [%s:%#] [%!]%$ %v";
-inline const QString QT_STYLE = "%^[%T] [%l]%$ %v";
-inline const QString THREAD_ID = "%^[%T] [%l] [TID=%t]%$ %v";
-}
+    template<typename... Args>
+    static void emplace_args(raw_record& record, Args&&... args) {
+        using tuple_t = std::tuple<decltype(store_arg(std::forward<Args>(args)))...>;
+        if constexpr (sizeof(tuple_t) <= record_storage_size && alignof(tuple_t) <= alignof(std::max_align_t)) {
+            new (record.storage) tuple_t(store_arg(std::forward<Args>(args))...);
+            record.render = &render_tuple<tuple_t>;
+            record.destroy = &destroy_tuple<tuple_t>;
+        } else {
+            // Аргументы не помещаются во встроенный буфер - форматируем сразу
+            using text_t = std::tuple<std::string>;
+            tuple_t stored(store_arg(std::forward<Args>(args))...);
+            spdlog::memory_buf_t buf;
+            render_tuple<tuple_t>(&stored, buf);
+            new (record.storage) text_t(std::string(buf.data(), buf.size()));
+            record.render = &render_tuple<text_t>;
+            record.destroy = &destroy_tuple<text_t>;
+        }
+    }
 
-inline bool set_pattern(const QString& pattern) {
-    try {
-        spdlog::set_pattern(pattern.toUtf8().constData());
-        return true;
+    void sync_with_config() {
+        auto& st = get_state();
+        auto generation = st.generation.load(std::memory_order_acquire);
+        if (slots_ && generation == generation_) {
+            return;
+        }
+        clear_unlocked();
+        generation_ = generation;
+        std::size_t requested = st.capacity.load(std::memory_order_relaxed);
+        std::size_t capacity = 1;
+        while (capacity < requested) {
+            capacity <<= 1;
+        }
+        if (!slots_ || capacity != capacity_) {
+            slots_ = std::make_unique<raw_record[]>(capacity);
+            capacity_ = capacity;
+            mask_ = capacity - 1;
+        }
     }
-    catch (const std::exception& e) {
-        std::cerr << "Failed to set log pattern '" << pattern.toStdString() << "': " << e.what() << std::endl;
-        return false;
+
+    void clear_unlocked() {
+        for (; slots_ && tail_ != head_; ++tail_) {
+            slots_[tail_ & mask_].reset();
+        }
+        head_ = tail_ = 0;
     }
-    catch (...) {
-        std::cerr << "Failed to set log pattern '" << pattern.toStdString() << "': unknown error" << std::endl;
-        return false;
+
+    std::atomic_flag busy_ = ATOMIC_FLAG_INIT;
+    std::unique_ptr<raw_record[]> slots_;
+    std::size_t capacity_ = 0;
+    std::size_t mask_ = 0;
+    std::uint64_t head_ = 0;
+    std::uint64_t tail_ = 0;
+    std::uint64_t generation_ = 0;
+    std::size_t thread_id_;
+};
+
+inline void emit_records(spdlog::logger& logger, const std::vector<rendered_record>& records) {
+    for (const auto& record : records) {
+        spdlog::details::log_msg msg(record.time, spdlog::source_loc{}, logger.name(), record.level,
+                                     spdlog::string_view_t(record.text.data(), record.text.size()));
+        msg.thread_id = record.thread_id;
+        qt_spdlog::details::dispatch_to_sinks(logger, msg);
     }
 }
 
-inline bool set_default_pattern() {
-    return set_pattern(patterns::DEFAULT);
+inline void emit_marker(spdlog::logger& logger, const char* text) {
+    spdlog::details::log_msg msg(logger.name(), spdlog::level::off, text);
+    qt_spdlog::details::dispatch_to_sinks(logger, msg);
 }
 
-inline bool set_simple_pattern() {
-    return set_pattern(patterns::SIMPLE);
+} // namespace details
+
+inline bool is_enabled() {
+    return details::get_state().enabled.load(std::memory_order_relaxed);
 }
 
-inline bool set_detailed_pattern() {
-    return set_pattern(patterns::DETAILED);
+// Включает контекстное окно: каждый поток хранит последние records_per_thread
+// записей, отброшенных по уровню, и выводит их перед QT_LOG_ERROR/CRITICAL
+inline void enable(std::size_t records_per_thread = 32, dump_scope scope = dump_scope::current_thread) {
+    auto& st = details::get_state();
+    st.capacity.store(std::max<std::size_t>(records_per_thread, 1), std::memory_order_relaxed);
+    st.scope.store(static_cast<int>(scope), std::memory_order_relaxed);
+    st.generation.fetch_add(1, std::memory_order_release);
+    st.enabled.store(true, std::memory_order_release);
 }
 
-inline bool set_location_pattern() {
-    return set_pattern(patterns::LOCATION);
+inline void disable() {
+    auto& st = details::get_state();
+    st.enabled.store(false, std::memory_order_release);
+    details::thread_ring::for_each_ring([](details::thread_ring& ring) { ring.clear(); });
 }
 
-inline bool set_qt_style_pattern() {
-    return set_pattern(patterns::QT_STYLE);
+inline dump_scope get_scope() {
+    return static_cast<dump_scope>(details::get_state().scope.load(std::memory_order_relaxed));
 }
 
-inline bool set_thread_id_pattern() {
-    return set_pattern(patterns::THREAD_ID);
+// Сохраняет запись в кольцо текущего потока без форматирования
+template<typename... Args>
+inline void capture(const spdlog::logger& logger, spdlog::level::level_enum level, Args&&... args) {
+    details::thread_ring::local().push(logger, level, std::forward<Args>(args)...);
 }
 
-// ============================================================================
-// ИНТЕГРАЦИЯ С QT MESSAGE HANDLER
-// ============================================================================
+// Выводит накопленную историю логгера в его sink'и. Записи сначала копируются
+// из колец, sink'и вызываются уже без блокировок; пустая история ничего не пишет
+inline void dump(spdlog::logger& logger, dump_scope scope) {
+    std::vector<details::rendered_record> records;
+    if (scope == dump_scope::current_thread) {
+        details::thread_ring::local().drain(logger, records);
+    } else {
+        details::thread_ring::for_each_ring([&logger, &records](details::thread_ring& ring) {
+            ring.drain(logger, records);
+        });
+    }
+    if (records.empty()) {
+        return;
+    }
+    details::emit_marker(logger, scope == dump_scope::current_thread
+        ? "****************** Контекст ошибки: начало ******************"
+        : "****************** Контекст ошибки (все потоки): начало ******************");
+    details::emit_records(logger, records);
+    details::emit_marker(logger, "****************** Контекст ошибки: конец *******************");
+}
 
-inline void setup_qt_message_handler(bool preserve_original = true) {
-    static QtMessageHandler original_handler = nullptr;
+inline void dump(dump_scope scope = dump_scope::current_thread) {
+    dump(*spdlog::default_logger(), scope);
+}
 
-    if (preserve_original && !original_handler) {
-        original_handler = qInstallMessageHandler(nullptr);
+// Вызывается макросами перед записью сообщения с уровнем Level
+template<spdlog::level::level_enum Level>
+inline void on_log(spdlog::logger& logger) {
+    if constexpr (Level >= spdlog::level::err && Level != spdlog::level::off) {
+        if (is_enabled()) {
+            dump(logger, get_scope());
+        }
+    } else {
+        (void)logger;
     }
+}
 
-    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &context, const QString &msg) {
-        try {
-            spdlog::level::level_enum level;
-            switch(type) {
-            case QtDebugMsg: level = spdlog::level::debug; break;
-            case QtInfoMsg: level = spdlog::level::info; break;
-            case QtWarningMsg: level = spdlog::level::warn; break;
-            case QtCriticalMsg: level = spdlog::level::err; break;
-            case QtFatalMsg: level = spdlog::level::critical; break;
-            default: level = spdlog::level::info; break;  // для будущих типов
-            }
-
-            std::string message = msg.toStdString();
-            spdlog::default_logger()->log(level, message);
+} // namespace backtrace
 
-            if (type == QtFatalMsg) {
-                std::abort();
-            }
+// Алиасы для удобства
+inline void enable_context_window(std::size_t records_per_thread = 32,
+                                  backtrace::dump_scope scope = backtrace::dump_scope::current_thread) {
+    backtrace::enable(records_per_thread, scope);
+}
 
-        } catch (const std::exception& e) {
-            std::cerr << "Qt logging failed: " << e.what() << std::endl;
-            if (original_handler) {
-                original_handler(type, context, msg);
-            }
-        }
-    });
+inline void disable_context_window() {
+    backtrace::disable();
 }
 
 } // namespace qt_spdlog
@@ -911,10 +5089,16 @@ inline void setup_qt_message_handler(bool preserve_original = true) {
 do { \
         auto _logger = (logger_ptr); \
         if (_logger->should_log(spdlog::level::level_enum)) { \
+            qt_spdlog::latency::details::call_timer _timer; \
+            qt_spdlog::backtrace::on_log<spdlog::level::level_enum>(*_logger); \
             qt_spdlog::utils::log_with_conversion( \
                                                    [_logger](auto... converted_args) { \
-                                                           _logger->level_name(converted_args...); \
+                                                           qt_spdlog::details::format_and_log( \
+                                                               *_logger, spdlog::level::level_enum, converted_args...); \
                                                    }, __VA_ARGS__); \
+    } else if (qt_spdlog::backtrace::is_enabled()) { \
+            /* Отброшенная запись попадает в контекстное окно без форматирования */ \
+            qt_spdlog::backtrace::capture(*_logger, spdlog::level::level_enum, __VA_ARGS__); \
     } \
 } while(0)
 
@@ -978,6 +5162,19 @@ do { \
 #define QT_LOGGER_ERROR(logger, ...)    QT_LOG_INTERNAL(logger, error, err, __VA_ARGS__)
 #define QT_LOGGER_CRITICAL(logger, ...) QT_LOG_INTERNAL(logger, critical, critical, __VA_ARGS__)
 
+// Логгер по имени через дескриптор на месте вызова: имя разрешается один раз на поток.
+// QT_LOGGER_INFO(QT_SPDLOG_LOGGER("net.http"), "...") вместо spdlog::get("net.http")
+
+#ifdef QT_SPDLOG_LOGGER
+#undef QT_SPDLOG_LOGGER
+#endif
+
+#define QT_SPDLOG_LOGGER(name) \
+    ([]() -> spdlog::logger* { \
+        static const qt_spdlog::logger_handle handle(name); \
+        return handle.get(); \
+    }())
+
 // ============================================================================
 // МАКРОСЫ ДЛЯ УСЛОВНОГО ЛОГИРОВАНИЯ
 // ============================================================================
@@ -1059,6 +5256,7 @@ do { \
 #define QT_LOG_ALWAYS(...) \
         do { \
             auto _logger = spdlog::default_logger(); \
+            qt_spdlog::latency::details::call_timer _timer; \
             /* Принудительно логируем, игнорируя текущий уровень */ \
             qt_spdlog::utils::log_with_conversion( \
                                                    [_logger](auto... converted_args) { \
@@ -1073,6 +5271,7 @@ do { \
 #define QT_LOG_ALWAYS_TS(...) \
         do { \
             auto _logger = qt_spdlog::get_thread_local_logger(); \
+            qt_spdlog::latency::details::call_timer _timer; \
             qt_spdlog::utils::log_with_conversion( \
                                                    [_logger](auto... converted_args) { \
                                                            _logger->log(spdlog::level::off, converted_args...); \
@@ -1083,6 +5282,20 @@ do { \
 // МАКРОСЫ ОТЛАДОЧНОЙ ИНФОРМАЦИЕЙ НО БЕЗ ФОРМАТИРОВАНИЯ
 // ============================================================================
 
+#ifdef QT_LOG_LOCATION_INTERNAL
+#undef QT_LOG_LOCATION_INTERNAL
+#endif
+
+// Запись с местом вызова (файл, строка, функция) без форматирования
+#define QT_LOG_LOCATION_INTERNAL(logger_ptr, level, msg) \
+do { \
+    auto _logger = (logger_ptr); \
+    if (_logger->should_log(level)) { \
+        qt_spdlog::latency::details::call_timer _timer; \
+        _logger->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, msg); \
+    } \
+} while(0)
+
 #ifdef QT_LOG_TRACE_LOCATION
 #undef QT_LOG_TRACE_LOCATION
 #endif
@@ -1103,20 +5316,20 @@ do { \
 #endif
 
 // Макросы с сообщением но без форматирования (только static string)
-#define QT_LOG_TRACE_LOCATION()    SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::trace, "")
-#define QT_LOG_DEBUG_LOCATION()    SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::debug, "")
-#define QT_LOG_INFO_LOCATION()     SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::info, "")
-#define QT_LOG_WARN_LOCATION()     SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::warn, "")
-#define QT_LOG_ERROR_LOCATION()    SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::err, "")
-#define QT_LOG_CRITICAL_LOCATION() SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::critical, "")
+#define QT_LOG_TRACE_LOCATION()    QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::trace, "")
+#define QT_LOG_DEBUG_LOCATION()    QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::debug, "")
+#define QT_LOG_INFO_LOCATION()     QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::info, "")
+#define QT_LOG_WARN_LOCATION()     QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::warn, "")
+#define QT_LOG_ERROR_LOCATION()    QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::err, "")
+#define QT_LOG_CRITICAL_LOCATION() QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::critical, "")
 
 // Thread-local версии
-#define QT_LOG_TRACE_LOCATION_TS()    SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::trace, "")
-#define QT_LOG_DEBUG_LOCATION_TS()    SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::debug, "")
-#define QT_LOG_INFO_LOCATION_TS()      SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::info, "")
-#define QT_LOG_WARN_LOCATION_TS()     SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::warn, "")
-#define QT_LOG_ERROR_LOCATION_TS()    SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::err, "")
-#define QT_LOG_CRITICAL_LOCATION_TS() SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::critical, "")
+#define QT_LOG_TRACE_LOCATION_TS()    QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::trace, "")
+#define QT_LOG_DEBUG_LOCATION_TS()    QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::debug, "")
+#define QT_LOG_INFO_LOCATION_TS()      QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::info, "")
+#define QT_LOG_WARN_LOCATION_TS()     QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::warn, "")
+#define QT_LOG_ERROR_LOCATION_TS()    QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::err, "")
+#define QT_LOG_CRITICAL_LOCATION_TS() QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::critical, "")
 
 #ifdef QT_LOG_TRACE_LOCATION_MSG
 #undef QT_LOG_TRACE_LOCATION_MSG
@@ -1138,20 +5351,20 @@ do { \
 #endif
 
 // Макросы с сообщением но без форматирования (только static string)
-#define QT_LOG_TRACE_LOCATION_MSG(msg)    SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::trace, msg)
-#define QT_LOG_DEBUG_LOCATION_MSG(msg)    SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::debug, msg)
-#define QT_LOG_INFO_LOCATION_MSG(msg)     SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::info, msg)
-#define QT_LOG_WARN_LOCATION_MSG(msg)     SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::warn, msg)
-#define QT_LOG_ERROR_LOCATION_MSG(msg)    SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::err, msg)
-#define QT_LOG_CRITICAL_LOCATION_MSG(msg) SPDLOG_LOGGER_CALL(spdlog::default_logger(), spdlog::level::critical, msg)
+#define QT_LOG_TRACE_LOCATION_MSG(msg)    QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::trace, msg)
+#define QT_LOG_DEBUG_LOCATION_MSG(msg)    QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::debug, msg)
+#define QT_LOG_INFO_LOCATION_MSG(msg)     QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::info, msg)
+#define QT_LOG_WARN_LOCATION_MSG(msg)     QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::warn, msg)
+#define QT_LOG_ERROR_LOCATION_MSG(msg)    QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::err, msg)
+#define QT_LOG_CRITICAL_LOCATION_MSG(msg) QT_LOG_LOCATION_INTERNAL(spdlog::default_logger(), spdlog::level::critical, msg)
 
 // Thread-local версии
-#define QT_LOG_TRACE_LOCATION_MSG_TS(msg)    SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::trace, msg)
-#define QT_LOG_DEBUG_LOCATION_MSG_TS(msg)    SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::debug, msg)
-#define QT_LOG_INFO_LOCATION_MSG_TS(msg)     SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::info, msg)
-#define QT_LOG_WARN_LOCATION_MSG_TS(msg)     SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::warn, msg)
-#define QT_LOG_ERROR_LOCATION_MSG_TS(msg)    SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::err, msg)
-#define QT_LOG_CRITICAL_LOCATION_MSG_TS(msg) SPDLOG_LOGGER_CALL(qt_spdlog::get_thread_local_logger(), spdlog::level::critical, msg)
+#define QT_LOG_TRACE_LOCATION_MSG_TS(msg)    QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::trace, msg)
+#define QT_LOG_DEBUG_LOCATION_MSG_TS(msg)    QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::debug, msg)
+#define QT_LOG_INFO_LOCATION_MSG_TS(msg)     QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::info, msg)
+#define QT_LOG_WARN_LOCATION_MSG_TS(msg)     QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::warn, msg)
+#define QT_LOG_ERROR_LOCATION_MSG_TS(msg)    QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::err, msg)
+#define QT_LOG_CRITICAL_LOCATION_MSG_TS(msg) QT_LOG_LOCATION_INTERNAL(qt_spdlog::get_thread_local_logger(), spdlog::level::critical, msg)
 
 
 // ============================================================================
@@ -1176,13 +5389,26 @@ do { \
 #ifdef QT_LOG_CRITICAL_JSON
 #undef QT_LOG_CRITICAL_JSON
 #endif
+#ifdef QT_LOG_JSON_INTERNAL
+#undef QT_LOG_JSON_INTERNAL
+#endif
+
+// Сообщение и поля вычисляются, только если уровень включен. Поля - QVariantMap
+// или фабрика полей; запятые внутри QVariantMap{{...}, {...}} допускаются
+#define QT_LOG_JSON_INTERNAL(level_enum, message, ...) \
+do { \
+    if (qt_spdlog::json::should_log(spdlog::level::level_enum)) { \
+        qt_spdlog::latency::details::call_timer _timer; \
+        qt_spdlog::json::json_log(spdlog::level::level_enum, message, __VA_ARGS__); \
+    } \
+} while(0)
 
-#define QT_LOG_TRACE_JSON(message, fields)    qt_spdlog::json::json_log(spdlog::level::trace, message, fields)
-#define QT_LOG_DEBUG_JSON(message, fields)    qt_spdlog::json::json_log(spdlog::level::debug, message, fields)
-#define QT_LOG_INFO_JSON(message, fields)     qt_spdlog::json::json_log(spdlog::level::info, message, fields)
-#define QT_LOG_WARN_JSON(message, fields)     qt_spdlog::json::json_log(spdlog::level::warn, message, fields)
-#define QT_LOG_ERROR_JSON(message, fields)    qt_spdlog::json::json_log(spdlog::level::err, message, fields)
-#define QT_LOG_CRITICAL_JSON(message, fields) qt_spdlog::json::json_log(spdlog::level::critical, message, fields)
+#define QT_LOG_TRACE_JSON(message, ...)    QT_LOG_JSON_INTERNAL(trace, message, __VA_ARGS__)
+#define QT_LOG_DEBUG_JSON(message, ...)    QT_LOG_JSON_INTERNAL(debug, message, __VA_ARGS__)
+#define QT_LOG_INFO_JSON(message, ...)     QT_LOG_JSON_INTERNAL(info, message, __VA_ARGS__)
+#define QT_LOG_WARN_JSON(message, ...)     QT_LOG_JSON_INTERNAL(warn, message, __VA_ARGS__)
+#define QT_LOG_ERROR_JSON(message, ...)    QT_LOG_JSON_INTERNAL(err, message, __VA_ARGS__)
+#define QT_LOG_CRITICAL_JSON(message, ...) QT_LOG_JSON_INTERNAL(critical, message, __VA_ARGS__)
 
 // Упрощенные версии без полей
 #ifdef QT_LOG_TRACE_JSON_MSG
@@ -1204,12 +5430,12 @@ do { \
 #undef QT_LOG_CRITICAL_JSON_MSG
 #endif
 
-#define QT_LOG_TRACE_JSON_MSG(message)    qt_spdlog::json::json_log(spdlog::level::trace, message)
-#define QT_LOG_DEBUG_JSON_MSG(message)    qt_spdlog::json::json_log(spdlog::level::debug, message)
-#define QT_LOG_INFO_JSON_MSG(message)     qt_spdlog::json::json_log(spdlog::level::info, message)
-#define QT_LOG_WARN_JSON_MSG(message)     qt_spdlog::json::json_log(spdlog::level::warn, message)
-#define QT_LOG_ERROR_JSON_MSG(message)    qt_spdlog::json::json_log(spdlog::level::err, message)
-#define QT_LOG_CRITICAL_JSON_MSG(message) qt_spdlog::json::json_log(spdlog::level::critical, message)
+#define QT_LOG_TRACE_JSON_MSG(message)    QT_LOG_JSON_INTERNAL(trace, message, QVariantMap())
+#define QT_LOG_DEBUG_JSON_MSG(message)    QT_LOG_JSON_INTERNAL(debug, message, QVariantMap())
+#define QT_LOG_INFO_JSON_MSG(message)     QT_LOG_JSON_INTERNAL(info, message, QVariantMap())
+#define QT_LOG_WARN_JSON_MSG(message)     QT_LOG_JSON_INTERNAL(warn, message, QVariantMap())
+#define QT_LOG_ERROR_JSON_MSG(message)    QT_LOG_JSON_INTERNAL(err, message, QVariantMap())
+#define QT_LOG_CRITICAL_JSON_MSG(message) QT_LOG_JSON_INTERNAL(critical, message, QVariantMap())
 
 // Условное JSON логирование
 #ifdef QT_LOG_IF_TRACE_JSON
@@ -1231,23 +5457,94 @@ do { \
 #undef QT_LOG_IF_CRITICAL_JSON
 #endif
 
-#define QT_LOG_IF_TRACE_JSON(condition, message, fields) \
-do { if (condition) QT_LOG_TRACE_JSON(message, fields); } while(0)
+#define QT_LOG_IF_TRACE_JSON(condition, message, ...) \
+do { if (condition) QT_LOG_TRACE_JSON(message, __VA_ARGS__); } while(0)
+
+#define QT_LOG_IF_DEBUG_JSON(condition, message, ...) \
+    do { if (condition) QT_LOG_DEBUG_JSON(message, __VA_ARGS__); } while(0)
+
+#define QT_LOG_IF_INFO_JSON(condition, message, ...) \
+    do { if (condition) QT_LOG_INFO_JSON(message, __VA_ARGS__); } while(0)
 
-#define QT_LOG_IF_DEBUG_JSON(condition, message, fields) \
-    do { if (condition) QT_LOG_DEBUG_JSON(message, fields); } while(0)
+#define QT_LOG_IF_WARN_JSON(condition, message, ...) \
+        do { if (condition) QT_LOG_WARN_JSON(message, __VA_ARGS__); } while(0)
 
-#define QT_LOG_IF_INFO_JSON(condition, message, fields) \
-    do { if (condition) QT_LOG_INFO_JSON(message, fields); } while(0)
+#define QT_LOG_IF_ERROR_JSON(condition, message, ...) \
+    do { if (condition) QT_LOG_ERROR_JSON(message, __VA_ARGS__); } while(0)
+
+#define QT_LOG_IF_CRITICAL_JSON(condition, message, ...) \
+        do { if (condition) QT_LOG_CRITICAL_JSON(message, __VA_ARGS__); } while(0)
+
+// ============================================================================
+// МАКРОСЫ СТРУКТУРИРОВАННОГО ЛОГИРОВАНИЯ
+// ============================================================================
 
-#define QT_LOG_IF_WARN_JSON(condition, message, fields) \
-        do { if (condition) QT_LOG_WARN_JSON(message, fields); } while(0)
+#ifdef QT_LOG_KV_INTERNAL
+#undef QT_LOG_KV_INTERNAL
+#endif
+#ifdef QT_LOG_TRACE_KV
+#undef QT_LOG_TRACE_KV
+#endif
+#ifdef QT_LOG_DEBUG_KV
+#undef QT_LOG_DEBUG_KV
+#endif
+#ifdef QT_LOG_INFO_KV
+#undef QT_LOG_INFO_KV
+#endif
+#ifdef QT_LOG_WARN_KV
+#undef QT_LOG_WARN_KV
+#endif
+#ifdef QT_LOG_ERROR_KV
+#undef QT_LOG_ERROR_KV
+#endif
+#ifdef QT_LOG_CRITICAL_KV
+#undef QT_LOG_CRITICAL_KV
+#endif
+#ifdef QT_LOGGER_TRACE_KV
+#undef QT_LOGGER_TRACE_KV
+#endif
+#ifdef QT_LOGGER_DEBUG_KV
+#undef QT_LOGGER_DEBUG_KV
+#endif
+#ifdef QT_LOGGER_INFO_KV
+#undef QT_LOGGER_INFO_KV
+#endif
+#ifdef QT_LOGGER_WARN_KV
+#undef QT_LOGGER_WARN_KV
+#endif
+#ifdef QT_LOGGER_ERROR_KV
+#undef QT_LOGGER_ERROR_KV
+#endif
+#ifdef QT_LOGGER_CRITICAL_KV
+#undef QT_LOGGER_CRITICAL_KV
+#endif
 
-#define QT_LOG_IF_ERROR_JSON(condition, message, fields) \
-    do { if (condition) QT_LOG_ERROR_JSON(message, fields); } while(0)
+// QT_LOG_INFO_KV("сообщение", kv("key", value), ...): kv доступен в аргументах без
+// квалификации, аргументы вычисляются только на включенном уровне
+#define QT_LOG_KV_INTERNAL(logger_ptr, level_enum, ...) \
+do { \
+    auto* _logger = &*(logger_ptr); \
+    if (_logger->should_log(spdlog::level::level_enum)) { \
+        qt_spdlog::latency::details::call_timer _timer; \
+        using qt_spdlog::kv; \
+        qt_spdlog::structured::log(*_logger, spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, \
+                                   spdlog::level::level_enum, __VA_ARGS__); \
+    } \
+} while(0)
 
-#define QT_LOG_IF_CRITICAL_JSON(condition, message, fields) \
-        do { if (condition) QT_LOG_CRITICAL_JSON(message, fields); } while(0)
+#define QT_LOG_TRACE_KV(...)    QT_LOG_KV_INTERNAL(spdlog::default_logger_raw(), trace, __VA_ARGS__)
+#define QT_LOG_DEBUG_KV(...)    QT_LOG_KV_INTERNAL(spdlog::default_logger_raw(), debug, __VA_ARGS__)
+#define QT_LOG_INFO_KV(...)     QT_LOG_KV_INTERNAL(spdlog::default_logger_raw(), info, __VA_ARGS__)
+#define QT_LOG_WARN_KV(...)     QT_LOG_KV_INTERNAL(spdlog::default_logger_raw(), warn, __VA_ARGS__)
+#define QT_LOG_ERROR_KV(...)    QT_LOG_KV_INTERNAL(spdlog::default_logger_raw(), err, __VA_ARGS__)
+#define QT_LOG_CRITICAL_KV(...) QT_LOG_KV_INTERNAL(spdlog::default_logger_raw(), critical, __VA_ARGS__)
+
+#define QT_LOGGER_TRACE_KV(logger, ...)    QT_LOG_KV_INTERNAL(logger, trace, __VA_ARGS__)
+#define QT_LOGGER_DEBUG_KV(logger, ...)    QT_LOG_KV_INTERNAL(logger, debug, __VA_ARGS__)
+#define QT_LOGGER_INFO_KV(logger, ...)     QT_LOG_KV_INTERNAL(logger, info, __VA_ARGS__)
+#define QT_LOGGER_WARN_KV(logger, ...)     QT_LOG_KV_INTERNAL(logger, warn, __VA_ARGS__)
+#define QT_LOGGER_ERROR_KV(logger, ...)    QT_LOG_KV_INTERNAL(logger, err, __VA_ARGS__)
+#define QT_LOGGER_CRITICAL_KV(logger, ...) QT_LOG_KV_INTERNAL(logger, critical, __VA_ARGS__)
 
 // ============================================================================
 // МАКРОСЫ ДЛЯ ИСКЛЮЧЕНИЙ
@@ -0,0 +1,1201 @@
+#pragma once
+
+#include "qt_spdlog.h"
+#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/sinks/sink.h>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <initializer_list>
+#include <optional>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace qt_spdlog::async {
+
+// ============================================================================
+// МЕТРИКИ
+// ============================================================================
+
+namespace metrics {
+
+// Счетчик, разбитый на шарды по потокам: инкремент не конкурирует
+// за одну кэш-линию, сумма собирается только при чтении
+class sharded_counter {
+public:
+    static constexpr std::size_t shard_count = 16;
+
+    void add(std::uint64_t value = 1) {
+        shards_[shard_index()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    std::uint64_t load() const {
+        std::uint64_t sum = 0;
+        for (const auto& shard : shards_) {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    void reset() {
+        for (auto& shard : shards_) {
+            shard.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(64) shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    static std::size_t shard_index() {
+        static std::atomic<std::size_t> next_index{0};
+        thread_local std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % shard_count;
+        return index;
+    }
+
+    std::array<shard, shard_count> shards_;
+};
+
+// Атомарный максимум
+inline void update_max(std::atomic<std::uint64_t>& target, std::uint64_t value) {
+    std::uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Метрики логгера: счетчики со стороны производителей и обработки в backend
+struct logger_metrics {
+    sharded_counter enqueued;
+    sharded_counter dropped;
+    sharded_counter blocked_ns;
+    std::atomic<std::uint64_t> processed{0};
+
+    void reset() {
+        enqueued.reset();
+        dropped.reset();
+        blocked_ns.reset();
+        processed.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Метрики очереди и потока backend
+struct backend_metrics {
+    std::atomic<std::uint64_t> queue_high_water{0};
+    std::atomic<std::uint64_t> last_batch_size{0};
+    std::atomic<std::uint64_t> max_batch_size{0};
+    std::atomic<std::uint64_t> last_lag_ns{0};
+    std::atomic<std::uint64_t> max_lag_ns{0};
+
+    void reset() {
+        queue_high_water.store(0, std::memory_order_relaxed);
+        last_batch_size.store(0, std::memory_order_relaxed);
+        max_batch_size.store(0, std::memory_order_relaxed);
+        last_lag_ns.store(0, std::memory_order_relaxed);
+        max_lag_ns.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Метрики sink'а
+struct sink_metrics {
+    sharded_counter records;
+    sharded_counter write_ns;
+    sharded_counter errors;
+    std::atomic<std::uint64_t> max_write_ns{0};
+
+    void reset() {
+        records.reset();
+        write_ns.reset();
+        errors.reset();
+        max_write_ns.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Снимки для чтения через API
+struct logger_stats {
+    std::uint64_t enqueued = 0;
+    std::uint64_t dropped = 0;
+    std::uint64_t blocked_ns = 0;
+    std::uint64_t processed = 0;
+};
+
+struct lane_stats {
+    spdlog::level::level_enum min_level = spdlog::level::trace;
+    std::uint64_t depth = 0;
+    std::uint64_t capacity = 0;
+    std::uint64_t high_water = 0;
+    std::uint64_t dropped = 0;
+};
+
+struct backend_stats {
+    std::uint64_t queue_depth = 0;
+    std::uint64_t queue_capacity = 0;
+    std::uint64_t queue_high_water = 0;
+    std::uint64_t last_batch_size = 0;
+    std::uint64_t max_batch_size = 0;
+    std::uint64_t oldest_record_age_ns = 0; // возраст самой старой записи в очереди
+    std::uint64_t last_lag_ns = 0;          // возраст записи в момент извлечения
+    std::uint64_t max_lag_ns = 0;
+    std::vector<lane_stats> lanes;          // от старшей полосы к младшей
+};
+
+struct sink_stats {
+    std::uint64_t records = 0;
+    std::uint64_t write_ns = 0;
+    std::uint64_t max_write_ns = 0;
+    std::uint64_t errors = 0;
+};
+
+} // namespace metrics
+
+// ============================================================================
+// ПОТОКИ И ПАМЯТЬ BACKEND
+// ============================================================================
+
+// Настройки потоков backend. Применяются в Linux, на других платформах игнорируются
+struct thread_options {
+    std::vector<int> cpu_affinity;  // номера CPU; пусто - без привязки
+    std::optional<int> nice;        // nice потока (setpriority)
+    bool idle_priority = false;     // SCHED_IDLE: поток получает только простаивающее время CPU
+    std::string name = "qt_spdlog"; // имя в top -H / ps -L, к нему добавляется номер потока
+};
+
+namespace details {
+
+constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+// Аллокатор для колец очереди: при включенном режиме крупные буферы выравниваются
+// по 2 МБ и помечаются madvise(MADV_HUGEPAGE), меньше промахов TLB при обходе очереди
+template<typename T>
+class huge_page_allocator {
+public:
+    using value_type = T;
+
+    explicit huge_page_allocator(bool enabled = false) noexcept
+        : enabled_(enabled) {}
+
+    template<typename U>
+    huge_page_allocator(const huge_page_allocator<U>& other) noexcept
+        : enabled_(other.enabled()) {}
+
+    T* allocate(std::size_t count) {
+        std::size_t bytes = count * sizeof(T);
+#ifdef __linux__
+        if (use_huge_pages(bytes)) {
+            if (void* memory = std::aligned_alloc(huge_page_size, round_up(bytes))) {
+                ::madvise(memory, round_up(bytes), MADV_HUGEPAGE);
+                return static_cast<T*>(memory);
+            }
+            throw std::bad_alloc();
+        }
+#endif
+        return static_cast<T*>(::operator new(bytes));
+    }
+
+    void deallocate(T* memory, std::size_t count) noexcept {
+#ifdef __linux__
+        if (use_huge_pages(count * sizeof(T))) {
+            std::free(memory);
+            return;
+        }
+#else
+        (void)count;
+#endif
+        ::operator delete(memory);
+    }
+
+    bool enabled() const noexcept { return enabled_; }
+
+    template<typename U>
+    bool operator==(const huge_page_allocator<U>& other) const noexcept { return enabled_ == other.enabled(); }
+    template<typename U>
+    bool operator!=(const huge_page_allocator<U>& other) const noexcept { return !(*this == other); }
+
+private:
+    bool use_huge_pages(std::size_t bytes) const noexcept { return enabled_ && bytes >= huge_page_size; }
+
+    static std::size_t round_up(std::size_t bytes) noexcept {
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    bool enabled_;
+};
+
+inline void report_thread_error(const char* what, int error) {
+    std::cerr << "qt_spdlog: " << what << " failed: " << std::strerror(error) << std::endl;
+}
+
+// Вызывается из самого потока backend до начала обработки очереди
+inline void apply_thread_options(const thread_options& options, std::size_t index, std::size_t thread_count) {
+#ifdef __linux__
+    if (!options.name.empty()) {
+        // Ядро ограничивает имя 15 символами; номер потока не обрезается
+        std::string suffix = thread_count > 1 ? "_" + std::to_string(index) : std::string();
+        std::string name = options.name.substr(0, 15 - std::min<std::size_t>(suffix.size(), 15)) + suffix;
+        if (int rc = pthread_setname_np(pthread_self(), name.c_str())) {
+            report_thread_error("pthread_setname_np", rc);
+        }
+    }
+
+    if (!options.cpu_affinity.empty()) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : options.cpu_affinity) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) {
+            report_thread_error("pthread_setaffinity_np", rc);
+        }
+    }
+
+    if (options.idle_priority) {
+        sched_param param{};
+        if (int rc = pthread_setschedparam(pthread_self(), SCHED_IDLE, &param)) {
+            report_thread_error("SCHED_IDLE", rc);
+        }
+    }
+
+    // В Linux nice действует на отдельный поток, если передать его tid
+    if (options.nice) {
+        auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+        if (::setpriority(PRIO_PROCESS, tid, *options.nice) != 0) {
+            report_thread_error("setpriority", errno);
+        }
+    }
+#else
+    (void)options;
+    (void)index;
+    (void)thread_count;
+#endif
+}
+
+} // namespace details
+
+// ============================================================================
+// ОЧЕРЕДЬ
+// ============================================================================
+
+// Поведение при заполненной очереди
+enum class overflow_policy {
+    block,          // ждать освобождения места
+    overrun_oldest, // вытеснить самую старую запись
+    discard_new     // отбросить новую запись
+};
+
+// Полоса очереди: записи с уровнем не ниже min_level.
+// Backend сначала вычерпывает полосы с более высоким уровнем
+struct lane_options {
+    spdlog::level::level_enum min_level = spdlog::level::trace;
+    std::size_t queue_size = 8192;
+    std::optional<overflow_policy> policy; // не задано - используется политика логгера
+};
+
+namespace details {
+
+enum class push_result {
+    enqueued,
+    overran_oldest,
+    discarded
+};
+
+// Можно ли вытеснить запись при overrun_oldest. Служебные записи (flush)
+// специализация для async_record запрещает вытеснять: их ждут вызывающие
+template<typename T>
+struct eviction_traits {
+    static bool evictable(const T&) { return true; }
+};
+
+// Ограниченная очередь из нескольких кольцевых полос под одной блокировкой.
+// Внутри полосы порядок FIFO, между полосами - строгий приоритет
+template<typename T>
+class lane_queue {
+public:
+    explicit lane_queue(std::vector<lane_options> lanes, bool huge_pages = false) {
+        if (lanes.empty()) {
+            lanes.push_back(lane_options{});
+        }
+        std::stable_sort(lanes.begin(), lanes.end(), [](const lane_options& a, const lane_options& b) {
+            return a.min_level > b.min_level;
+        });
+        lanes_.reserve(lanes.size());
+        for (auto& options : lanes) {
+            lanes_.emplace_back(options, huge_pages);
+        }
+    }
+
+    // Полоса для уровня; QT_LOG_ALWAYS (level::off) попадает в старшую
+    std::size_t lane_for(spdlog::level::level_enum level) const {
+        for (std::size_t i = 0; i < lanes_.size(); ++i) {
+            if (level >= lanes_[i].options.min_level) {
+                return i;
+            }
+        }
+        return lanes_.size() - 1;
+    }
+
+    std::size_t lowest_lane() const { return lanes_.size() - 1; }
+
+    // Политика полосы, если задана, иначе fallback
+    overflow_policy policy_for(std::size_t index, overflow_policy fallback) const {
+        return lanes_[index].options.policy.value_or(fallback);
+    }
+
+    // evicted получает вытесненную запись при overrun_oldest,
+    // blocked_ns - время ожидания места при block
+    push_result push(std::size_t index, T&& item, overflow_policy policy, T* evicted, std::uint64_t& blocked_ns,
+                     std::uint64_t& depth) {
+        push_result result = push_result::enqueued;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            lane& target = lanes_[index];
+            if (target.full()) {
+                if (policy == overflow_policy::discard_new) {
+                    ++target.dropped;
+                    return push_result::discarded;
+                }
+                if (policy == overflow_policy::overrun_oldest && target.evict_oldest(evicted)) {
+                    --total_;
+                    ++target.dropped;
+                    result = push_result::overran_oldest;
+                } else {
+                    // block, либо в полосе остались только невытесняемые записи
+                    auto wait_start = std::chrono::steady_clock::now();
+                    not_full_.wait(lock, [&target] { return !target.full(); });
+                    blocked_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - wait_start).count());
+                }
+            }
+            target.push(std::move(item));
+            depth = ++total_;
+        }
+        not_empty_.notify_one();
+        return result;
+    }
+
+    // Извлекает до max_items записей, начиная со старшей полосы;
+    // ждет не дольше wait_duration, если очередь пуста
+    std::size_t pop_batch(std::vector<T>& out, std::size_t max_items, std::chrono::milliseconds wait_duration) {
+        std::size_t taken = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!not_empty_.wait_for(lock, wait_duration, [this] { return total_ > 0 || stopped_; })) {
+                return 0;
+            }
+            for (auto& source : lanes_) {
+                while (source.count > 0 && taken < max_items) {
+                    out.push_back(source.pop());
+                    ++taken;
+                }
+            }
+            total_ -= taken;
+        }
+        if (taken > 0) {
+            not_full_.notify_all();
+        }
+        return taken;
+    }
+
+    // После остановки pop_batch не ждет, а потоки завершаются на пустой очереди
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        not_empty_.notify_all();
+    }
+
+    bool drained_after_stop() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stopped_ && total_ == 0;
+    }
+
+    // Вызывает func для первой записи каждой непустой полосы
+    template<typename Func>
+    void for_each_front(Func&& func) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& source : lanes_) {
+            if (source.count > 0) {
+                func(source.items[source.head]);
+            }
+        }
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return total_;
+    }
+
+    std::size_t capacity() const {
+        std::size_t result = 0;
+        for (const auto& source : lanes_) {
+            result += source.items.size();
+        }
+        return result;
+    }
+
+    std::vector<metrics::lane_stats> lane_stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<metrics::lane_stats> result;
+        result.reserve(lanes_.size());
+        for (const auto& source : lanes_) {
+            metrics::lane_stats stats;
+            stats.min_level = source.options.min_level;
+            stats.depth = source.count;
+            stats.capacity = source.items.size();
+            stats.high_water = source.high_water;
+            stats.dropped = source.dropped;
+            result.push_back(stats);
+        }
+        return result;
+    }
+
+    void reset_stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& source : lanes_) {
+            source.high_water = source.count;
+            source.dropped = 0;
+        }
+    }
+
+private:
+    struct lane {
+        lane(const lane_options& lane_opts, bool huge_pages)
+            : options(lane_opts)
+            , items(std::max<std::size_t>(lane_opts.queue_size, 1), huge_page_allocator<T>(huge_pages)) {}
+
+        bool full() const { return count == items.size(); }
+
+        void push(T&& item) {
+            items[tail] = std::move(item);
+            tail = next(tail);
+            high_water = std::max<std::uint64_t>(high_water, ++count);
+        }
+
+        T pop() {
+            T item = std::move(items[head]);
+            head = next(head);
+            --count;
+            return item;
+        }
+
+        // Вытесняет самую старую запись, которую разрешено вытеснять;
+        // невытесняемые записи перед ней остаются в начале полосы в прежнем порядке
+        bool evict_oldest(T* evicted) {
+            std::size_t skipped = 0;
+            std::size_t index = head;
+            while (skipped < count && !eviction_traits<T>::evictable(items[index])) {
+                index = next(index);
+                ++skipped;
+            }
+            if (skipped == count) {
+                return false;
+            }
+            T victim = std::move(items[index]);
+            // Сдвигаем пропущенные записи на освободившееся место
+            for (std::size_t i = 0; i < skipped; ++i) {
+                std::size_t previous = index == 0 ? items.size() - 1 : index - 1;
+                items[index] = std::move(items[previous]);
+                index = previous;
+            }
+            head = next(head);
+            --count;
+            if (evicted) {
+                *evicted = std::move(victim);
+            }
+            return true;
+        }
+
+        std::size_t next(std::size_t index) const {
+            return index + 1 == items.size() ? 0 : index + 1;
+        }
+
+        lane_options options;
+        std::vector<T, huge_page_allocator<T>> items;
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        std::size_t count = 0;
+        std::uint64_t high_water = 0;
+        std::uint64_t dropped = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::vector<lane> lanes_;
+    std::size_t total_ = 0;
+    bool stopped_ = false;
+};
+
+} // namespace details
+
+// ============================================================================
+// BACKEND И АСИНХРОННЫЙ ЛОГГЕР
+// ============================================================================
+
+class async_logger;
+
+struct backend_options {
+    std::size_t queue_size = 8192;
+    std::size_t threads = 1;
+    std::size_t batch_size = 64;     // максимум записей, извлекаемых за одну блокировку
+    std::vector<lane_options> lanes; // пусто - одна полоса размером queue_size
+    thread_options worker;           // привязка к CPU, приоритет и имена потоков
+    bool huge_pages = false;         // кольца очереди в transparent huge pages
+    // Периодический flush всех логгеров spdlog из потока с настройками worker.
+    // Замена spdlog::flush_every: его поток настройкам backend не подчиняется
+    std::chrono::milliseconds flush_interval{0};
+
+    // Три полосы: error/critical/always с блокировкой, info/warn и trace/debug
+    // с политикой логгера. Отладочный трафик не вытесняет и не задерживает ошибки
+    static backend_options priority_lanes(std::size_t queue_size = 8192) {
+        backend_options options;
+        options.queue_size = queue_size;
+        options.lanes = {
+            {spdlog::level::err, std::max<std::size_t>(queue_size / 4, 1), overflow_policy::block},
+            {spdlog::level::info, queue_size, std::nullopt},
+            {spdlog::level::trace, queue_size, std::nullopt}
+        };
+        return options;
+    }
+};
+
+namespace details {
+
+enum class record_type {
+    log,
+    flush,
+    qt_message // текст Qt перекодируется в потоке backend
+};
+
+// Копия file/function/category из QMessageLogContext одной строкой через '\0'.
+// Строки QML/JS и динамических QLoggingCategory к обработке могут быть освобождены
+class qt_location {
+public:
+    void assign(const char* file, const char* function, const char* category) {
+        const char* parts[] = {file, function, category};
+        strings_.clear();
+        for (std::size_t i = 0; i < parts_count; ++i) {
+            present_[i] = parts[i] != nullptr;
+            if (parts[i]) {
+                strings_.append(parts[i]);
+            }
+            strings_.push_back('\0');
+        }
+    }
+
+    const char* file() const { return part(0); }
+    const char* function() const { return part(1); }
+    const char* category() const { return part(2); }
+
+private:
+    static constexpr std::size_t parts_count = 3;
+
+    const char* part(std::size_t index) const {
+        if (!present_[index]) {
+            return nullptr;
+        }
+        const char* text = strings_.c_str();
+        for (std::size_t i = 0; i < index; ++i) {
+            text += std::strlen(text) + 1;
+        }
+        return text;
+    }
+
+    std::string strings_;
+    bool present_[parts_count] = {};
+};
+
+struct async_record {
+    async_record() = default;
+    async_record(std::shared_ptr<async_logger>&& owner, record_type the_type, const spdlog::details::log_msg& msg)
+        : logger(std::move(owner)), type(the_type), message(msg) {}
+    async_record(std::shared_ptr<async_logger>&& owner, record_type the_type)
+        : logger(std::move(owner)), type(the_type) {}
+
+    std::shared_ptr<async_logger> logger;
+    record_type type = record_type::log;
+    spdlog::details::log_msg_buffer message;
+    timestamps::stamp stamp;                   // время сообщения Qt: такты TSC переводит backend
+    QString qt_text;                           // разделяемые данные, без копирования текста
+    qt_location qt_source;                     // file/function и префикс [category], если задан
+    structured::captured_fields fields;        // поля QT_LOG_*_KV для форматтеров sink'ов
+    std::optional<QString> module;             // ScopedModule потока логирования
+    mdc::snapshot_ptr context;                 // qt_spdlog::context потока логирования, разделяемый
+    std::shared_ptr<std::promise<void>> done;  // для flush_and_wait
+};
+
+template<>
+struct eviction_traits<async_record> {
+    static bool evictable(const async_record& record) { return record.type != record_type::flush; }
+};
+
+inline spdlog::log_clock::time_point record_time(const async_record& record) {
+    return record.type == record_type::qt_message ? timestamps::to_time(record.stamp) : record.message.time;
+}
+
+inline std::uint64_t age_ns(spdlog::log_clock::time_point time) {
+    // Тот же источник, что и у метки записи
+    auto age = timestamps::now() - time;
+    return age.count() > 0
+        ? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(age).count())
+        : 0;
+}
+
+} // namespace details
+
+// Пул потоков, обрабатывающих очередь асинхронных логгеров
+class backend {
+public:
+    explicit backend(const backend_options& options = {})
+        : options_(options)
+        , queue_(options.lanes.empty()
+              ? std::vector<lane_options>{lane_options{spdlog::level::trace, options.queue_size, std::nullopt}}
+              : options.lanes, options.huge_pages) {
+        std::size_t threads = std::max<std::size_t>(options_.threads, 1);
+        for (std::size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this, i, threads] {
+                details::apply_thread_options(options_.worker, i, threads);
+                // Сообщения Qt из sink'ов в потоке backend не возвращаются в очередь
+                qt_spdlog::details::qt_handler_active() = true;
+                worker_loop();
+            });
+        }
+        if (options_.flush_interval.count() > 0) {
+            flusher_ = std::thread([this] { flush_loop(); });
+        }
+    }
+
+    // Потоки дорабатывают все полосы до конца и завершаются
+    ~backend() {
+        if (flusher_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(flusher_mutex_);
+                flusher_stopping_ = true;
+            }
+            flusher_wake_.notify_all();
+            flusher_.join();
+        }
+        queue_.stop();
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    backend(const backend&) = delete;
+    backend& operator=(const backend&) = delete;
+
+    metrics::backend_stats stats() const {
+        metrics::backend_stats result;
+        result.queue_depth = queue_.size();
+        result.queue_capacity = queue_.capacity();
+        result.queue_high_water = metrics_.queue_high_water.load(std::memory_order_relaxed);
+        result.last_batch_size = metrics_.last_batch_size.load(std::memory_order_relaxed);
+        result.max_batch_size = metrics_.max_batch_size.load(std::memory_order_relaxed);
+        result.last_lag_ns = metrics_.last_lag_ns.load(std::memory_order_relaxed);
+        result.max_lag_ns = metrics_.max_lag_ns.load(std::memory_order_relaxed);
+        queue_.for_each_front([&result](const details::async_record& front) {
+            if (front.type != details::record_type::flush) {
+                result.oldest_record_age_ns = std::max(result.oldest_record_age_ns, details::age_ns(details::record_time(front)));
+            }
+        });
+        result.lanes = queue_.lane_stats();
+        return result;
+    }
+
+    void reset_stats() {
+        metrics_.reset();
+        queue_.reset_stats();
+    }
+
+    const backend_options& options() const { return options_; }
+
+private:
+    friend class async_logger;
+
+    inline void post(details::async_record&& record, overflow_policy policy);
+    inline void worker_loop();
+    inline void process(details::async_record& record);
+
+    void flush_loop() {
+        thread_options flusher_options = options_.worker;
+        if (!flusher_options.name.empty()) {
+            flusher_options.name = flusher_options.name.substr(0, 9) + "_flush";
+        }
+        details::apply_thread_options(flusher_options, 0, 1);
+        qt_spdlog::details::qt_handler_active() = true;
+        std::unique_lock<std::mutex> lock(flusher_mutex_);
+        while (!flusher_wake_.wait_for(lock, options_.flush_interval, [this] { return flusher_stopping_; })) {
+            lock.unlock();
+            // Асинхронные логгеры ставят flush в очередь, остальные сбрасываются прямо здесь
+            spdlog::apply_all([](const std::shared_ptr<spdlog::logger>& logger) { logger->flush(); });
+            lock.lock();
+        }
+    }
+
+    backend_options options_;
+    details::lane_queue<details::async_record> queue_;
+    metrics::backend_metrics metrics_;
+    std::vector<std::thread> threads_;
+    std::mutex flusher_mutex_;
+    std::condition_variable flusher_wake_;
+    bool flusher_stopping_ = false;
+    std::thread flusher_;
+};
+
+// Асинхронный логгер с собственным backend и метриками очереди
+class async_logger final : public spdlog::logger, public std::enable_shared_from_this<async_logger> {
+public:
+    template<typename It>
+    async_logger(std::string name, It begin, It end, std::weak_ptr<backend> backend_ptr,
+                 overflow_policy policy = overflow_policy::block)
+        : spdlog::logger(std::move(name), begin, end)
+        , backend_(std::move(backend_ptr))
+        , policy_(policy) {}
+
+    async_logger(std::string name, spdlog::sinks_init_list sinks, std::weak_ptr<backend> backend_ptr,
+                 overflow_policy policy = overflow_policy::block)
+        : async_logger(std::move(name), sinks.begin(), sinks.end(), std::move(backend_ptr), policy) {}
+
+    async_logger(std::string name, spdlog::sink_ptr single_sink, std::weak_ptr<backend> backend_ptr,
+                 overflow_policy policy = overflow_policy::block)
+        : async_logger(std::move(name), {std::move(single_sink)}, std::move(backend_ptr), policy) {}
+
+    std::shared_ptr<spdlog::logger> clone(std::string new_name) override {
+        auto cloned = std::make_shared<async_logger>(*this);
+        cloned->name_ = std::move(new_name);
+        return cloned;
+    }
+
+    async_logger(const async_logger& other)
+        : spdlog::logger(other)
+        , std::enable_shared_from_this<async_logger>()
+        , backend_(other.backend_)
+        , policy_(other.policy_) {}
+
+    metrics::logger_stats stats() const {
+        metrics::logger_stats result;
+        result.enqueued = metrics_.enqueued.load();
+        result.dropped = metrics_.dropped.load();
+        result.blocked_ns = metrics_.blocked_ns.load();
+        result.processed = metrics_.processed.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void reset_stats() { metrics_.reset(); }
+
+    std::shared_ptr<backend> get_backend() const { return backend_.lock(); }
+
+    // Ставит flush в очередь и ждет, пока backend до него дойдет
+    bool flush_and_wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000)) {
+        auto pool = backend_.lock();
+        if (!pool) {
+            return false;
+        }
+        auto done = std::make_shared<std::promise<void>>();
+        auto finished = done->get_future();
+        details::async_record record(shared_from_this(), details::record_type::flush);
+        record.done = std::move(done);
+        pool->post(std::move(record), overflow_policy::block);
+        if (finished.wait_for(timeout) != std::future_status::ready) {
+            return false;
+        }
+        // Запись, уничтоженная без обработки, оставляет broken_promise
+        try {
+            finished.get();
+            return true;
+        }
+        catch (const std::future_error&) {
+            return false;
+        }
+    }
+
+    // Сообщение Qt: время, поток и контекст фиксируются сразу,
+    // перекодирование и форматирование выполняет backend
+    void post_qt_message(QtMsgType type, const QMessageLogContext& context, const QString& msg,
+                         bool tag_category, overflow_policy policy) {
+        auto level = qt_spdlog::details::qt_message_level(type);
+        if (!should_log(level)) {
+            return;
+        }
+        auto pool = backend_.lock();
+        if (!pool) {
+            throw spdlog::spdlog_ex("async log: backend doesn't exist anymore");
+        }
+        // Время фиксируется сырым показанием часов и переводится в потоке backend.
+        // Строки контекста копируются: в очереди остается только номер строки
+        spdlog::details::log_msg header(spdlog::log_clock::time_point{},
+                                        spdlog::source_loc{nullptr, context.line, nullptr},
+                                        name_, level, spdlog::string_view_t());
+        details::async_record record(shared_from_this(), details::record_type::qt_message, header);
+        record.stamp = timestamps::capture();
+        record.qt_text = msg;
+        record.qt_source.assign(context.file, context.function, tag_category ? context.category : nullptr);
+        record.context = mdc::capture();
+        pool->post(std::move(record), policy);
+    }
+
+    overflow_policy policy() const { return policy_; }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        if (auto pool = backend_.lock()) {
+            details::async_record record(shared_from_this(), details::record_type::log, msg);
+            if (const auto* fields = structured::current()) {
+                record.fields.capture(*fields);
+            }
+            if (get_module_storage().hasLocalData()) {
+                record.module = get_module_storage().localData();
+            }
+            record.context = mdc::capture();
+            pool->post(std::move(record), policy_);
+        } else {
+            throw spdlog::spdlog_ex("async log: backend doesn't exist anymore");
+        }
+    }
+
+    void flush_() override {
+        if (auto pool = backend_.lock()) {
+            pool->post(details::async_record(shared_from_this(), details::record_type::flush), overflow_policy::block);
+        } else {
+            throw spdlog::spdlog_ex("async flush: backend doesn't exist anymore");
+        }
+    }
+
+private:
+    friend class backend;
+
+    void backend_sink_it_(const spdlog::details::log_msg& msg) {
+        for (auto& sink : sinks_) {
+            if (sink->should_log(msg.level)) {
+                try {
+                    sink->log(msg);
+                }
+                catch (const std::exception& e) {
+                    err_handler_(e.what());
+                }
+                catch (...) {
+                    err_handler_("Rethrowing unknown exception in async logger");
+                }
+            }
+        }
+        metrics_.processed.fetch_add(1, std::memory_order_relaxed);
+        if (should_flush_(msg)) {
+            backend_flush_();
+        }
+    }
+
+    void backend_flush_() {
+        for (auto& sink : sinks_) {
+            try {
+                sink->flush();
+            }
+            catch (const std::exception& e) {
+                err_handler_(e.what());
+            }
+        }
+    }
+
+    std::weak_ptr<backend> backend_;
+    overflow_policy policy_;
+    metrics::logger_metrics metrics_;
+};
+
+inline void backend::post(details::async_record&& record, overflow_policy policy) {
+    std::shared_ptr<async_logger> owner = record.logger;
+    details::async_record evicted;
+    std::uint64_t blocked_ns = 0;
+    std::uint64_t depth = 0;
+
+    // flush идет в младшую полосу, чтобы выполниться после уже поставленных записей
+    std::size_t lane = queue_.lowest_lane();
+    if (record.type != details::record_type::flush) {
+        lane = queue_.lane_for(record.message.level);
+        policy = queue_.policy_for(lane, policy);
+    }
+
+    auto result = queue_.push(lane, std::move(record), policy, &evicted, blocked_ns, depth);
+    metrics::update_max(metrics_.queue_high_water, depth);
+
+    if (result == details::push_result::discarded) {
+        owner->metrics_.dropped.add();
+        return;
+    }
+    owner->metrics_.enqueued.add();
+    if (blocked_ns > 0) {
+        owner->metrics_.blocked_ns.add(blocked_ns);
+    }
+    if (result == details::push_result::overran_oldest && evicted.logger) {
+        evicted.logger->metrics_.dropped.add();
+    }
+}
+
+inline void backend::worker_loop() {
+    std::vector<details::async_record> batch;
+    batch.reserve(options_.batch_size);
+    for (;;) {
+        std::size_t taken = queue_.pop_batch(batch, std::max<std::size_t>(options_.batch_size, 1),
+                                             std::chrono::milliseconds(10));
+        if (taken == 0) {
+            if (queue_.drained_after_stop()) {
+                return;
+            }
+            continue;
+        }
+
+        metrics_.last_batch_size.store(taken, std::memory_order_relaxed);
+        metrics::update_max(metrics_.max_batch_size, taken);
+        std::uint64_t lag = 0;
+        for (const auto& record : batch) {
+            if (record.type != details::record_type::flush) {
+                lag = std::max(lag, details::age_ns(details::record_time(record)));
+            }
+        }
+        metrics_.last_lag_ns.store(lag, std::memory_order_relaxed);
+        metrics::update_max(metrics_.max_lag_ns, lag);
+
+        for (auto& record : batch) {
+            process(record);
+        }
+        // Освобождаем ссылки на логгеры до следующего ожидания
+        batch.clear();
+    }
+}
+
+inline void backend::process(details::async_record& record) {
+    switch (record.type) {
+    case details::record_type::log: {
+        // Модуль потока логирования вместо модуля потока backend
+        const QString* previous_module = qt_spdlog::details::record_module_override();
+        qt_spdlog::details::record_module_override() = record.module ? &*record.module : nullptr;
+        mdc::restore_scope context(record.context);
+        if (record.fields.empty()) {
+            record.logger->backend_sink_it_(record.message);
+        } else {
+            // Поля структурированной записи снова доступны форматтерам через structured::current()
+            thread_local std::vector<structured::field_ref> refs;
+            const structured::record fields = record.fields.restore(refs);
+            structured::record_scope scope(&fields);
+            record.logger->backend_sink_it_(record.message);
+        }
+        qt_spdlog::details::record_module_override() = previous_module;
+        break;
+    }
+    case details::record_type::flush:
+        record.logger->backend_flush_();
+        if (record.done) {
+            record.done->set_value();
+        }
+        break;
+    case details::record_type::qt_message: {
+        spdlog::memory_buf_t payload;
+        const char* category = record.qt_source.category();
+        qt_spdlog::details::format_qt_payload(payload, category, record.qt_text, category != nullptr);
+        spdlog::source_loc source{record.qt_source.file(), record.message.source.line, record.qt_source.function()};
+        spdlog::details::log_msg msg(timestamps::to_time(record.stamp), source, record.message.logger_name,
+                                     record.message.level, spdlog::string_view_t(payload.data(), payload.size()));
+        msg.thread_id = record.message.thread_id;
+        mdc::restore_scope context(record.context);
+        record.logger->backend_sink_it_(msg);
+        break;
+    }
+    }
+}
+
+// ============================================================================
+// SINK С МЕТРИКАМИ
+// ============================================================================
+
+// Обертка над sink'ом: считает записи, время записи и ошибки
+class instrumented_sink final : public spdlog::sinks::sink {
+public:
+    explicit instrumented_sink(spdlog::sink_ptr inner)
+        : inner_(std::move(inner)) {
+        set_level(inner_->level());
+    }
+
+    void log(const spdlog::details::log_msg& msg) override {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            inner_->log(msg);
+        }
+        catch (...) {
+            metrics_.errors.add();
+            throw;
+        }
+        auto elapsed = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        metrics_.records.add();
+        metrics_.write_ns.add(elapsed);
+        metrics::update_max(metrics_.max_write_ns, elapsed);
+    }
+
+    void flush() override { inner_->flush(); }
+
+    void set_pattern(const std::string& pattern) override { inner_->set_pattern(pattern); }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override {
+        inner_->set_formatter(std::move(sink_formatter));
+    }
+
+    metrics::sink_stats stats() const {
+        metrics::sink_stats result;
+        result.records = metrics_.records.load();
+        result.write_ns = metrics_.write_ns.load();
+        result.max_write_ns = metrics_.max_write_ns.load(std::memory_order_relaxed);
+        result.errors = metrics_.errors.load();
+        return result;
+    }
+
+    void reset_stats() { metrics_.reset(); }
+
+    const spdlog::sink_ptr& inner() const { return inner_; }
+
+private:
+    spdlog::sink_ptr inner_;
+    metrics::sink_metrics metrics_;
+};
+
+// ============================================================================
+// ИНИЦИАЛИЗАЦИЯ
+// ============================================================================
+
+namespace details {
+
+inline std::shared_ptr<backend>& default_backend_storage() {
+    static std::shared_ptr<backend> instance;
+    return instance;
+}
+
+inline std::mutex& default_backend_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+} // namespace details
+
+// Создает (или пересоздает) backend по умолчанию
+inline std::shared_ptr<backend> init(const backend_options& options = {}) {
+    auto created = std::make_shared<backend>(options);
+    std::lock_guard<std::mutex> lock(details::default_backend_mutex());
+    details::default_backend_storage() = created;
+    return created;
+}
+
+inline std::shared_ptr<backend> default_backend() {
+    {
+        std::lock_guard<std::mutex> lock(details::default_backend_mutex());
+        if (details::default_backend_storage()) {
+            return details::default_backend_storage();
+        }
+    }
+    return init();
+}
+
+// Останавливает backend по умолчанию, дожидаясь обработки очереди
+inline void shutdown() {
+    std::shared_ptr<backend> released;
+    {
+        std::lock_guard<std::mutex> lock(details::default_backend_mutex());
+        released.swap(details::default_backend_storage());
+    }
+}
+
+// Создает асинхронный логгер и регистрирует его в spdlog
+inline std::shared_ptr<async_logger> create_logger(const QString& name, std::vector<spdlog::sink_ptr> sinks,
+                                                   overflow_policy policy = overflow_policy::block,
+                                                   std::shared_ptr<backend> backend_ptr = nullptr) {
+    if (!backend_ptr) {
+        backend_ptr = default_backend();
+    }
+    auto logger = std::make_shared<async_logger>(name.toStdString(), sinks.begin(), sinks.end(), backend_ptr, policy);
+    spdlog::initialize_logger(logger);
+    // initialize_logger знает только точные имена, глобы спецификации уровней - здесь
+    levels::apply_pending(*logger);
+    hierarchy::attach(logger);
+    invalidate_logger_handles();
+    return logger;
+}
+
+inline std::shared_ptr<async_logger> create_logger(const QString& name, spdlog::sink_ptr sink,
+                                                   overflow_policy policy = overflow_policy::block,
+                                                   std::shared_ptr<backend> backend_ptr = nullptr) {
+    return create_logger(name, std::vector<spdlog::sink_ptr>{std::move(sink)}, policy, std::move(backend_ptr));
+}
+
+// ============================================================================
+// НЕБЛОКИРУЮЩИЙ ОБРАБОТЧИК СООБЩЕНИЙ QT
+// ============================================================================
+
+namespace details {
+
+inline std::atomic<overflow_policy>& qt_overflow_policy() {
+    static std::atomic<overflow_policy> policy{overflow_policy::discard_new};
+    return policy;
+}
+
+} // namespace details
+
+// Вариант qt_spdlog::setup_qt_message_handler для асинхронных логгеров: вызывающий
+// поток (в том числе GUI) только ставит запись в очередь и не ждет места в ней.
+// QtFatalMsg дожидается обработки очереди перед abort. Для логгеров, не являющихся
+// async_logger, запись выполняется синхронно
+inline void setup_qt_message_handler(bool preserve_original = true,
+                                     overflow_policy policy = overflow_policy::discard_new) {
+    qt_spdlog::details::save_original_qt_handler(preserve_original);
+    details::qt_overflow_policy().store(policy, std::memory_order_relaxed);
+
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext& context, const QString& msg) {
+        qt_spdlog::details::qt_handler_guard guard;
+        if (guard.reentered()) {
+            qt_spdlog::details::write_reentrant_qt_message(type, context, msg);
+            return;
+        }
+
+        try {
+            bool bridged = categories::is_installed();
+            auto logger = bridged ? categories::logger_for(context.category) : spdlog::default_logger();
+            auto async = std::dynamic_pointer_cast<async_logger>(logger);
+
+            if (!async) {
+                qt_spdlog::details::log_qt_message(*logger, type, context, msg, !bridged);
+                if (type == QtFatalMsg) {
+                    logger->flush();
+                    std::abort();
+                }
+                return;
+            }
+
+            if (type == QtFatalMsg) {
+                async->post_qt_message(type, context, msg, !bridged, overflow_policy::block);
+                async->flush_and_wait();
+                std::abort();
+            }
+            async->post_qt_message(type, context, msg, !bridged,
+                                   details::qt_overflow_policy().load(std::memory_order_relaxed));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Qt logging failed: " << e.what() << std::endl;
+            if (qt_spdlog::details::original_qt_handler()) {
+                qt_spdlog::details::original_qt_handler()(type, context, msg);
+            }
+        }
+    });
+}
+
+} // namespace qt_spdlog::async
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "qt_spdlog.h"
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <tuple>
+
+namespace qt_spdlog {
+
+// ============================================================================
+// QTCONCURRENT С КОНТЕКСТОМ ЛОГИРОВАНИЯ
+// ============================================================================
+
+namespace details {
+
+// Аргументы связываются заранее: QtConcurrent получает лямбду без параметров
+template<typename Function, typename... Args>
+inline auto bind_with_context(Function&& function, Args&&... args) {
+    return [captured = scoped::task_context::capture(),
+            function = std::decay_t<Function>(std::forward<Function>(function)),
+            arguments = std::make_tuple(std::decay_t<Args>(std::forward<Args>(args))...)]() mutable {
+        scoped::TaskContextScope scope(captured);
+        return std::apply(function, std::move(arguments));
+    };
+}
+
+} // namespace details
+
+// QtConcurrent::run, в задаче действуют модуль и контекст (qt_spdlog::context) вызывающего потока
+template<typename Function, typename... Args>
+inline auto run_with_context(Function&& function, Args&&... args) {
+    return QtConcurrent::run(details::bind_with_context(std::forward<Function>(function), std::forward<Args>(args)...));
+}
+
+template<typename Function, typename... Args>
+inline auto run_with_context(QThreadPool* pool, Function&& function, Args&&... args) {
+    return QtConcurrent::run(pool,
+                             details::bind_with_context(std::forward<Function>(function), std::forward<Args>(args)...));
+}
+
+} // namespace qt_spdlog
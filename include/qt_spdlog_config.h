@@ -0,0 +1,770 @@
+#pragma once
+
+#include "qt_spdlog.h"
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QTimer>
+#include <map>
+
+#ifndef _WIN32
+#include <QSocketNotifier>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace qt_spdlog::config {
+
+// ============================================================================
+// КОНФИГУРАЦИЯ ЛОГГЕРОВ ИЗ ФАЙЛА
+// ============================================================================
+
+// Формат JSON:
+//   {
+//     "level": "info",                      // общий уровень (spdlog::set_level)
+//     "pattern": "%^[%T] [%l]%$ %v",        // pattern sink'ов по умолчанию
+//     "sinks": {
+//       "console": {"type": "stdout"},
+//       "file": {"type": "file", "path": "app.log", "level": "debug", "truncate": false}
+//     },
+//     "loggers": {
+//       "network": {"level": "debug", "flush": "error", "pattern": "...", "sinks": ["console", "file"]}
+//     }
+//   }
+//
+// Формат INI - те же ключи: общие в начале файла (или в [general]),
+// секции [sink.ИМЯ] и [logger.ИМЯ], список sink'ов через запятую
+
+struct sink_settings {
+    QString type;    // stdout, stderr, file, rotating, null
+    QString path;    // file, rotating; относительный путь - от каталога файла конфигурации
+    QString pattern; // пусто - pattern логгера или общий
+    std::optional<spdlog::level::level_enum> level;
+    bool truncate = false;
+    std::size_t max_size = 10 * 1024 * 1024; // rotating
+    std::size_t max_files = 3;               // rotating
+
+    // Тот же приемник: при перезагрузке sink переиспользуется, а не открывается заново
+    bool same_target(const sink_settings& other) const {
+        return type == other.type && path == other.path && truncate == other.truncate
+            && max_size == other.max_size && max_files == other.max_files;
+    }
+};
+
+struct logger_settings {
+    QString name;
+    std::optional<spdlog::level::level_enum> level;
+    std::optional<spdlog::level::level_enum> flush_level;
+    QString pattern;
+    QStringList sinks; // пусто - sink'и логгера не меняются
+};
+
+struct settings {
+    std::optional<spdlog::level::level_enum> level;
+    QString pattern;
+    QMap<QString, sink_settings> sinks;
+    std::vector<logger_settings> loggers;
+};
+
+namespace details {
+
+inline bool fail(QString* error, const QString& message) {
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+inline bool read_level(const QJsonValue& value, std::optional<spdlog::level::level_enum>& level,
+                       const QString& where, QString* error) {
+    if (value.isUndefined() || value.isNull()) {
+        return true;
+    }
+    const QString text = value.toString();
+    spdlog::level::level_enum parsed = spdlog::level::info;
+    if (!parse_level(QStringView(text), parsed)) {
+        return fail(error, QString("%1: unknown level '%2'").arg(where, text));
+    }
+    level = parsed;
+    return true;
+}
+
+// INI хранит все значения строками, поэтому числа и флаги принимаются в обоих видах
+inline std::size_t read_size(const QJsonValue& value, std::size_t fallback) {
+    if (value.isDouble()) {
+        return static_cast<std::size_t>(value.toInteger(static_cast<qint64>(fallback)));
+    }
+    bool ok = false;
+    const qulonglong parsed = value.toString().toULongLong(&ok);
+    return ok ? static_cast<std::size_t>(parsed) : fallback;
+}
+
+inline bool read_bool(const QJsonValue& value) {
+    if (value.isBool()) {
+        return value.toBool();
+    }
+    const QString text = value.toString().trimmed().toLower();
+    return text == "true" || text == "yes" || text == "on" || text == "1";
+}
+
+inline QStringList read_list(const QJsonValue& value) {
+    QStringList items;
+    if (value.isArray()) {
+        for (const auto& item : value.toArray()) {
+            items.append(item.toString());
+        }
+    } else {
+        items = value.toString().split(',');
+    }
+    QStringList result;
+    for (const auto& item : items) {
+        if (!item.trimmed().isEmpty()) {
+            result.append(item.trimmed());
+        }
+    }
+    return result;
+}
+
+// Общий разбор для JSON и INI (INI сначала приводится к тому же дереву)
+inline std::optional<settings> from_object(const QJsonObject& root, QString* error) {
+    settings result;
+    if (!read_level(root.value("level"), result.level, "level", error)) {
+        return std::nullopt;
+    }
+    result.pattern = root.value("pattern").toString();
+
+    const QJsonObject sinks = root.value("sinks").toObject();
+    for (auto it = sinks.begin(); it != sinks.end(); ++it) {
+        const QJsonObject object = it.value().toObject();
+        const QString where = QString("sink '%1'").arg(it.key());
+        sink_settings sink;
+        sink.type = object.value("type").toString().trimmed().toLower();
+        sink.path = object.value("path").toString();
+        sink.pattern = object.value("pattern").toString();
+        sink.truncate = read_bool(object.value("truncate"));
+        sink.max_size = read_size(object.value("max_size"), sink.max_size);
+        sink.max_files = read_size(object.value("max_files"), sink.max_files);
+        if (!read_level(object.value("level"), sink.level, where, error)) {
+            return std::nullopt;
+        }
+
+        if (sink.type != "stdout" && sink.type != "stderr" && sink.type != "file"
+            && sink.type != "rotating" && sink.type != "null") {
+            fail(error, QString("%1: unknown type '%2'").arg(where, sink.type));
+            return std::nullopt;
+        }
+        if ((sink.type == "file" || sink.type == "rotating") && sink.path.isEmpty()) {
+            fail(error, QString("%1: path is required").arg(where));
+            return std::nullopt;
+        }
+        result.sinks.insert(it.key(), sink);
+    }
+
+    const QJsonObject loggers = root.value("loggers").toObject();
+    for (auto it = loggers.begin(); it != loggers.end(); ++it) {
+        const QJsonObject object = it.value().toObject();
+        const QString where = QString("logger '%1'").arg(it.key());
+        logger_settings logger;
+        logger.name = it.key();
+        logger.pattern = object.value("pattern").toString();
+        logger.sinks = read_list(object.value("sinks"));
+        if (!read_level(object.value("level"), logger.level, where, error)
+            || !read_level(object.value("flush"), logger.flush_level, where, error)) {
+            return std::nullopt;
+        }
+        for (const auto& sink : logger.sinks) {
+            if (!result.sinks.contains(sink)) {
+                fail(error, QString("%1: unknown sink '%2'").arg(where, sink));
+                return std::nullopt;
+            }
+        }
+        result.loggers.push_back(std::move(logger));
+    }
+
+    return result;
+}
+
+inline QString unquote(QString value) {
+    value = value.trimmed();
+    if (value.size() >= 2 && (value.startsWith('"') || value.startsWith('\'')) && value.endsWith(value[0])) {
+        return value.mid(1, value.size() - 2);
+    }
+    return value;
+}
+
+} // namespace details
+
+inline std::optional<settings> parse_json(const QByteArray& data, QString* error = nullptr) {
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !document.isObject()) {
+        details::fail(error, QString("invalid JSON at offset %1: %2")
+                                 .arg(parseError.offset).arg(parseError.errorString()));
+        return std::nullopt;
+    }
+    return details::from_object(document.object(), error);
+}
+
+// Свой разбор INI вместо QSettings: QSettings делит значения по запятым
+// и разбирает '%'-последовательности, что ломает pattern'ы
+inline std::optional<settings> parse_ini(const QByteArray& data, QString* error = nullptr) {
+    QJsonObject root;
+    std::map<QString, QJsonObject> sinks;
+    std::map<QString, QJsonObject> loggers;
+    QJsonObject* section = &root;
+
+    const QList<QByteArray> lines = data.split('\n');
+    for (int number = 0; number < lines.size(); ++number) {
+        const QString line = QString::fromUtf8(lines[number]).trimmed();
+        if (line.isEmpty() || line.startsWith(';') || line.startsWith('#')) {
+            continue;
+        }
+
+        if (line.startsWith('[') && line.endsWith(']')) {
+            const QString name = line.mid(1, line.size() - 2).trimmed();
+            if (name.compare("general", Qt::CaseInsensitive) == 0) {
+                section = &root;
+            } else if (name.startsWith("sink.") && name.size() > 5) {
+                section = &sinks[name.mid(5)];
+            } else if (name.startsWith("logger.") && name.size() > 7) {
+                section = &loggers[name.mid(7)];
+            } else {
+                details::fail(error, QString("line %1: unknown section [%2]").arg(number + 1).arg(name));
+                return std::nullopt;
+            }
+            continue;
+        }
+
+        const int separator = line.indexOf('=');
+        if (separator <= 0) {
+            details::fail(error, QString("line %1: expected key = value").arg(number + 1));
+            return std::nullopt;
+        }
+        section->insert(line.left(separator).trimmed(), details::unquote(line.mid(separator + 1)));
+    }
+
+    QJsonObject sinksObject;
+    for (const auto& [name, object] : sinks) {
+        sinksObject.insert(name, object);
+    }
+    QJsonObject loggersObject;
+    for (const auto& [name, object] : loggers) {
+        loggersObject.insert(name, object);
+    }
+    root.insert("sinks", sinksObject);
+    root.insert("loggers", loggersObject);
+    return details::from_object(root, error);
+}
+
+// Формат по расширению: .ini/.conf/.cfg - INI, остальное - JSON
+inline std::optional<settings> load_file(const QString& path, QString* error = nullptr) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        details::fail(error, QString("cannot open %1: %2").arg(path, file.errorString()));
+        return std::nullopt;
+    }
+    const QByteArray data = file.readAll();
+
+    const QFileInfo info(path);
+    const QString suffix = info.suffix().toLower();
+    auto result = suffix == "ini" || suffix == "conf" || suffix == "cfg" ? parse_ini(data, error) : parse_json(data, error);
+    if (result) {
+        const QDir base(info.absolutePath());
+        for (auto& sink : result->sinks) {
+            if (!sink.path.isEmpty()) {
+                sink.path = base.absoluteFilePath(sink.path);
+            }
+        }
+    }
+    return result;
+}
+
+// ============================================================================
+// ПЕРЕКЛЮЧАЕМЫЙ НАБОР SINK'ОВ (RCU)
+// ============================================================================
+
+namespace details {
+
+// Hazard-указатели потоков: запись объявляет в своем слоте набор, который читает,
+// писатель освобождает старый набор, только когда его нет ни в одном слоте.
+// Записи потоков не удаляются, после завершения потока запись занимает другой поток
+constexpr std::size_t hazard_slots = 4; // вложенные reloadable_sink (sink, пишущий в логгер)
+
+struct hazard_record {
+    std::array<std::atomic<const void*>, hazard_slots> pointers{};
+    std::atomic<bool> active{true};
+    hazard_record* next = nullptr;
+};
+
+inline std::atomic<hazard_record*>& hazard_head() {
+    static std::atomic<hazard_record*> head{nullptr};
+    return head;
+}
+
+inline hazard_record* acquire_hazard_record() {
+    for (auto* record = hazard_head().load(std::memory_order_acquire); record; record = record->next) {
+        bool active = false;
+        if (!record->active.load(std::memory_order_relaxed)
+            && record->active.compare_exchange_strong(active, true, std::memory_order_acquire)) {
+            return record;
+        }
+    }
+    auto* record = new hazard_record;
+    record->next = hazard_head().load(std::memory_order_relaxed);
+    while (!hazard_head().compare_exchange_weak(record->next, record, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+    }
+    return record;
+}
+
+struct hazard_thread {
+    hazard_record* record = acquire_hazard_record();
+    std::size_t depth = 0;
+
+    ~hazard_thread() { record->active.store(false, std::memory_order_release); }
+};
+
+inline hazard_thread& local_hazards() {
+    thread_local hazard_thread instance;
+    return instance;
+}
+
+inline bool is_hazard(const void* pointer) {
+    for (auto* record = hazard_head().load(std::memory_order_acquire); record; record = record->next) {
+        for (const auto& slot : record->pointers) {
+            if (slot.load(std::memory_order_seq_cst) == pointer) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace details
+
+// Единственный sink логгера, созданного из конфигурации. Набор sink'ов
+// публикуется целиком: запись читает текущий набор под hazard-указателем
+// своего потока и не берет ни мьютекс, ни счетчик ссылок, поэтому не ждет
+// ни разбора, ни применения конфигурации. Старый набор (и sink'и, исчезнувшие
+// из файла) освобождается при публикации, если его не читает ни одна запись,
+// иначе - при одной из следующих публикаций или вместе с sink'ом
+class reloadable_sink final : public spdlog::sinks::sink {
+public:
+    using sink_list = std::vector<spdlog::sink_ptr>;
+
+    reloadable_sink()
+        : owner_(std::make_shared<const sink_list>())
+        , current_(owner_.get()) {}
+
+    void log(const spdlog::details::log_msg& msg) override {
+        read([&msg](const sink_list& current) {
+            for (const auto& sink : current) {
+                if (sink->should_log(msg.level)) {
+                    sink->log(msg);
+                }
+            }
+        });
+    }
+
+    void flush() override {
+        read([](const sink_list& current) {
+            for (const auto& sink : current) {
+                sink->flush();
+            }
+        });
+    }
+
+    // set_pattern/set_formatter логгера доходят до sink'ов текущего набора
+    void set_pattern(const std::string& pattern) override {
+        set_formatter(make_pattern_formatter(QString::fromStdString(pattern)));
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override {
+        const auto current = sinks();
+        for (const auto& sink : *current) {
+            sink->set_formatter(formatter->clone());
+        }
+    }
+
+    void publish(sink_list sinks) {
+        auto next = std::make_shared<const sink_list>(std::move(sinks));
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired_.push_back(std::move(owner_));
+        owner_ = std::move(next);
+        current_.store(owner_.get(), std::memory_order_seq_cst);
+        retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                      [](const auto& list) { return !details::is_hazard(list.get()); }),
+                       retired_.end());
+    }
+
+    // Текущий набор с владением (берет мьютекс публикации, не для записи в лог)
+    std::shared_ptr<const sink_list> sinks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return owner_;
+    }
+
+private:
+    template<typename Fn>
+    void read(Fn&& fn) {
+        auto& hazards = details::local_hazards();
+        if (hazards.depth >= details::hazard_slots) {
+            fn(*sinks());
+            return;
+        }
+
+        auto& slot = hazards.record->pointers[hazards.depth];
+        const sink_list* list = current_.load(std::memory_order_acquire);
+        for (;;) {
+            slot.store(list, std::memory_order_seq_cst);
+            const sink_list* again = current_.load(std::memory_order_seq_cst);
+            if (again == list) {
+                break;
+            }
+            list = again;
+        }
+
+        struct release {
+            details::hazard_thread& hazards;
+            std::atomic<const void*>& slot;
+            ~release() {
+                slot.store(nullptr, std::memory_order_release);
+                --hazards.depth;
+            }
+        };
+        ++hazards.depth;
+        release guard{hazards, slot};
+        fn(*list);
+    }
+
+    mutable std::mutex mutex_; // сериализует publish, запись в лог его не берет
+    std::shared_ptr<const sink_list> owner_;
+    std::vector<std::shared_ptr<const sink_list>> retired_;
+    std::atomic<const sink_list*> current_;
+};
+
+// ============================================================================
+// ПРИМЕНЕНИЕ КОНФИГУРАЦИИ
+// ============================================================================
+
+namespace details {
+
+struct sink_entry {
+    sink_settings settings;
+    QString pattern; // примененный pattern
+    spdlog::sink_ptr sink;
+};
+
+struct state {
+    std::mutex mutex; // сериализует apply, запись в лог его не берет
+    QMap<QString, sink_entry> sinks;
+    std::unordered_map<std::string, std::shared_ptr<reloadable_sink>> loggers;
+};
+
+inline state& get_state() {
+    static state instance;
+    return instance;
+}
+
+inline spdlog::sink_ptr make_sink(const sink_settings& settings) {
+    const std::string path = QFile::encodeName(settings.path).toStdString();
+    if (settings.type == "stdout") {
+        return std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    }
+    if (settings.type == "stderr") {
+        return std::make_shared<spdlog::sinks::stderr_color_sink_mt>();
+    }
+    if (settings.type == "file") {
+        return std::make_shared<spdlog::sinks::basic_file_sink_mt>(path, settings.truncate);
+    }
+    if (settings.type == "rotating") {
+        return std::make_shared<spdlog::sinks::rotating_file_sink_mt>(path, settings.max_size, settings.max_files);
+    }
+    return std::make_shared<spdlog::sinks::null_sink_mt>();
+}
+
+} // namespace details
+
+// Применяет конфигурацию целиком или не применяет вовсе: sink'и создаются
+// и pattern'ы разбираются до того, как что-либо становится видно логгерам.
+// Sink'и с прежним приемником переиспользуются (файл не открывается заново).
+// Логгер, отсутствующий в реестре, создается с reloadable_sink; у логгера,
+// созданного кодом, меняются только уровни и pattern. Логгеры, исчезнувшие
+// из файла, сохраняют последние настройки
+inline bool apply(const settings& config, QString* error = nullptr) {
+    auto& state = details::get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    // Pattern sink'а: свой, иначе первого ссылающегося логгера, иначе общий
+    QMap<QString, QString> patterns;
+    for (auto it = config.sinks.begin(); it != config.sinks.end(); ++it) {
+        patterns.insert(it.key(), it.value().pattern);
+    }
+    for (const auto& logger : config.loggers) {
+        for (const auto& sink : logger.sinks) {
+            if (patterns[sink].isEmpty()) {
+                patterns[sink] = logger.pattern;
+            }
+        }
+    }
+
+    // Подготовка: все, что может бросить исключение
+    QMap<QString, details::sink_entry> sinks;
+    std::vector<std::pair<spdlog::sink_ptr, std::unique_ptr<spdlog::formatter>>> formatters;
+    try {
+        for (auto it = config.sinks.begin(); it != config.sinks.end(); ++it) {
+            details::sink_entry entry;
+            entry.settings = it.value();
+            entry.pattern = patterns.value(it.key());
+            if (entry.pattern.isEmpty()) {
+                entry.pattern = config.pattern;
+            }
+
+            const auto previous = state.sinks.constFind(it.key());
+            const bool reused = previous != state.sinks.constEnd() && previous->settings.same_target(entry.settings);
+            entry.sink = reused ? previous->sink : details::make_sink(entry.settings);
+            if (!entry.pattern.isEmpty() && (!reused || previous->pattern != entry.pattern)) {
+                QString message;
+                const auto compiled = CompiledPattern::compile(entry.pattern, &message);
+                if (!compiled) {
+                    return details::fail(error, QString("sink '%1': %2").arg(it.key(), message));
+                }
+                formatters.emplace_back(entry.sink, compiled->make_formatter());
+            }
+            sinks.insert(it.key(), std::move(entry));
+        }
+    }
+    catch (const std::exception& e) {
+        return details::fail(error, QString::fromStdString(e.what()));
+    }
+
+    // Публикация: дальше исключений нет
+    for (auto& [sink, formatter] : formatters) {
+        sink->set_formatter(std::move(formatter));
+    }
+    for (const auto& entry : sinks) {
+        entry.sink->set_level(entry.settings.level.value_or(spdlog::level::trace));
+    }
+    state.sinks = std::move(sinks);
+
+    if (config.level) {
+        spdlog::set_level(*config.level);
+    }
+
+    for (const auto& settings : config.loggers) {
+        const std::string name = settings.name.toStdString();
+        auto logger = spdlog::get(name);
+        auto managed = state.loggers.find(name);
+        // Логгер удален из реестра (spdlog::drop): создается заново
+        if (managed != state.loggers.end() && !logger) {
+            state.loggers.erase(managed);
+            managed = state.loggers.end();
+        }
+
+        if (!settings.sinks.isEmpty()) {
+            reloadable_sink::sink_list list;
+            for (const auto& sink : settings.sinks) {
+                list.push_back(state.sinks.value(sink).sink);
+            }
+
+            if (managed != state.loggers.end()) {
+                managed->second->publish(std::move(list));
+            } else if (!logger) {
+                auto sink = std::make_shared<reloadable_sink>();
+                logger = std::make_shared<spdlog::logger>(name, sink);
+                // initialize_logger ставит общий formatter, поэтому набор публикуется после
+                spdlog::initialize_logger(logger);
+                levels::apply_pending(*logger);
+                hierarchy::attach(logger);
+                invalidate_logger_handles();
+                sink->publish(std::move(list));
+                state.loggers.emplace(name, std::move(sink));
+            } else {
+                std::cerr << "qt_spdlog config: logger '" << name
+                          << "' was not created from config, its sinks are left unchanged" << std::endl;
+            }
+        }
+
+        if (!logger) {
+            continue;
+        }
+        if (settings.level) {
+            logger->set_level(*settings.level);
+        }
+        if (settings.flush_level) {
+            logger->flush_on(*settings.flush_level);
+        }
+        // У логгера из конфигурации с перечисленными sink'ами pattern уже применен к ним
+        const bool patternApplied = !settings.sinks.isEmpty() && state.loggers.count(name) > 0;
+        if (!settings.pattern.isEmpty() && !patternApplied) {
+            logger->set_formatter(make_pattern_formatter(settings.pattern));
+        }
+    }
+
+    categories::refresh();
+    return true;
+}
+
+// Загрузка и применение файла при старте, без наблюдения
+inline bool load(const QString& path, QString* error = nullptr) {
+    auto config = load_file(path, error);
+    return config && apply(*config, error);
+}
+
+// ============================================================================
+// НАБЛЮДЕНИЕ ЗА ФАЙЛОМ И SIGHUP
+// ============================================================================
+
+namespace details {
+#ifndef _WIN32
+// Обработчик сигнала только пишет байт в socketpair, перезагрузка идет в потоке наблюдателя
+inline int sighup_fds[2] = {-1, -1};
+
+inline void on_sighup(int) {
+    const char byte = 1;
+    const auto written = ::write(sighup_fds[0], &byte, 1);
+    (void)written;
+}
+#endif
+} // namespace details
+
+// Применяет файл в конструкторе и при каждом его изменении. Редакторы
+// часто заменяют файл переименованием, поэтому наблюдается и каталог.
+// Серия изменений схлопывается таймером; файл с ошибкой не применяется,
+// логгеры остаются с предыдущей конфигурацией. Нужен цикл событий
+class ConfigWatcher : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString path READ path CONSTANT)
+    Q_PROPERTY(QString lastError READ lastError NOTIFY reloadFailed)
+    Q_PROPERTY(quint64 generation READ generation NOTIFY reloaded)
+
+public:
+    explicit ConfigWatcher(const QString& path, QObject* parent = nullptr)
+        : QObject(parent)
+        , m_path(QFileInfo(path).absoluteFilePath())
+    {
+        m_debounce.setSingleShot(true);
+        m_debounce.setInterval(100);
+        connect(&m_debounce, &QTimer::timeout, this, &ConfigWatcher::reload);
+        connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() { schedule(); });
+        // Каталог нужен только для замены файла, сам файл в этот момент выпадает из наблюдения
+        connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+            if (!m_watcher.files().contains(m_path)) {
+                schedule();
+            }
+        });
+
+        m_watcher.addPath(QFileInfo(m_path).absolutePath());
+        watchFile();
+        reload();
+    }
+
+    ~ConfigWatcher() override
+    {
+#ifndef _WIN32
+        // Обработчик, стоявший до enableSighupReload()
+        if (m_sighup) {
+            ::sigaction(SIGHUP, &m_previousSighup, nullptr);
+        }
+#endif
+    }
+
+    QString path() const { return m_path; }
+    QString lastError() const { return m_lastError; }
+    quint64 generation() const { return m_generation; }
+
+    // Перезагрузка по SIGHUP (POSIX). Сигнал обслуживает один наблюдатель на процесс
+    bool enableSighupReload()
+    {
+#ifndef _WIN32
+        if (m_sighup) {
+            return true;
+        }
+        if (details::sighup_fds[0] < 0) {
+            if (::socketpair(AF_UNIX, SOCK_STREAM, 0, details::sighup_fds) != 0) {
+                return false;
+            }
+            for (int fd : details::sighup_fds) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            }
+        }
+
+        struct sigaction action{};
+        action.sa_handler = details::on_sighup;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (::sigaction(SIGHUP, &action, &m_previousSighup) != 0) {
+            return false;
+        }
+
+        m_sighup = new QSocketNotifier(details::sighup_fds[1], QSocketNotifier::Read, this);
+        connect(m_sighup, &QSocketNotifier::activated, this, [this]() {
+            char buffer[64];
+            while (::read(details::sighup_fds[1], buffer, sizeof(buffer)) > 0) {
+            }
+            reload();
+        });
+        return true;
+#else
+        return false;
+#endif
+    }
+
+public slots:
+    bool reload()
+    {
+        watchFile();
+
+        QString error;
+        auto config = load_file(m_path, &error);
+        if (config && apply(*config, &error)) {
+            m_lastError.clear();
+            ++m_generation;
+            emit reloaded();
+            return true;
+        }
+
+        m_lastError = error;
+        std::cerr << "qt_spdlog config: " << error.toStdString() << ", keeping previous configuration" << std::endl;
+        emit reloadFailed(error);
+        return false;
+    }
+
+signals:
+    void reloaded();
+    void reloadFailed(const QString& error);
+
+private:
+    void schedule()
+    {
+        watchFile();
+        m_debounce.start();
+    }
+
+    // После замены переименованием файл выпадает из наблюдения
+    void watchFile()
+    {
+        if (!m_watcher.files().contains(m_path) && QFileInfo(m_path).exists()) {
+            m_watcher.addPath(m_path);
+        }
+    }
+
+    QString m_path;
+    QString m_lastError;
+    quint64 m_generation = 0;
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+#ifndef _WIN32
+    QSocketNotifier* m_sighup = nullptr;
+    struct sigaction m_previousSighup{};
+#endif
+};
+
+} // namespace qt_spdlog::config
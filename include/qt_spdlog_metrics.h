@@ -0,0 +1,91 @@
+#pragma once
+
+#include "qt_spdlog_async.h"
+#include <QObject>
+#include <QTimer>
+
+namespace qt_spdlog {
+
+// ============================================================================
+// МЕТРИКИ АСИНХРОННОГО ЛОГИРОВАНИЯ ДЛЯ QT
+// ============================================================================
+
+// Публикует метрики backend и логгеров в виде Q_PROPERTY.
+// Значения обновляются по таймеру (или вручную через refresh()),
+// счетчики логгеров суммируются по всем наблюдаемым логгерам
+class AsyncMetrics : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(quint64 queueDepth READ queueDepth NOTIFY updated)
+    Q_PROPERTY(quint64 queueCapacity READ queueCapacity NOTIFY updated)
+    Q_PROPERTY(quint64 queueHighWater READ queueHighWater NOTIFY updated)
+    Q_PROPERTY(quint64 oldestRecordAgeNs READ oldestRecordAgeNs NOTIFY updated)
+    Q_PROPERTY(quint64 maxLagNs READ maxLagNs NOTIFY updated)
+    Q_PROPERTY(quint64 lastBatchSize READ lastBatchSize NOTIFY updated)
+    Q_PROPERTY(quint64 maxBatchSize READ maxBatchSize NOTIFY updated)
+    Q_PROPERTY(quint64 enqueued READ enqueued NOTIFY updated)
+    Q_PROPERTY(quint64 dropped READ dropped NOTIFY updated)
+    Q_PROPERTY(quint64 blockedNs READ blockedNs NOTIFY updated)
+    Q_PROPERTY(quint64 processed READ processed NOTIFY updated)
+    Q_PROPERTY(int interval READ interval WRITE setInterval)
+
+public:
+    explicit AsyncMetrics(std::shared_ptr<async::backend> backend, QObject* parent = nullptr)
+        : QObject(parent)
+        , m_backend(std::move(backend))
+    {
+        m_timer.setInterval(1000);
+        connect(&m_timer, &QTimer::timeout, this, &AsyncMetrics::refresh);
+    }
+
+    void addLogger(const std::shared_ptr<async::async_logger>& logger) { m_loggers.push_back(logger); }
+
+    quint64 queueDepth() const { return m_backendStats.queue_depth; }
+    quint64 queueCapacity() const { return m_backendStats.queue_capacity; }
+    quint64 queueHighWater() const { return m_backendStats.queue_high_water; }
+    quint64 oldestRecordAgeNs() const { return m_backendStats.oldest_record_age_ns; }
+    quint64 maxLagNs() const { return m_backendStats.max_lag_ns; }
+    quint64 lastBatchSize() const { return m_backendStats.last_batch_size; }
+    quint64 maxBatchSize() const { return m_backendStats.max_batch_size; }
+    quint64 enqueued() const { return m_loggerStats.enqueued; }
+    quint64 dropped() const { return m_loggerStats.dropped; }
+    quint64 blockedNs() const { return m_loggerStats.blocked_ns; }
+    quint64 processed() const { return m_loggerStats.processed; }
+
+    int interval() const { return m_timer.interval(); }
+    void setInterval(int msec) { m_timer.setInterval(msec); }
+
+public slots:
+    void start() { m_timer.start(); }
+    void stop() { m_timer.stop(); }
+
+    void refresh()
+    {
+        if (m_backend) {
+            m_backendStats = m_backend->stats();
+        }
+        m_loggerStats = {};
+        for (const auto& weak : m_loggers) {
+            if (auto logger = weak.lock()) {
+                auto stats = logger->stats();
+                m_loggerStats.enqueued += stats.enqueued;
+                m_loggerStats.dropped += stats.dropped;
+                m_loggerStats.blocked_ns += stats.blocked_ns;
+                m_loggerStats.processed += stats.processed;
+            }
+        }
+        emit updated();
+    }
+
+signals:
+    void updated();
+
+private:
+    std::shared_ptr<async::backend> m_backend;
+    std::vector<std::weak_ptr<async::async_logger>> m_loggers;
+    async::metrics::backend_stats m_backendStats;
+    async::metrics::logger_stats m_loggerStats;
+    QTimer m_timer;
+};
+
+} // namespace qt_spdlog
@@ -0,0 +1,365 @@
+#pragma once
+
+#include "qt_spdlog.h"
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/null_mutex.h>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+
+namespace qt_spdlog::sinks {
+
+// ============================================================================
+// СОКЕТНЫЙ SINK С ПАКЕТНОЙ ОТПРАВКОЙ
+// ============================================================================
+
+enum class socket_transport {
+    unix_stream,   // AF_UNIX, SOCK_STREAM
+    unix_datagram, // AF_UNIX, SOCK_DGRAM: пачка уходит одной датаграммой
+    tcp            // TCP, обычно localhost
+};
+
+struct socket_sink_options {
+    socket_transport transport = socket_transport::unix_stream;
+    std::string address;                         // путь сокета или хост для TCP
+    std::uint16_t port = 0;                      // порт для TCP
+    std::size_t batch_bytes = 64 * 1024;         // отправка при достижении размера пачки
+    std::size_t batch_records = 256;             // ... или числа записей в ней
+    std::size_t spill_bytes = 4 * 1024 * 1024;   // буфер на время разрыва, старые пачки вытесняются
+    std::chrono::milliseconds min_backoff{100};  // первая пауза перед переподключением
+    std::chrono::milliseconds max_backoff{5000}; // пауза удваивается до этого предела
+    std::chrono::milliseconds send_timeout{1000};
+};
+
+struct socket_sink_stats {
+    std::uint64_t records_sent = 0;
+    std::uint64_t bytes_sent = 0;
+    std::uint64_t batches_sent = 0;
+    std::uint64_t records_spilled = 0; // сейчас ждут в буфере
+    std::uint64_t records_dropped = 0; // вытеснены из переполненного буфера или не влезли в датаграмму
+    std::uint64_t connects = 0;
+    bool connected = false;
+};
+
+// Записи форматируются в общую пачку и уходят одним send/датаграммой.
+// Пока соединения нет, пачки копятся в ограниченном буфере и отправляются
+// первыми после переподключения. Пачка по времени не отправляется:
+// для этого используется flush_on/flush_every логгера
+template<typename Mutex>
+class socket_sink final : public spdlog::sinks::base_sink<Mutex> {
+public:
+    explicit socket_sink(socket_sink_options options)
+        : options_(std::move(options))
+        , backoff_(options_.min_backoff) {}
+
+    ~socket_sink() override {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        send_batch_();
+        close_();
+    }
+
+    socket_sink(const socket_sink&) = delete;
+    socket_sink& operator=(const socket_sink&) = delete;
+
+    socket_sink_stats stats() {
+        std::lock_guard<Mutex> lock(this->mutex_);
+        socket_sink_stats result = stats_;
+        result.records_spilled = 0;
+        for (const auto& pending : spill_) {
+            result.records_spilled += pending.records();
+        }
+        result.connected = fd_ >= 0;
+        return result;
+    }
+
+    const socket_sink_options& options() const { return options_; }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        spdlog::memory_buf_t formatted;
+        this->formatter_->format(msg, formatted);
+
+        // Датаграмма не должна превышать batch_bytes
+        if (options_.transport == socket_transport::unix_datagram && !batch_ends_.empty()
+            && batch_.size() + formatted.size() > options_.batch_bytes) {
+            send_batch_();
+        }
+
+        batch_.append(formatted.data(), formatted.size());
+        batch_ends_.push_back(batch_.size());
+        if (batch_.size() >= options_.batch_bytes || batch_ends_.size() >= options_.batch_records) {
+            send_batch_();
+        }
+    }
+
+    void flush_() override {
+        send_batch_();
+    }
+
+private:
+    // Пачка и границы записей в ней: ends[i] - конец i-й записи в data
+    struct pending_batch {
+        std::string data;
+        std::vector<std::size_t> ends;
+
+        std::size_t records() const { return ends.size(); }
+
+        // Убирает первые count записей
+        void drop_front(std::size_t count) {
+            std::size_t bytes = count > 0 ? ends[count - 1] : 0;
+            data.erase(0, bytes);
+            ends.erase(ends.begin(), ends.begin() + static_cast<std::ptrdiff_t>(count));
+            for (auto& end : ends) {
+                end -= bytes;
+            }
+        }
+    };
+
+    void send_batch_() {
+        pending_batch pending;
+        if (!batch_ends_.empty()) {
+            pending.data.swap(batch_);
+            pending.ends.swap(batch_ends_);
+            batch_.reserve(pending.data.capacity());
+            batch_ends_.reserve(pending.ends.capacity());
+        }
+
+        if (!spill_.empty() || pending.records() > 0) {
+            if (ensure_connected_()) {
+                while (!spill_.empty()) {
+                    std::size_t before = spill_.front().data.size();
+                    bool written = write_batch_(spill_.front());
+                    // Отправленные записи уходят из буфера и при неудаче
+                    spill_bytes_ -= before - spill_.front().data.size();
+                    if (!written) {
+                        break;
+                    }
+                    spill_.pop_front();
+                }
+                if (spill_.empty() && pending.records() > 0 && write_batch_(pending)) {
+                    return;
+                }
+            }
+        }
+
+        if (pending.records() > 0) {
+            spill_batch_(std::move(pending));
+        }
+    }
+
+    // Помещает пачку в буфер, вытесняя самые старые при переполнении
+    void spill_batch_(pending_batch&& pending) {
+        while (!spill_.empty() && spill_bytes_ + pending.data.size() > options_.spill_bytes) {
+            spill_bytes_ -= spill_.front().data.size();
+            stats_.records_dropped += spill_.front().records();
+            spill_.pop_front();
+        }
+        if (pending.data.size() > options_.spill_bytes) {
+            stats_.records_dropped += pending.records();
+            return;
+        }
+        spill_bytes_ += pending.data.size();
+        spill_.push_back(std::move(pending));
+    }
+
+    // true - пачка отправлена и опустела, false - соединение потеряно, в пачке
+    // остаются неотправленные записи
+    bool write_batch_(pending_batch& pending) {
+        if (options_.transport == socket_transport::unix_datagram) {
+            return write_datagrams_(pending);
+        }
+
+        std::size_t offset = 0;
+        while (offset < pending.data.size()) {
+            ssize_t sent = ::send(fd_, pending.data.data() + offset, pending.data.size() - offset, send_flags());
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            offset += static_cast<std::size_t>(sent);
+        }
+
+        stats_.bytes_sent += offset;
+        if (offset < pending.data.size()) {
+            // Оборванная запись после переподключения уходит заново целиком:
+            // новое соединение начинается с границы записи
+            auto complete = static_cast<std::size_t>(
+                std::upper_bound(pending.ends.begin(), pending.ends.end(), offset) - pending.ends.begin());
+            stats_.records_sent += complete;
+            pending.drop_front(complete);
+            disconnect_();
+            return false;
+        }
+        stats_.records_sent += pending.records();
+        ++stats_.batches_sent;
+        pending.drop_front(pending.records());
+        return true;
+    }
+
+    // Пачка, превышающая предел датаграммы сокета (EMSGSIZE), делится пополам
+    // по границам записей; запись, которая не влезает одна, отбрасывается
+    bool write_datagrams_(pending_batch& pending) {
+        std::size_t chunk = pending.records();
+        while (pending.records() > 0) {
+            std::size_t count = std::min(chunk, pending.records());
+            std::size_t bytes = pending.ends[count - 1];
+            ssize_t sent = ::send(fd_, pending.data.data(), bytes, send_flags());
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EMSGSIZE) {
+                    if (count > 1) {
+                        chunk = count / 2;
+                    } else {
+                        ++stats_.records_dropped;
+                        pending.drop_front(1);
+                    }
+                    continue;
+                }
+                disconnect_();
+                return false;
+            }
+            stats_.bytes_sent += bytes;
+            stats_.records_sent += count;
+            ++stats_.batches_sent;
+            pending.drop_front(count);
+        }
+        return true;
+    }
+
+    bool ensure_connected_() {
+        if (fd_ >= 0) {
+            return true;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now < next_attempt_) {
+            return false;
+        }
+
+        fd_ = connect_();
+        if (fd_ < 0) {
+            next_attempt_ = now + backoff_;
+            backoff_ = std::min(backoff_ * 2, options_.max_backoff);
+            return false;
+        }
+        backoff_ = options_.min_backoff;
+        ++stats_.connects;
+        return true;
+    }
+
+    int connect_() const {
+        if (options_.transport == socket_transport::tcp) {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            addrinfo* addresses = nullptr;
+            std::string port = std::to_string(options_.port);
+            if (::getaddrinfo(options_.address.empty() ? "localhost" : options_.address.c_str(),
+                              port.c_str(), &hints, &addresses) != 0) {
+                return -1;
+            }
+            int fd = -1;
+            for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+                fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+                if (fd >= 0 && ::connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+                    ::close(fd);
+                    fd = -1;
+                }
+            }
+            ::freeaddrinfo(addresses);
+            if (fd >= 0) {
+                int enable = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+                configure_(fd);
+            }
+            return fd;
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (options_.address.empty() || options_.address.size() >= sizeof(address.sun_path)) {
+            return -1;
+        }
+        std::memcpy(address.sun_path, options_.address.c_str(), options_.address.size() + 1);
+
+        int type = options_.transport == socket_transport::unix_datagram ? SOCK_DGRAM : SOCK_STREAM;
+        int fd = ::socket(AF_UNIX, type, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        configure_(fd);
+        return fd;
+    }
+
+    void configure_(int fd) const {
+        timeval timeout{};
+        timeout.tv_sec = static_cast<decltype(timeout.tv_sec)>(options_.send_timeout.count() / 1000);
+        timeout.tv_usec = static_cast<decltype(timeout.tv_usec)>((options_.send_timeout.count() % 1000) * 1000);
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+        int enable = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+    }
+
+    static int send_flags() {
+#ifdef MSG_NOSIGNAL
+        return MSG_NOSIGNAL;
+#else
+        return 0;
+#endif
+    }
+
+    void disconnect_() {
+        close_();
+        next_attempt_ = std::chrono::steady_clock::now() + backoff_;
+        backoff_ = std::min(backoff_ * 2, options_.max_backoff);
+    }
+
+    void close_() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    socket_sink_options options_;
+    int fd_ = -1;
+    std::string batch_;
+    std::vector<std::size_t> batch_ends_;
+    std::deque<pending_batch> spill_;
+    std::size_t spill_bytes_ = 0;
+    std::chrono::milliseconds backoff_;
+    std::chrono::steady_clock::time_point next_attempt_{};
+    socket_sink_stats stats_;
+};
+
+using socket_sink_mt = socket_sink<std::mutex>;
+using socket_sink_st = socket_sink<spdlog::details::null_mutex>;
+
+} // namespace qt_spdlog::sinks
+
+#endif // _WIN32
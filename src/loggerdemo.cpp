@@ -1,11 +1,79 @@
 #include "loggerdemo.h"
 #include "qt_spdlog.h"
+#include "qt_spdlog_async.h"
+#include "qt_spdlog_concurrent.h"
+#include "qt_spdlog_config.h"
+#include "qt_spdlog_socket.h"
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/details/null_mutex.h>
+#include <QDir>
+#include <QProcess>
 #include <QRandomGenerator>
 #include <QDateTime>
 #include <QThread>
 #include <QTimer>
 #include <QFuture>
 #include <QtConcurrent/QtConcurrent>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <atomic>
+
+namespace {
+// Sink для бенчмарков форматтеров: форматирует запись и считает байты
+class FormatCountingSink : public spdlog::sinks::base_sink<spdlog::details::null_mutex>
+{
+public:
+    bool formatEnabled = true;
+    quint64 bytes = 0;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        if (!formatEnabled) {
+            return;
+        }
+        spdlog::memory_buf_t buffer;
+        formatter_->format(msg, buffer);
+        bytes += buffer.size();
+    }
+    void flush_() override {}
+};
+
+// Демонстрации производительности запускают QtSpdlogBench с фильтром и
+// выводят его отчет: замеры живут в одном месте и сравнимы с базовой линией
+void runBenchmarks(const QString& filter, const QStringList& arguments = {})
+{
+#ifndef QT_SPDLOG_BENCH_PATH
+    (void)arguments;
+    QT_LOG_WARN("Бенчмарки не собраны, нужна сборка с -DQT_SPDLOG_BUILD_BENCHMARKS=ON (фильтр {})", filter);
+#else
+    QProcess bench;
+    bench.setProcessChannelMode(QProcess::MergedChannels);
+    bench.start(QT_SPDLOG_BENCH_PATH, QStringList{"--benchmark_filter=" + filter} + arguments);
+    if (!bench.waitForStarted()) {
+        QT_LOG_ERROR("Не удалось запустить бенчмарки: {}", QT_SPDLOG_BENCH_PATH);
+        return;
+    }
+    QT_LOG_ALWAYS("{} --benchmark_filter={} {}", QT_SPDLOG_BENCH_PATH, filter, arguments.join(' '));
+
+    while (bench.waitForReadyRead(-1)) {
+        while (bench.canReadLine()) {
+            QT_LOG_INFO("{}", QString::fromUtf8(bench.readLine()).trimmed());
+        }
+    }
+    bench.waitForFinished(-1);
+    const QString rest = QString::fromUtf8(bench.readAll()).trimmed();
+    if (!rest.isEmpty()) {
+        QT_LOG_INFO("{}", rest);
+    }
+    if (bench.exitStatus() != QProcess::NormalExit || bench.exitCode() != 0) {
+        QT_LOG_ERROR("Бенчмарки завершились с ошибкой, код {}", bench.exitCode());
+    }
+#endif
+}
+} // namespace
 
 LoggerDemo::LoggerDemo(QObject *parent)
     : QObject(parent)
@@ -47,7 +115,11 @@ void LoggerDemo::initializeTestList()
         "15. Временные модули (Scoped Module)",
         "16. Производительность thread-local",
         "17. Производительность thread-pool",
-        "18. Реальные сценарии (бизнес-логика)"
+        "18. Реальные сценарии (бизнес-логика)",
+        "19. Асинхронный backend: привязка к CPU",
+        "20. Сокетный sink: размер пачки",
+        "21. CBOR и JSON: размер и скорость кодирования",
+        "22. Перезагрузка конфигурации на лету"
     };
 
     m_demonstrations = {
@@ -68,7 +140,11 @@ void LoggerDemo::initializeTestList()
         [this]() { demonstrateScopedModule(); },
         [this]() { demonstrateThreadLocalPerformance(); },
         [this]() { demonstrateThreadPoolPerformance(); },
-        [this]() { demonstrateRealWorldScenarios(); }
+        [this]() { demonstrateRealWorldScenarios(); },
+        [this]() { demonstrateAsyncBackendAffinity(); },
+        [this]() { demonstrateSocketSinkThroughput(); },
+        [this]() { demonstrateCborVsJsonEncoding(); },
+        [this]() { demonstrateConfigReload(); }
     };
 }
 
@@ -80,6 +156,11 @@ QString LoggerDemo::getDemoName(int index)
     return "Неизвестный тест";
 }
 
+int LoggerDemo::testCount() const
+{
+    return m_testNames.size();
+}
+
 // ============================================================================
 // ОСНОВНЫЕ СЛОТЫ
 // ============================================================================
@@ -814,6 +895,54 @@ void LoggerDemo::demonstrateCustomLoggers()
     QT_LOGGER_TRACE(businessLogger, "Business trace - снова не должен отображаться");
     QT_LOGGER_DEBUG(businessLogger, "Business debug - все еще работает");
 
+    // 5. Дескрипторы логгеров вместо spdlog::get в горячих путях
+    QT_LOG_ALWAYS("5. Дескрипторы логгеров вместо spdlog::get:");
+    QT_LOGGER_INFO(QT_SPDLOG_LOGGER("network"), "Логгер получен через дескриптор на месте вызова");
+
+    // 32 потока разрешают имена логгеров в цикле: мьютекс реестра против кэша потока
+    const int THREADS = 32;
+    const int LOOKUPS = 200000;
+    const char* names[] = {"network", "database", "business"};
+    const qt_spdlog::logger_handle handles[] = {
+        qt_spdlog::logger_handle("network"),
+        qt_spdlog::logger_handle("database"),
+        qt_spdlog::logger_handle("business")
+    };
+    QThreadPool pool;
+    pool.setMaxThreadCount(THREADS);
+
+    auto measure = [&](auto lookup) {
+        std::atomic<qint64> found{0};
+        QElapsedTimer timer;
+        timer.start();
+        QList<QFuture<void>> futures;
+        for (int t = 0; t < THREADS; ++t) {
+            futures.append(QtConcurrent::run(&pool, [&found, &lookup, LOOKUPS]() {
+                qint64 local = 0;
+                for (int i = 0; i < LOOKUPS; ++i) {
+                    local += lookup(i % 3) != nullptr;
+                }
+                found.fetch_add(local);
+            }));
+        }
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+        return std::make_pair(static_cast<double>(timer.nsecsElapsed()) / LOOKUPS, found.load());
+    };
+
+    auto registryResult = measure([&names](int index) { return spdlog::get(names[index]).get(); });
+    auto handleResult = measure([&handles](int index) { return handles[index].get(); });
+
+    QT_LOG_INFO("{} потоков x {} поисков: spdlog::get {:.1f} нс/поиск, logger_handle {:.1f} нс/поиск "
+                "(найдено {} и {})",
+                THREADS,
+                LOOKUPS,
+                registryResult.first,
+                handleResult.first,
+                registryResult.second,
+                handleResult.second);
+
     QT_LOG_ALWAYS("Все кастомные логгеры работают корректно!");
 
     QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ КАСТОМНЫХ ЛОГГЕРОВ ЗАВЕРШЕНА ===\n");
@@ -948,6 +1077,126 @@ void LoggerDemo::demonstrateJsonLogging()
     };
     QT_LOG_INFO_JSON("Продакшен событие", hybridFields);
 
+    // 9. Стоимость строки: QJsonDocument против потоковой записи в буфер
+    QT_LOG_ALWAYS("9. Производительность JSON: QJsonDocument и json_formatter (вывод без записи на диск):");
+
+    const int JSON_ITERATIONS = 100000;
+    auto previousLogger = spdlog::default_logger();
+    auto benchLogger = std::make_shared<spdlog::logger>("json_bench", std::make_shared<spdlog::sinks::null_sink_mt>());
+    benchLogger->set_level(spdlog::level::info);
+    spdlog::set_default_logger(benchLogger);
+
+    // Прежняя реализация json_log: QJsonObject → QJsonDocument → QString → std::string
+    auto legacyJsonLog = [](spdlog::level::level_enum level, const QString& message, const QVariantMap& fields) {
+        QJsonObject jsonObj;
+        jsonObj["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+        jsonObj["level"] = QString::fromStdString(spdlog::level::to_string_view(level).data());
+        jsonObj["message"] = message;
+        if (!fields.isEmpty()) {
+            jsonObj["fields"] = QJsonObject::fromVariantMap(fields);
+        }
+        QString jsonStr = QJsonDocument(jsonObj).toJson(QJsonDocument::Compact);
+        spdlog::default_logger()->log(level, jsonStr.toStdString());
+    };
+
+    const QString benchMessage = "Перевод средств выполнен";
+    QElapsedTimer jsonTimer;
+    jsonTimer.start();
+    for (int i = 0; i < JSON_ITERATIONS; ++i) {
+        legacyJsonLog(spdlog::level::info, benchMessage, paymentFields);
+    }
+    qint64 legacyNs = jsonTimer.nsecsElapsed();
+
+    // Поля идут в json_formatter sink'а, строка JSON строится один раз при форматировании
+    auto formattingSink = std::make_shared<FormatCountingSink>();
+    formattingSink->set_formatter(std::make_unique<qt_spdlog::json_formatter>());
+    spdlog::set_default_logger(std::make_shared<spdlog::logger>("json_bench_formatter", formattingSink));
+
+    jsonTimer.restart();
+    for (int i = 0; i < JSON_ITERATIONS; ++i) {
+        qt_spdlog::json::json_log(spdlog::level::info, benchMessage, paymentFields);
+    }
+    qint64 streamingNs = jsonTimer.nsecsElapsed();
+
+    spdlog::set_default_logger(previousLogger);
+
+    QT_LOG_INFO("QJsonDocument:     {} нс/строка", legacyNs / JSON_ITERATIONS);
+    QT_LOG_INFO("json_formatter:    {} нс/строка", streamingNs / JSON_ITERATIONS);
+    QT_LOG_INFO("Выделения памяти на вызов - счетчик allocs_per_op в QtSpdlogBench (BM_LogJson)");
+
+    // 10. Стоимость JSON записи на выключенном уровне
+    QT_LOG_ALWAYS("10. JSON на выключенном уровне DEBUG:");
+
+    const int DISABLED_ITERATIONS = 1000000;
+    spdlog::set_default_logger(benchLogger); // уровень info, DEBUG выключен
+
+    jsonTimer.restart();
+    for (int i = 0; i < DISABLED_ITERATIONS; ++i) {
+        // Прежнее поведение: поля и запись строились до проверки уровня
+        legacyJsonLog(spdlog::level::debug, QString("Обработан элемент %1").arg(i),
+                      QVariantMap{{"item", i}, {"operation", "data_processing"}, {"status", "completed"}});
+    }
+    qint64 ungatedNs = jsonTimer.nsecsElapsed();
+
+    jsonTimer.restart();
+    for (int i = 0; i < DISABLED_ITERATIONS; ++i) {
+        QT_LOG_DEBUG_JSON(QString("Обработан элемент %1").arg(i),
+                          QVariantMap{{"item", i}, {"operation", "data_processing"}, {"status", "completed"}});
+    }
+    qint64 gatedMacroNs = jsonTimer.nsecsElapsed();
+
+    jsonTimer.restart();
+    for (int i = 0; i < DISABLED_ITERATIONS; ++i) {
+        qt_spdlog::json::json_debug("Обработан элемент", [i]() {
+            return QVariantMap{{"item", i}, {"operation", "data_processing"}, {"status", "completed"}};
+        });
+    }
+    qint64 lazyFunctionNs = jsonTimer.nsecsElapsed();
+
+    spdlog::set_default_logger(previousLogger);
+
+    QT_LOG_INFO("Без проверки уровня:      {:.1f} нс/вызов",
+                static_cast<double>(ungatedNs) / DISABLED_ITERATIONS);
+    QT_LOG_INFO("QT_LOG_DEBUG_JSON:        {:.1f} нс/вызов",
+                static_cast<double>(gatedMacroNs) / DISABLED_ITERATIONS);
+    QT_LOG_INFO("json_debug с фабрикой:    {:.1f} нс/вызов",
+                static_cast<double>(lazyFunctionNs) / DISABLED_ITERATIONS);
+
+    // 11. Структурированные поля ключ-значение без QVariantMap
+    QT_LOG_ALWAYS("11. Структурированное логирование QT_LOG_INFO_KV:");
+
+    QString kvUser = "ivan.petrov";
+    QT_LOG_INFO_KV("Пользователь успешно аутентифицирован", kv("user_id", 1542), kv("username", kvUser),
+                   kv("ip_address", "192.168.1.100"), kv("mfa", true));
+
+    const int KV_ITERATIONS = 200000;
+    spdlog::set_default_logger(benchLogger);
+
+    jsonTimer.restart();
+    for (int i = 0; i < KV_ITERATIONS; ++i) {
+        QT_LOG_INFO("Перевод средств выполнен {} {} {}", i, 2500.5, "RUB");
+    }
+    qint64 plainNs = jsonTimer.nsecsElapsed();
+
+    jsonTimer.restart();
+    for (int i = 0; i < KV_ITERATIONS; ++i) {
+        QT_LOG_INFO_KV("Перевод средств выполнен", kv("item", i), kv("amount", 2500.5), kv("currency", "RUB"));
+    }
+    qint64 kvNs = jsonTimer.nsecsElapsed();
+
+    jsonTimer.restart();
+    for (int i = 0; i < KV_ITERATIONS; ++i) {
+        QT_LOG_INFO_JSON("Перевод средств выполнен", QVariantMap{{"item", i}, {"amount", 2500.5}, {"currency", "RUB"}});
+    }
+    qint64 variantNs = jsonTimer.nsecsElapsed();
+
+    spdlog::set_default_logger(previousLogger);
+
+    QT_LOG_INFO("QT_LOG_INFO:              {} нс/строка", plainNs / KV_ITERATIONS);
+    QT_LOG_INFO("QT_LOG_INFO_KV:           {} нс/строка", kvNs / KV_ITERATIONS);
+    QT_LOG_INFO("QT_LOG_INFO_JSON + QVariantMap: {} нс/строка", variantNs / KV_ITERATIONS);
+    QT_LOG_INFO("Выделения памяти на вызов - счетчик allocs_per_op в QtSpdlogBench (BM_LogKv, BM_LogJson)");
+
     QT_LOG_ALWAYS("=== JSON ЛОГИРОВАНИЕ ЗАВЕРШЕНО ===");
 }
 
@@ -1142,8 +1391,37 @@ void LoggerDemo::demonstrateQtIntegration()
     qWarning() << "Qt warning вместе с spdlog";
     QT_LOG_WARN("Spdlog warning сообщение");
 
-    // 9. Восстановление оригинальных настроек
-    QT_LOG_ALWAYS("9. Восстановление оригинальных настроек:");
+    // 9. Производительность: qDebug через handler против QT_LOG_DEBUG
+    QT_LOG_ALWAYS("9. Производительность qDebug и QT_LOG_DEBUG (вывод в null sink):");
+
+    const int QT_ITERATIONS = 200000;
+    auto previousLogger = spdlog::default_logger();
+    auto benchLogger = std::make_shared<spdlog::logger>("qt_bench", std::make_shared<spdlog::sinks::null_sink_mt>());
+    benchLogger->set_level(spdlog::level::debug);
+    spdlog::set_default_logger(benchLogger);
+
+    QElapsedTimer qtTimer;
+    qtTimer.start();
+    for (int i = 0; i < QT_ITERATIONS; ++i) {
+        qDebug("Сообщение Qt #%d со значением %s", i, "значение");
+    }
+    qint64 qDebugNs = qtTimer.nsecsElapsed();
+
+    qtTimer.restart();
+    for (int i = 0; i < QT_ITERATIONS; ++i) {
+        QT_LOG_DEBUG("Сообщение Qt #{} со значением {}", i, "значение");
+    }
+    qint64 qtLogNs = qtTimer.nsecsElapsed();
+
+    spdlog::set_default_logger(previousLogger);
+
+    QT_LOG_INFO("qDebug:       {} сообщений за {} мс ({} нс/сообщение)",
+                QT_ITERATIONS, qDebugNs / 1000000, qDebugNs / QT_ITERATIONS);
+    QT_LOG_INFO("QT_LOG_DEBUG: {} сообщений за {} мс ({} нс/сообщение)",
+                QT_ITERATIONS, qtLogNs / 1000000, qtLogNs / QT_ITERATIONS);
+
+    // 10. Восстановление оригинальных настроек
+    QT_LOG_ALWAYS("10. Восстановление оригинальных настроек:");
 
     qt_spdlog::set_pattern(originalPattern);
     qt_spdlog::set_level(originalLevel);
@@ -1158,70 +1436,10 @@ void LoggerDemo::demonstrateLoggingPerformance()
 {
     QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ ПРОИЗВОДИТЕЛЬНОСТИ ЛОГИРОВАНИЯ ===");
 
-    // 1. Бенчмарк обычного логирования
-    QT_LOG_ALWAYS("1. Сравнение обычных строк и QString:");
-
-    const int ITERATIONS = 1000000;
-    QT_LOG_ALWAYS("Количество итераций: {}", ITERATIONS);
-
-    QElapsedTimer timer;
-
-    // Бенчмарк обычных C-строк
-    timer.start();
-    for (int i = 0; i < ITERATIONS; ++i) {
-        QT_LOG_DEBUG("Обычная строка #{}", i);
-    }
-    qint64 cstringTime = timer.elapsed();
-
-    // Бенчмарк QString
-    timer.restart();
-    for (int i = 0; i < ITERATIONS; ++i) {
-        QString message = QString("QString сообщение #%1").arg(i);
-        QT_LOG_DEBUG("{}", message);
-    }
-    qint64 qstringTime = timer.elapsed();
-
-    // Сравнение результатов
-    QT_LOG_INFO("Время {} обычных строк: {} мс ({:.2f} мкс/сообщение)",
-                ITERATIONS, cstringTime, (static_cast<double>(cstringTime) / ITERATIONS) * 1000);
-    QT_LOG_INFO("Время {} QString: {} мс ({:.2f} мкс/сообщение)",
-                ITERATIONS, qstringTime, (static_cast<double>(qstringTime) / ITERATIONS) * 1000);
-
-    // Разница в производительности
-    double difference = (static_cast<double>(qstringTime) / cstringTime) * 100;
-    QT_LOG_INFO("QString медленнее на: {:.1f}%", difference - 100);
-
-
-    // 2. Бенчмарк should_log для разных уровней
-    QT_LOG_ALWAYS("2. Бенчмарк should_log с дорогой операцией:");
-
-    const int COMPLEX_ITERATIONS = 100000;
-    QT_LOG_ALWAYS("Количество итераций: {}", COMPLEX_ITERATIONS);
-
-    // Без проверки should_log
-    timer.start();
-    for (int i = 0; i < COMPLEX_ITERATIONS; ++i) {
-        auto complexData = generateComplexData(); // Дорогая операция
-        QT_LOG_DEBUG("Сложные данные: {}", complexData);
-    }
-    qint64 noCheckTime = timer.elapsed();
-
-    // С проверкой should_log
-    timer.restart();
-    for (int i = 0; i < COMPLEX_ITERATIONS; ++i) {
-        if (spdlog::default_logger()->should_log(spdlog::level::debug)) {
-            auto complexData = generateComplexData(); // Дорогая операция
-            QT_LOG_DEBUG("Сложные данные: {}", complexData);
-        }
-    }
-    qint64 withCheckTime = timer.elapsed();
-
-    // Сравнение
-    QT_LOG_INFO("Без should_log: {} мс (генерируются все данные)", noCheckTime);
-    QT_LOG_INFO("С should_log: {} мс (данные генерируются только при необходимости)", withCheckTime);
-
-    double savings = (static_cast<double>(noCheckTime - withCheckTime) / noCheckTime) * 100;
-    QT_LOG_INFO("Экономия времени: {:.1f}%", savings);
+    // Литерал против QString, отфильтрованная и условная запись с процентилями
+    // задержки, затем форматирование паттернов и чтение часов
+    runBenchmarks("BM_(LogLiteral|LogQString|LogFiltered|LogIf)/.*threads:1$|BM_(Pattern|Timestamp)/",
+                  {"--latency"});
 
     QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ ПРОИЗВОДИТЕЛЬНОСТИ ЗАВЕРШЕНА ===\n");
 }
@@ -1451,8 +1669,101 @@ void LoggerDemo::demonstrateScopedLevel()
     }
     QT_LOG_INFO("Сложная операция завершена");
 
-    // 7. Восстановление оригинального уровня
-    QT_LOG_ALWAYS("7. Восстановление оригинального уровня:");
+    // 7. Уровни по строке спецификации (как QT_SPDLOG_LEVEL и --log-level)
+    QT_LOG_ALWAYS("7. Уровни по строке спецификации:");
+
+    // Текущая спецификация (из окружения или командной строки) восстанавливается в конце
+    std::string previousSpec;
+    for (const auto& rule : qt_spdlog::levels::current()->rules()) {
+        previousSpec += rule.pattern + "=" + std::string(qt_spdlog::level_name(rule.level)) + ",";
+    }
+
+    qt_spdlog::set_level_spec("scoped_test=trace,demo.net.*=debug");
+    QT_LOGGER_TRACE(customLogger, "scoped_test получил trace из спецификации");
+    auto netLogger = qt_spdlog::categories::get_logger("demo.net.http");
+    QT_LOGGER_DEBUG(netLogger, "Логгер, созданный после установки спецификации, получил debug");
+
+    // Новый логгер не перебирает правила: сравнение с линейным проходом по глобам
+    const int RULES = 1000;
+    const int LOOKUPS = 100000;
+    std::string bigSpec;
+    for (int i = 0; i < RULES; ++i) {
+        bigSpec += "module" + std::to_string(i) + ".*=debug,";
+    }
+    bigSpec += "*=info";
+    auto compiled = qt_spdlog::levels::spec::parse(bigSpec);
+    std::vector<std::string> names;
+    for (int i = 0; i < 1000; ++i) {
+        names.push_back("module" + std::to_string(i * 7 % (2 * RULES)) + ".worker");
+    }
+
+    int matched = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        matched += compiled->level_for(names[i % names.size()]) == spdlog::level::debug;
+    }
+    qint64 compiledNs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        const auto& name = names[i % names.size()];
+        for (const auto& rule : compiled->rules()) {
+            if (qt_spdlog::levels::details::glob_match(rule.pattern, name)) {
+                matched += rule.level == spdlog::level::debug;
+                break;
+            }
+        }
+    }
+    qint64 scanNs = timer.nsecsElapsed();
+
+    QT_LOG_INFO("Правил: {}, уровень для нового логгера: {:.1f} нс (линейный проход: {:.1f} нс), совпадений: {}",
+                RULES + 1,
+                static_cast<double>(compiledNs) / LOOKUPS,
+                static_cast<double>(scanNs) / LOOKUPS,
+                matched);
+
+    qt_spdlog::set_level_spec(previousSpec);
+
+    // 8. Иерархия логгеров: уровень префикса действует на все поддерево
+    QT_LOG_ALWAYS("8. Иерархия логгеров:");
+    {
+        auto sink = std::make_shared<spdlog::sinks::null_sink_mt>();
+        std::vector<std::shared_ptr<spdlog::logger>> tree;
+        for (int i = 0; i < 10000; ++i) {
+            tree.push_back(std::make_shared<spdlog::logger>(
+                fmt::format("demo_tree.svc{}.mod{}.l{}", i / 1000, i / 100 % 10, i % 100), sink));
+            qt_spdlog::hierarchy::attach(tree.back());
+        }
+
+        QElapsedTimer relevelTimer;
+        relevelTimer.start();
+        qt_spdlog::hierarchy::set_level("demo_tree.svc3", spdlog::level::debug);
+        qint64 relevelNs = relevelTimer.nsecsElapsed();
+
+        {
+            qt_spdlog::scoped::ScopedLoggerLevel svcScope("demo_tree.svc4", spdlog::level::trace);
+            QT_LOGGER_TRACE(tree[4321], "ScopedLoggerLevel по префиксу: trace у {}", tree[4321]->name());
+        }
+
+        const int CALLS = 1000000;
+        int enabled = 0;
+        relevelTimer.restart();
+        for (int i = 0; i < CALLS; ++i) {
+            enabled += tree[5000]->should_log(spdlog::level::debug);
+        }
+        qint64 shouldLogNs = relevelTimer.nsecsElapsed();
+
+        QT_LOG_INFO("Логгеров: {}, уровень поддерева из 1000 логгеров: {} мкс, should_log: {:.2f} нс ({} включено)",
+                    tree.size(),
+                    relevelNs / 1000,
+                    static_cast<double>(shouldLogNs) / CALLS,
+                    enabled);
+        qt_spdlog::hierarchy::clear_level("demo_tree.svc3");
+    }
+
+    // 9. Восстановление оригинального уровня
+    QT_LOG_ALWAYS("9. Восстановление оригинального уровня:");
     qt_spdlog::set_level(originalLevel);
     QT_LOG_INFO("Финальный уровень: {}", qt_spdlog::get_level());
 
@@ -1717,6 +2028,33 @@ void LoggerDemo::demonstrateScopedModule()
         QT_LOG_ERROR("❌ Ошибка восстановления модуля!");
     }
 
+    // 8. Контекст потока: ключи-значения попадают в каждую запись области
+    QT_LOG_ALWAYS("8. Контекст потока (qt_spdlog::context):");
+
+    qt_spdlog::set_pattern(qt_spdlog::patterns::CONTEXT);
+    {
+        using qt_spdlog::kv;
+        const QString requestId = "req-7f3a";
+        auto requestContext = qt_spdlog::context(kv("request_id", requestId), kv("user_id", 42));
+        QT_LOG_INFO("Запрос принят");
+        {
+            auto stepContext = qt_spdlog::context(kv("step", "payment"));
+            QT_LOG_INFO("Списание средств");
+        }
+        QT_LOG_INFO("Ответ отправлен");
+    }
+    QT_LOG_INFO("Вне контекста");
+
+    // Вход и выход из области: без выделений памяти, QString копируется по ссылке
+    const int CONTEXT_ITERATIONS = 1000000;
+    QElapsedTimer contextTimer;
+    contextTimer.start();
+    for (int i = 0; i < CONTEXT_ITERATIONS; ++i) {
+        auto scope = qt_spdlog::context(qt_spdlog::kv("request_id", originalModule), qt_spdlog::kv("attempt", i));
+    }
+    QT_LOG_INFO("Вход и выход из контекста (QString + int): {:.1f} нс",
+                static_cast<double>(contextTimer.nsecsElapsed()) / CONTEXT_ITERATIONS);
+
     // Восстанавливаем оригинальный паттерн
     qt_spdlog::set_pattern(originalPattern);
 
@@ -1729,156 +2067,8 @@ void LoggerDemo::demonstrateThreadLocalPerformance()
 {
     QT_LOG_ALWAYS("=== ПРОИЗВОДИТЕЛЬНОСТЬ THREAD-LOCAL ЛОГИРОВАНИЯ ===");
 
-    const int THREAD_COUNT = 4;
-    const int PER_THREAD_ITERATIONS = 10000;
-    const int MULTI_ITERATIONS = 2500; // 4 потока × 2500 = 10000 сообщений
-
-    // 1. Сравнение производительности thread-local и обычного логирования
-    QT_LOG_ALWAYS("1. Сравнение thread-local и обычного логирования:");
-
-    // Бенчмарк обычного логирования (default логгер)
-    QElapsedTimer defaultTimer;
-    defaultTimer.start();
-
-    for (int i = 0; i < PER_THREAD_ITERATIONS; ++i) {
-        QT_LOG_INFO("Обычное логирование #{}", i);
-    }
-
-    qint64 defaultTime = defaultTimer.elapsed();
-
-    // Бенчмарк thread-local логирования
-    QElapsedTimer threadLocalTimer;
-    threadLocalTimer.start();
-
-    for (int i = 0; i < PER_THREAD_ITERATIONS; ++i) {
-        QT_LOG_INFO_TS("Thread-local логирование #{}", i);
-    }
-
-    qint64 threadLocalTime = threadLocalTimer.elapsed();
-
-    // 2. Многопоточный бенчмарк
-    QT_LOG_ALWAYS("2. Многопоточный бенчмарк:");
-
-    QVector<QFuture<qint64>> multiFutures;
-
-    // Thread-local версия
-    QElapsedTimer multiThreadLocalTimer;
-    multiThreadLocalTimer.start();
-
-    for (int i = 0; i < THREAD_COUNT; ++i) {
-        multiFutures.append(QtConcurrent::run([i, MULTI_ITERATIONS]() {
-            qt_spdlog::set_current_module(QString("MultiTest%1").arg(i));
-
-            QElapsedTimer threadTimer;
-            threadTimer.start();
-
-            for (int j = 0; j < MULTI_ITERATIONS; ++j) {
-                QT_LOG_INFO_TS("Многопоточное thread-local #{}", j);
-            }
-
-            return threadTimer.elapsed();
-        }));
-    }
-
-    qint64 multiThreadLocalTotal = 0;
-    for (int i = 0; i < multiFutures.size(); ++i) {
-        qint64 threadTime = multiFutures[i].result();
-        multiThreadLocalTotal += threadTime;
-    }
-
-    qint64 multiThreadLocalTime = multiThreadLocalTimer.elapsed();
-
-    // Обычное логирование в многопоточном режиме
-    multiFutures.clear();
-    QElapsedTimer multiDefaultTimer;
-    multiDefaultTimer.start();
-
-    for (int i = 0; i < THREAD_COUNT; ++i) {
-        multiFutures.append(QtConcurrent::run([i, MULTI_ITERATIONS]() {
-            QElapsedTimer threadTimer;
-            threadTimer.start();
-
-            for (int j = 0; j < MULTI_ITERATIONS; ++j) {
-                QT_LOG_INFO("Многопоточное обычное #{}", j);
-            }
-
-            return threadTimer.elapsed();
-        }));
-    }
-
-    qint64 multiDefaultTotal = 0;
-    for (int i = 0; i < multiFutures.size(); ++i) {
-        qint64 threadTime = multiFutures[i].result();
-        multiDefaultTotal += threadTime;
-    }
-
-    qint64 multiDefaultTime = multiDefaultTimer.elapsed();
-
-    // Восстановление основного модуля
-    qt_spdlog::set_current_module("default");
-    QT_LOG_INFO_TS("Возврат к default модулю");
-
-    // 3. Результаты сравнения (ОДИНАКОВО С THREADPOOL)
-    QT_LOG_ALWAYS("3. Результаты сравнения:");
-
-    // Однопоточное сравнение
-    QT_LOG_INFO("Обычное логирование: {} сообщений за {} мс",
-                PER_THREAD_ITERATIONS, defaultTime);
-    QT_LOG_INFO("Thread-local логирование: {} сообщений за {} мс",
-                PER_THREAD_ITERATIONS, threadLocalTime);
-
-    if (defaultTime > 0) {
-        double difference = (static_cast<double>(threadLocalTime) / defaultTime) * 100;
-        QT_LOG_INFO("Thread-local {} на: {:.1f}%",
-                    threadLocalTime > defaultTime ? "медленнее" : "быстрее",
-                    std::abs(difference - 100));
-    }
-
-    // Многопоточное сравнение
-    QT_LOG_INFO("Многопоточное обычное: {} сообщений за {} мс",
-                THREAD_COUNT * MULTI_ITERATIONS, multiDefaultTime);
-    QT_LOG_INFO("Многопоточное thread-local: {} сообщений за {} мс",
-                THREAD_COUNT * MULTI_ITERATIONS, multiThreadLocalTime);
-
-    if (multiDefaultTime > 0) {
-        double multiDifference = (static_cast<double>(multiThreadLocalTime) / multiDefaultTime) * 100;
-        QT_LOG_INFO("Многопоточное thread-local {} на: {:.1f}%",
-                    multiThreadLocalTime > multiDefaultTime ? "медленнее" : "быстрее",
-                    std::abs(multiDifference - 100));
-    }
-
-    // Сравнение суммарного времени потоков
-    QT_LOG_INFO("Многопоточное обычное суммарное время потоков: {} мс", multiDefaultTotal);
-    QT_LOG_INFO("Многопоточное thread-local суммарное время потоков: {} мс", multiThreadLocalTotal);
-
-    if (multiDefaultTotal > 0) {
-        double totalDifference = (static_cast<double>(multiThreadLocalTotal) / multiDefaultTotal) * 100;
-        QT_LOG_INFO("Суммарное время потоков thread-local {} на: {:.1f}%",
-                    multiThreadLocalTotal > multiDefaultTotal ? "больше" : "меньше",
-                    std::abs(totalDifference - 100));
-    }
-
-    // 4. Анализ эффективности (ОДИНАКОВО С THREADPOOL)
-    QT_LOG_ALWAYS("4. Анализ эффективности:");
-
-    double multiDefaultEfficiency = (static_cast<double>(multiDefaultTotal) / multiDefaultTime) * 100;
-    double multiThreadLocalEfficiency = (static_cast<double>(multiThreadLocalTotal) / multiThreadLocalTime) * 100;
-
-    QT_LOG_INFO("Эффективность многопоточного обычного: {:.1f}%", multiDefaultEfficiency);
-    QT_LOG_INFO("Эффективность многопоточного thread-local: {:.1f}%", multiThreadLocalEfficiency);
-
-    // 5. Дополнительные метрики (ОДИНАКОВО С THREADPOOL)
-    QT_LOG_ALWAYS("5. Дополнительные метрики:");
-
-    double defaultAvgPerMessage = static_cast<double>(defaultTime) / PER_THREAD_ITERATIONS;
-    double threadLocalAvgPerMessage = static_cast<double>(threadLocalTime) / PER_THREAD_ITERATIONS;
-    double multiDefaultAvgPerMessage = static_cast<double>(multiDefaultTime) / (THREAD_COUNT * MULTI_ITERATIONS);
-    double multiThreadLocalAvgPerMessage = static_cast<double>(multiThreadLocalTime) / (THREAD_COUNT * MULTI_ITERATIONS);
-
-    QT_LOG_INFO("Обычное среднее время на сообщение: {:.3f} мкс", defaultAvgPerMessage * 1000);
-    QT_LOG_INFO("Thread-local среднее время на сообщение: {:.3f} мкс", threadLocalAvgPerMessage * 1000);
-    QT_LOG_INFO("Многопоточное обычное среднее время на сообщение: {:.3f} мкс", multiDefaultAvgPerMessage * 1000);
-    QT_LOG_INFO("Многопоточное thread-local среднее время на сообщение: {:.3f} мкс", multiThreadLocalAvgPerMessage * 1000);
+    // Логгер по умолчанию против логгера потока на 1-8 потоках, null sink
+    runBenchmarks("BM_LogLiteral/sink:0/|BM_LogThreadLocal/");
 
     QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ THREAD-LOCAL ЛОГИРОВАНИЯ ЗАВЕРШЕНА ===\n");
 }
@@ -1887,121 +2077,28 @@ void LoggerDemo::demonstrateThreadPoolPerformance()
 {
     QT_LOG_ALWAYS("=== ПРОИЗВОДИТЕЛЬНОСТЬ THREAD-POOL ЛОГИРОВАНИЯ ===");
 
-    const int THREAD_COUNT = 4;
-    const int PER_THREAD_ITERATIONS = 10000;
-    const int MULTI_ITERATIONS = 2500; // 4 потока × 2500 = 10000 сообщений
-
-    // 1. Бенчмарк ThreadPool логирования
-    QT_LOG_ALWAYS("1. Бенчмарк ThreadPool логирования:");
-
-    QElapsedTimer threadPoolTimer;
-    threadPoolTimer.start();
-
-    QVector<QFuture<qint64>> threadPoolFutures;
-
-    // ThreadPool версия с QtConcurrent
-    for (int i = 0; i < THREAD_COUNT; ++i) {
-        threadPoolFutures.append(QtConcurrent::run([i, MULTI_ITERATIONS]() {
-            qt_spdlog::set_current_module(QString("ThreadPool%1").arg(i));
-
-            QElapsedTimer threadTimer;
-            threadTimer.start();
-
-            for (int j = 0; j < MULTI_ITERATIONS; ++j) {
-                QT_LOG_INFO_TS("ThreadPool логирование #{}", j);
-            }
-
-            return threadTimer.elapsed();
-        }));
-    }
-
-    qint64 threadPoolTotal = 0;
-    for (int i = 0; i < threadPoolFutures.size(); ++i) {
-        qint64 threadTime = threadPoolFutures[i].result();
-        threadPoolTotal += threadTime;
-    }
-
-    qint64 threadPoolTime = threadPoolTimer.elapsed();
-
-    // 2. Сравнение с многопоточной версией из demonstrateThreadLocalPerformance
-    QT_LOG_ALWAYS("2. Сравнение ThreadPool и многопоточного логирования:");
-
-    // Повторяем многопоточный бенчмарк для точного сравнения
-    QVector<QFuture<qint64>> multiFutures;
-    QElapsedTimer multiTimer;
-    multiTimer.start();
-
-    for (int i = 0; i < THREAD_COUNT; ++i) {
-        multiFutures.append(QtConcurrent::run([i, MULTI_ITERATIONS]() {
-            qt_spdlog::set_current_module(QString("MultiThread%1").arg(i));
-
-            QElapsedTimer threadTimer;
-            threadTimer.start();
-
-            for (int j = 0; j < MULTI_ITERATIONS; ++j) {
-                QT_LOG_INFO_TS("Многопоточное логирование #{}", j);
-            }
-
-            return threadTimer.elapsed();
-        }));
-    }
-
-    qint64 multiTotal = 0;
-    for (int i = 0; i < multiFutures.size(); ++i) {
-        qint64 threadTime = multiFutures[i].result();
-        multiTotal += threadTime;
-    }
-
-    qint64 multiTime = multiTimer.elapsed();
-
-    // Восстановление основного модуля
-    qt_spdlog::set_current_module("default");
-    QT_LOG_INFO_TS("Возврат к default модулю");
-
-    // 3. Сравнение результатов
-    QT_LOG_ALWAYS("3. Результаты сравнения:");
-
-    QT_LOG_INFO("ThreadPool: {} сообщений за {} мс",
-                THREAD_COUNT * MULTI_ITERATIONS, threadPoolTime);
-    QT_LOG_INFO("Многопоточное: {} сообщений за {} мс",
-                THREAD_COUNT * MULTI_ITERATIONS, multiTime);
-
-    // Сравнение общего времени
-    if (multiTime > 0) {
-        double difference = (static_cast<double>(threadPoolTime) / multiTime) * 100;
-        QT_LOG_INFO("ThreadPool {} на: {:.1f}%",
-                    threadPoolTime > multiTime ? "медленнее" : "быстрее",
-                    std::abs(difference - 100));
-    }
-
-    // Сравнение суммарного времени потоков
-    QT_LOG_INFO("ThreadPool суммарное время потоков: {} мс", threadPoolTotal);
-    QT_LOG_INFO("Многопоточное суммарное время потоков: {} мс", multiTotal);
+    QT_LOG_ALWAYS("1. Перенос контекста в задачи (run_with_context):");
 
-    if (multiTotal > 0) {
-        double totalDifference = (static_cast<double>(threadPoolTotal) / multiTotal) * 100;
-        QT_LOG_INFO("Суммарное время потоков ThreadPool {} на: {:.1f}%",
-                    threadPoolTotal > multiTotal ? "больше" : "меньше",
-                    std::abs(totalDifference - 100));
+    qt_spdlog::set_pattern(qt_spdlog::patterns::CONTEXT);
+    {
+        // Задачи одной операции выводят ее correlation_id без ручной установки
+        auto operation = qt_spdlog::begin_operation();
+        auto module = qt_spdlog::module("Import");
+        QVector<QFuture<void>> importFutures;
+        for (int i = 0; i < 3; ++i) {
+            importFutures.append(qt_spdlog::run_with_context([](int part) {
+                QT_LOG_INFO("Часть {} импортирована, модуль {}", part, qt_spdlog::get_current_module());
+            }, i));
+        }
+        for (auto& future : importFutures) {
+            future.waitForFinished();
+        }
     }
+    qt_spdlog::set_default_pattern();
 
-    // 4. Анализ эффективности
-    QT_LOG_ALWAYS("4. Анализ эффективности:");
-
-    double threadPoolEfficiency = (static_cast<double>(threadPoolTotal) / threadPoolTime) * 100;
-    double multiEfficiency = (static_cast<double>(multiTotal) / multiTime) * 100;
-
-    QT_LOG_INFO("Эффективность ThreadPool: {:.1f}%", threadPoolEfficiency);
-    QT_LOG_INFO("Эффективность многопоточного: {:.1f}%", multiEfficiency);
-
-    // 5. Дополнительные метрики
-    QT_LOG_ALWAYS("5. Дополнительные метрики:");
-
-    double threadPoolAvgPerMessage = static_cast<double>(threadPoolTime) / (THREAD_COUNT * MULTI_ITERATIONS);
-    double multiAvgPerMessage = static_cast<double>(multiTime) / (THREAD_COUNT * MULTI_ITERATIONS);
-
-    QT_LOG_INFO("ThreadPool среднее время на сообщение: {:.3f} мкс", threadPoolAvgPerMessage * 1000);
-    QT_LOG_INFO("Многопоточное среднее время на сообщение: {:.3f} мкс", multiAvgPerMessage * 1000);
+    // Запись через логгер потока и стоимость переноса контекста в задачу
+    QT_LOG_ALWAYS("2. Бенчмарки логгера потока и run_with_context:");
+    runBenchmarks("BM_LogThreadLocal/|BM_TaskContext/");
 
     QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ THREAD-POOL ЛОГИРОВАНИЯ ЗАВЕРШЕНА ===\n");
 }
@@ -2300,3 +2397,257 @@ void LoggerDemo::demonstrateExceptionLogging()
 
     QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ ЛОГИРОВАНИЯ ИСКЛЮЧЕНИЙ ЗАВЕРШЕНА ===\n");
 }
+
+void LoggerDemo::demonstrateAsyncBackendAffinity()
+{
+    QT_LOG_ALWAYS("=== АСИНХРОННЫЙ BACKEND: ПРИВЯЗКА К CPU ===");
+
+    const int PRODUCER_COUNT = 4;
+    const int PER_PRODUCER_MESSAGES = 20000;
+    const int cpuCount = QThread::idealThreadCount();
+    const QString logPath = QDir::temp().filePath("qt_spdlog_affinity_bench.log");
+
+    QT_LOG_ALWAYS("Производителей: {}, сообщений на поток: {}, CPU: {}",
+                  PRODUCER_COUNT, PER_PRODUCER_MESSAGES, cpuCount);
+
+    // Прогон: гистограмма задержек вызова логгера в производителях
+    auto runBenchmark = [&](const qt_spdlog::async::backend_options& options) {
+        auto backend = std::make_shared<qt_spdlog::async::backend>(options);
+        auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(logPath.toStdString(), true);
+        auto logger = std::make_shared<qt_spdlog::async::async_logger>("affinity_bench", sink, backend);
+        auto recorder = std::make_shared<qt_spdlog::latency::recorder>();
+
+        QVector<QFuture<void>> futures;
+        for (int i = 0; i < PRODUCER_COUNT; ++i) {
+            futures.append(QtConcurrent::run([logger, recorder, PER_PRODUCER_MESSAGES]() {
+                for (int j = 0; j < PER_PRODUCER_MESSAGES; ++j) {
+                    qt_spdlog::latency::recorder::scope timer(*recorder);
+                    logger->info("Сообщение производителя #{} со значением {:.3f}", j, j * 0.5);
+                }
+            }));
+        }
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+        return recorder->snapshot();
+    };
+
+    // 1. Потоки backend без ограничений
+    QT_LOG_ALWAYS("1. Backend без привязки:");
+    qt_spdlog::async::backend_options unpinned;
+    unpinned.queue_size = 16384;
+    auto unpinnedLatencies = runBenchmark(unpinned);
+
+    // 2. Backend на последнем CPU с SCHED_IDLE и huge pages
+    QT_LOG_ALWAYS("2. Backend на CPU {} (SCHED_IDLE, huge pages):", cpuCount - 1);
+    qt_spdlog::async::backend_options pinned = unpinned;
+    pinned.worker.cpu_affinity = {cpuCount - 1};
+    pinned.worker.idle_priority = true;
+    pinned.worker.name = "qt_spdlog_pin";
+    pinned.huge_pages = true;
+    auto pinnedLatencies = runBenchmark(pinned);
+
+    // 3. Сравнение
+    QT_LOG_ALWAYS("3. Задержка вызова в производителе:");
+    QT_LOG_INFO("{}", qt_spdlog::latency::format("Без привязки", unpinnedLatencies));
+    QT_LOG_INFO("{}", qt_spdlog::latency::format("С привязкой ", pinnedLatencies));
+
+    if (cpuCount < 2) {
+        QT_LOG_WARN("Доступен один CPU: привязка не отделяет backend от производителей");
+    }
+
+    QFile::remove(logPath);
+
+    QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ ПРИВЯЗКИ К CPU ЗАВЕРШЕНА ===\n");
+}
+
+void LoggerDemo::demonstrateSocketSinkThroughput()
+{
+    QT_LOG_ALWAYS("=== СОКЕТНЫЙ SINK: ПРОПУСКНАЯ СПОСОБНОСТЬ ===");
+
+#if defined(_WIN32) || !defined(QT_SPDLOG_COLLECTOR_PATH)
+    QT_LOG_WARN("Сокетный sink и qt_spdlog_collector доступны только в POSIX сборке");
+#else
+    const int MESSAGES = 200000;
+    const QVector<int> BATCH_SIZES = {1, 16, 128, 1024};
+    const QString socketPath = QDir::temp().filePath("qt_spdlog_collector_bench.sock");
+
+    QT_LOG_ALWAYS("Сообщений: {}, приемник: {}", MESSAGES, QT_SPDLOG_COLLECTOR_PATH);
+
+    for (int batchSize : BATCH_SIZES) {
+        QProcess collector;
+        collector.start(QT_SPDLOG_COLLECTOR_PATH, {"--unix", socketPath, "--count", QString::number(MESSAGES)});
+        if (!collector.waitForStarted() || !collector.waitForReadyRead()) {
+            QT_LOG_ERROR("Не удалось запустить приемник: {}", QT_SPDLOG_COLLECTOR_PATH);
+            return;
+        }
+        collector.readAllStandardOutput();
+
+        qt_spdlog::sinks::socket_sink_options options;
+        options.address = socketPath.toStdString();
+        options.batch_records = static_cast<std::size_t>(batchSize);
+        options.batch_bytes = 1024 * 1024;
+        auto sink = std::make_shared<qt_spdlog::sinks::socket_sink_st>(options);
+        spdlog::logger logger("socket_bench", sink);
+        logger.set_pattern("[%H:%M:%S.%e] [%l] %v");
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < MESSAGES; ++i) {
+            logger.info("Сообщение для приемника #{} со значением {:.3f}", i, i * 0.5);
+        }
+        logger.flush();
+        collector.waitForFinished();
+        qint64 elapsedNs = timer.nsecsElapsed();
+
+        auto stats = sink->stats();
+        double seconds = static_cast<double>(elapsedNs) / 1e9;
+        QT_LOG_INFO("Пачка {:>5}: {:.0f} сообщений/с, {:.1f} МБ/с, отправок: {}, приемник: {}",
+                    batchSize,
+                    MESSAGES / seconds,
+                    stats.bytes_sent / seconds / (1024.0 * 1024.0),
+                    stats.batches_sent,
+                    QString::fromUtf8(collector.readAllStandardOutput()).trimmed());
+    }
+#endif
+
+    QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ СОКЕТНОГО SINK ЗАВЕРШЕНА ===\n");
+}
+
+void LoggerDemo::demonstrateCborVsJsonEncoding()
+{
+    QT_LOG_ALWAYS("=== CBOR И JSON: РАЗМЕР И СКОРОСТЬ КОДИРОВАНИЯ ===");
+
+    const int RECORDS = 200000;
+    const QStringList tags = {"api", "billing"};
+
+    // Одна и та же запись уходит через пустой sink (стоимость самого вызова)
+    // и через sink'и с json_formatter/cbor_formatter
+    struct Variant {
+        const char* name;
+        std::unique_ptr<spdlog::formatter> formatter;
+    };
+    Variant variants[] = {
+        {"без форматирования", nullptr},
+        {"json_formatter", std::make_unique<qt_spdlog::json_formatter>()},
+        {"cbor_formatter", std::make_unique<qt_spdlog::cbor_formatter>()},
+    };
+
+    QT_LOG_ALWAYS("Записей: {}, поля: user_id, amount, currency, tags", RECORDS);
+    for (auto& variant : variants) {
+        auto sink = std::make_shared<FormatCountingSink>();
+        if (variant.formatter) {
+            sink->set_formatter(std::move(variant.formatter));
+        } else {
+            sink->formatEnabled = false;
+        }
+        auto logger = std::make_shared<spdlog::logger>("encoding_bench", sink);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < RECORDS; ++i) {
+            QT_LOGGER_INFO_KV(logger, "Платеж обработан", kv("user_id", 10000 + i), kv("amount", i * 0.25),
+                              kv("currency", "RUB"), kv("tags", tags));
+        }
+        qint64 elapsedNs = timer.nsecsElapsed();
+
+        QT_LOG_INFO("{:<20} {:>7.1f} нс/запись, {:>6.1f} байт/запись",
+                    variant.name,
+                    static_cast<double>(elapsedNs) / RECORDS,
+                    static_cast<double>(sink->bytes) / RECORDS);
+    }
+
+    QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ CBOR ЗАВЕРШЕНА ===\n");
+}
+
+void LoggerDemo::demonstrateConfigReload()
+{
+    QT_LOG_ALWAYS("=== ПЕРЕЗАГРУЗКА КОНФИГУРАЦИИ НА ЛЕТУ ===");
+
+    const QString path = QDir::temp().filePath("qt_spdlog_demo_config.json");
+    auto writeConfig = [&path](const char* level) {
+        QFile file(path);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(QString(R"({
+    "sinks": {
+        "console": {"type": "stdout", "pattern": "%^[%T] [%l]%$ [config] %v"},
+        "discard": {"type": "null"}
+    },
+    "loggers": {
+        "demo_config": {"level": "%1", "sinks": ["console"]},
+        "demo_config_bench": {"level": "info", "sinks": ["discard"]}
+    }
+})").arg(level).toUtf8());
+        }
+    };
+
+    // 1. Загрузка при старте: логгеры создаются из файла
+    writeConfig("info");
+    qt_spdlog::config::ConfigWatcher watcher(path);
+    auto logger = spdlog::get("demo_config");
+    if (!logger) {
+        QT_LOG_ERROR("Конфигурация не применена: {}", watcher.lastError());
+        return;
+    }
+    logger->debug("debug до перезагрузки (не должно отобразиться)");
+    logger->info("info до перезагрузки");
+
+    // 2. Смена уровня в файле. QFileSystemWatcher сделает то же из цикла событий,
+    //    kill -HUP - после enableSighupReload()
+    writeConfig("debug");
+    watcher.reload();
+    logger->debug("debug после перезагрузки, поколение {}", watcher.generation());
+
+    // 3. Файл с ошибкой не применяется
+    {
+        QFile file(path);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(R"({"loggers": {"demo_config": {"level": "loud"}}})");
+        }
+    }
+    watcher.reload();
+    QT_LOG_INFO("Ошибка: '{}', уровень остался {}", watcher.lastError(),
+                qt_spdlog::level_to_string(logger->level()));
+
+    // 4. Запись во время перезагрузок: потоки не ждут разбора и применения файла
+    writeConfig("info");
+    watcher.reload();
+    auto bench = spdlog::get("demo_config_bench");
+    const int THREADS = 4;
+    const int RECORDS = 200000;
+
+    for (bool reloading : {false, true}) {
+        std::atomic<int> finished{0};
+        QElapsedTimer timer;
+        timer.start();
+        QList<QFuture<void>> futures;
+        for (int t = 0; t < THREADS; ++t) {
+            futures.append(QtConcurrent::run([&]() {
+                for (int i = 0; i < RECORDS; ++i) {
+                    bench->info("record {}", i);
+                }
+                finished.fetch_add(1);
+            }));
+        }
+        int reloads = 0;
+        while (reloading && finished.load() < THREADS) {
+            watcher.reload();
+            ++reloads;
+        }
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+        qint64 elapsedNs = timer.nsecsElapsed();
+
+        QT_LOG_INFO("{:<18} {:>6.1f} нс/запись, перезагрузок: {}",
+                    reloading ? "с перезагрузками" : "без перезагрузок",
+                    static_cast<double>(elapsedNs) / (static_cast<double>(THREADS) * RECORDS),
+                    reloads);
+    }
+
+    QFile::remove(path);
+    spdlog::drop("demo_config");
+    spdlog::drop("demo_config_bench");
+
+    QT_LOG_ALWAYS("=== ДЕМОНСТРАЦИЯ КОНФИГУРАЦИИ ЗАВЕРШЕНА ===\n");
+}
@@ -21,6 +21,7 @@ public slots:
     void stopTimers();
     void runSpecificTest(int testIndex);
     void showAvailableTests();
+    int testCount() const;
 
 private slots:
     void onTimerTimeout();
@@ -64,6 +65,14 @@ private:
     void demonstrateScopedModule();
     // Бизнес демонстрация
     void demonstrateRealWorldScenarios();
+    // Бенчмарк асинхронного backend: p99 производителей с привязкой к CPU и без
+    void demonstrateAsyncBackendAffinity();
+    // Бенчмарк сокетного sink'а: пропускная способность при разных размерах пачки
+    void demonstrateSocketSinkThroughput();
+    // Бенчмарк CBOR против JSON: байт и нс на запись с полями
+    void demonstrateCborVsJsonEncoding();
+    // Конфигурация из файла: перезагрузка уровней и sink'ов без перезапуска
+    void demonstrateConfigReload();
 
     void initializeTestList();
     QString getDemoName(int index);
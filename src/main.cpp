@@ -4,6 +4,7 @@
 #include <QCommandLineParser>
 #include <iostream>
 #include "qt_spdlog.h"
+#include "qt_spdlog_config.h"
 #include "loggerdemo.h"
 
 #ifdef _WIN32
@@ -37,6 +38,8 @@ bool initializeLogging(const QString& logger_name = "qt_app") {
         spdlog::set_default_logger(logger);
 
         qt_spdlog::set_level(QtMsgType::QtInfoMsg);
+        // Уровни логгеров из QT_SPDLOG_LEVEL, например "net=debug,db.*=warn"
+        qt_spdlog::load_level_spec_from_env();
         qt_spdlog::set_qt_style_pattern();
         qt_spdlog::setup_qt_message_handler();
         qt_spdlog::setup_display_always();
@@ -74,10 +77,13 @@ void runInteractiveMode(LoggerDemo& loggerDemo)
     });
 
     while (true) {
-        std::cout << "\nКоманды: 0-список, 1-17-тест, 99-все, 999-выход\n";
+        std::cout << "\nКоманды: 0-список, 1-" << loggerDemo.testCount() << "-тест, 99-все, 999-выход\n";
         std::cout << "Введите команду: ";
 
         stream.readLineInto(&input);
+        // Цикл событий здесь не крутится: изменения файла конфигурации и SIGHUP
+        // применяются между командами
+        QCoreApplication::processEvents();
         int command = input.toInt();
 
         if (command == 999) {
@@ -91,7 +97,7 @@ void runInteractiveMode(LoggerDemo& loggerDemo)
             std::cout << "Запуск всех тестов...\n";
             loggerDemo.demonstrateAllScenarios();
         }
-        else if (command >= 1 && command <= 18) {
+        else if (command >= 1 && command <= loggerDemo.testCount()) {
             std::cout << "Запуск теста #" << command << "...\n";
             loggerDemo.runSpecificTest(command - 1);
         }
@@ -139,7 +145,7 @@ int main(int argc, char *argv[])
 
     // Опция для запуска конкретного теста
     QCommandLineOption testOption(QStringList() << "t" << "test",
-                                  "Запустить конкретный тест (1-17)",
+                                  QString("Запустить конкретный тест (1-%1)").arg(loggerDemo.testCount()),
                                   "test_number");
     parser.addOption(testOption);
 
@@ -153,8 +159,34 @@ int main(int argc, char *argv[])
                                   "Показать список доступных тестов");
     parser.addOption(listOption);
 
+    // Опция для загрузки конфигурации логгеров с перезагрузкой при изменении
+    QCommandLineOption configOption(QStringList() << "c" << "config",
+                                    "Файл конфигурации логгеров (JSON или INI), перезагружается при изменении и по SIGHUP",
+                                    "file");
+    parser.addOption(configOption);
+
+    // Опция для уровней логгеров: заменяет спецификацию из QT_SPDLOG_LEVEL
+    QCommandLineOption logLevelOption(QStringList() << "log-level",
+                                      "Уровни логгеров: \"net=debug,db.*=warn,*=info\" (глобы * и ?)",
+                                      "spec");
+    parser.addOption(logLevelOption);
+
     parser.process(app);
 
+    std::unique_ptr<qt_spdlog::config::ConfigWatcher> configWatcher;
+    if (parser.isSet(configOption)) {
+        configWatcher = std::make_unique<qt_spdlog::config::ConfigWatcher>(parser.value(configOption));
+        configWatcher->enableSighupReload();
+    }
+
+    if (parser.isSet(logLevelOption)) {
+        QString error;
+        if (!qt_spdlog::set_level_spec(parser.value(logLevelOption), &error)) {
+            std::cerr << "Ошибка: " << error.toStdString() << "\n";
+            return 1;
+        }
+    }
+
     // Обработка параметров командной строки
     if (parser.isSet(listOption)) {
         loggerDemo.showAvailableTests();
@@ -169,13 +201,13 @@ int main(int argc, char *argv[])
     else if (parser.isSet(testOption)) {
         bool ok;
         int testNumber = parser.value(testOption).toInt(&ok);
-        if (ok && testNumber >= 1 && testNumber <= 17) {
+        if (ok && testNumber >= 1 && testNumber <= loggerDemo.testCount()) {
             std::cout << "Запуск теста #" << testNumber << "...\n";
             QT_LOG_ALWAYS("🎯 ЗАПУСК ТЕСТА", testNumber);
             loggerDemo.runSpecificTest(testNumber - 1);
             return 0;
         } else {
-            std::cerr << "Ошибка: номер теста должен быть от 1 до 17\n";
+            std::cerr << "Ошибка: номер теста должен быть от 1 до " << loggerDemo.testCount() << "\n";
             return 1;
         }
     }
@@ -1,8 +1,70 @@
 #include <QtTest/QtTest>
 #include "qt_spdlog.h"
+#include "qt_spdlog_metrics.h"
+#include "qt_spdlog_concurrent.h"
+#include "qt_spdlog_config.h"
+#include "qt_spdlog_socket.h"
 #include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/sinks/base_sink.h>
 #include <sstream>
 #include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <future>
+
+Q_LOGGING_CATEGORY(lcTestNetwork, "test.network")
+
+// Sink, который сам пишет предупреждение Qt во время записи
+class ReentrantSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    int records = 0;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg&) override
+    {
+        ++records;
+        qWarning("предупреждение из sink'а");
+    }
+    void flush_() override {}
+};
+
+// Sink, который отрисовывает поля структурированной записи в JSON
+class StructuredJsonSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::string output;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        spdlog::memory_buf_t buffer;
+        if (const auto* fields = qt_spdlog::structured::current()) {
+            auto message = fields->message(msg);
+            buffer.append(message.data(), message.data() + message.size());
+            buffer.push_back(' ');
+            qt_spdlog::structured::write_json(buffer, *fields);
+        }
+        output.append(buffer.data(), buffer.size());
+    }
+    void flush_() override {}
+};
+
+// Sink, который запоминает время и текст каждой записи
+class TimeSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::vector<spdlog::log_clock::time_point> times;
+    std::vector<std::string> payloads;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override
+    {
+        times.push_back(msg.time);
+        payloads.emplace_back(msg.payload.data(), msg.payload.size());
+    }
+    void flush_() override {}
+};
 
 class TestQtSpdlog : public QObject
 {
@@ -25,6 +87,13 @@ private slots:
 
     // Тесты JSON логирования
     void testJsonLog();
+    void testJsonWriterCompat();
+    void testJsonLevelGating();
+    void testStructuredKv();
+    void testJsonFormatter();
+    void testCborFormatter();
+    void testThreadContext();
+    void testContextPropagation();
 
     // Тесты макросов (базовые)
     void testMacroTrace();
@@ -39,6 +108,42 @@ private slots:
     void testScopedModule();
     void testScopedLoggerLevel();
 
+    // Тесты разбора уровней
+    void testLevelParsing();
+    void testLevelSpec();
+    void testLoggerHierarchy();
+    void testLoggerHandle();
+
+    // Тесты паттернов
+    void testCompiledPattern();
+    void testTimestamps();
+    void testTscTimestamps();
+
+    // Тесты интеграции с Qt message handler
+    void testQtMessageHandler();
+    void testQtCategoryBridge();
+    void testQtHandlerReentrancy();
+    void testAsyncQtMessageHandler();
+
+    // Тесты контекстного окна
+    void testContextWindow();
+
+    // Тесты асинхронного логирования
+    void testAsyncMetrics();
+    void testAsyncPriorityLanes();
+
+    // Тесты гистограмм задержек
+    void testLatencyHistogram();
+
+    // Тесты сокетного sink'а
+    void testSocketSink();
+    void testSocketSinkDatagram();
+
+    // Тесты конфигурации из файла
+    void testConfigParsing();
+    void testConfigReload();
+    void testConfigWatcher();
+
     // Инициализация и очистка
     void initTestCase();
     void cleanupTestCase();
@@ -208,17 +313,357 @@ void TestQtSpdlog::testJsonLog()
     fields["action"] = "login";
     fields["success"] = true;
     
+    std::ostringstream jsonStream;
+    auto jsonSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(jsonStream);
+    jsonSink->set_formatter(std::make_unique<qt_spdlog::json_formatter>("\n"));
+    testLogger->sinks().push_back(jsonSink);
+
     qt_spdlog::json::json_info("User action", fields);
-    
+
+    testLogger->sinks().pop_back();
+
+    // Текстовый sink получает сообщение и поля в стиле logfmt, а не строку JSON
+    QCOMPARE(QString::fromStdString(testStream.str()).trimmed(),
+             QString("User action action=login success=true user_id=123"));
+
+    // json_formatter пишет поля объектом, без повторного экранирования
+    QJsonParseError error;
+    QJsonObject record = QJsonDocument::fromJson(QByteArray::fromStdString(jsonStream.str()), &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(record.value("message").toString(), QString("User action"));
+    QCOMPARE(record.value("level").toString(), QString("info"));
+    QJsonObject recordFields = record.value("fields").toObject();
+    QCOMPARE(recordFields.value("user_id").toInt(), 123);
+    QCOMPARE(recordFields.value("action").toString(), QString("login"));
+    QCOMPARE(recordFields.value("success").toBool(), true);
+}
+
+void TestQtSpdlog::testJsonWriterCompat()
+{
+    // Вывод потокового writer'а должен совпадать с QJsonDocument::Compact байт в байт
+    QVariantHash nested;
+    nested["zeta"] = 1;
+    nested["alpha"] = QVariantList{1.5, QString("два"), QVariant()};
+
+    QVariantMap fields;
+    fields["text"] = QString("кавычка \" слеш \\ перевод\nстроки\t\x01 и эмодзи 😀");
+    fields["long_ascii"] = QString("abcdefghijklmnopqrstuvwxyz0123456789");
+    fields["int"] = -42;
+    fields["uint"] = 42u;
+    fields["int64"] = qint64(9007199254740993LL);
+    fields["uint64_big"] = quint64(18446744073709551615ULL);
+    fields["double"] = 2500.5;
+    fields["integral_double"] = 5000.0;
+    fields["small_double"] = 1.5e-5;
+    fields["big_double"] = 1e20;
+    fields["nan"] = std::numeric_limits<double>::quiet_NaN();
+    fields["flag"] = true;
+    fields["null"] = QVariant();
+    fields["list"] = QStringList{"a", "b"};
+    fields["hash"] = nested;
+    fields["map"] = QVariantMap{{"b", 2}, {"a", QVariantMap{{"inner", false}}}};
+    fields["date"] = QDateTime(QDate(2024, 1, 2), QTime(3, 4, 5));
+    fields["bytes"] = QByteArray("raw");
+    fields[QString("ключ")] = QString(QChar(0xD800)); // одиночный суррогат
+
+    spdlog::memory_buf_t buffer;
+    qt_spdlog::json::write_object(buffer, fields);
+    QByteArray expected = QJsonDocument(QJsonObject::fromVariantMap(fields)).toJson(QJsonDocument::Compact);
+    QCOMPARE(QByteArray(buffer.data(), static_cast<int>(buffer.size())), expected);
+
+    // Запись целиком: порядок ключей и формат метки времени как у QJsonObject
+    buffer.clear();
+    qt_spdlog::json::write_record(buffer, spdlog::level::warn, "Сообщение", {{"id", 7}});
+    QJsonDocument record = QJsonDocument::fromJson(QByteArray(buffer.data(), static_cast<int>(buffer.size())));
+    QVERIFY(record.isObject());
+    QJsonObject object = record.object();
+    QCOMPARE(QJsonDocument(object).toJson(QJsonDocument::Compact), QByteArray(buffer.data(), static_cast<int>(buffer.size())));
+    QCOMPARE(object.value("message").toString(), QString("Сообщение"));
+    QVERIFY(QDateTime::fromString(object.value("timestamp").toString(), Qt::ISODateWithMs).isValid());
+}
+
+void TestQtSpdlog::testJsonLevelGating()
+{
+    testStream.str("");
+    testLogger->set_level(spdlog::level::info);
+
+    // На выключенном уровне ни сообщение, ни поля не вычисляются
+    int evaluated = 0;
+    auto makeFields = [&evaluated]() {
+        ++evaluated;
+        return QVariantMap{{"expensive", 1}};
+    };
+    auto makeMessage = [&evaluated]() {
+        ++evaluated;
+        return QString("сообщение");
+    };
+    QT_LOG_DEBUG_JSON(makeMessage(), makeFields());
+    QT_LOG_DEBUG_JSON(makeMessage(), makeFields);
+    qt_spdlog::json::json_debug("сообщение", makeFields);
+    QCOMPARE(evaluated, 0);
+    QVERIFY(testStream.str().empty());
+
+    // Запятые внутри QVariantMap{{...}, {...}} не ломают макрос
+    QT_LOG_INFO_JSON("Поля", QVariantMap{{"a", 1}, {"b", 2}});
+    QT_LOG_INFO_JSON("Лениво", makeFields);
+    QCOMPARE(evaluated, 1);
+
     QString output = QString::fromStdString(testStream.str());
-    
-    // Проверяем, что вывод содержит ожидаемые поля
-    QVERIFY(output.contains("\"message\":\"User action\""));
-    QVERIFY(output.contains("\"level\":\"info\""));
-    QVERIFY(output.contains("\"user_id\":123"));
-    QVERIFY(output.contains("\"action\":\"login\""));
-    QVERIFY(output.contains("\"success\":true"));
-    QVERIFY(output.contains("\"timestamp\""));
+    QVERIFY(output.contains("Поля a=1 b=2"));
+    QVERIFY(output.contains("Лениво expensive=1"));
+
+    testLogger->set_level(spdlog::level::trace);
+}
+
+void TestQtSpdlog::testStructuredKv()
+{
+    testStream.str("");
+
+    // Текстовый sink получает сообщение с полями в стиле logfmt
+    QString user = "Иван Петров";
+    qint64 userId = 1542;
+    double latency = 12.5;
+    QT_LOG_INFO_KV("Вход", kv("user_id", userId), kv("user", user), kv("latency_ms", latency), kv("ok", true));
+    QCOMPARE(QString::fromStdString(testStream.str()).trimmed(),
+             QString("Вход user_id=1542 user=\"Иван Петров\" latency_ms=12.5 ok=true"));
+
+    // Sink с собственным форматом получает те же поля в исходных типах
+    auto jsonSink = std::make_shared<StructuredJsonSink>();
+    auto logger = std::make_shared<spdlog::logger>("kv_logger", jsonSink);
+    QT_LOGGER_WARN_KV(logger, "Медленно", kv("latency_ms", latency), kv("path", "/api/v1"),
+                      kv("tags", QStringList{"db", "cache"}));
+    QCOMPARE(QString::fromStdString(jsonSink->output),
+             QString("Медленно {\"latency_ms\":12.5,\"path\":\"/api/v1\",\"tags\":[\"db\",\"cache\"]}"));
+    QVERIFY(qt_spdlog::structured::current() == nullptr);
+
+    // На выключенном уровне значения не вычисляются
+    logger->set_level(spdlog::level::warn);
+    int evaluated = 0;
+    auto value = [&evaluated]() { return ++evaluated; };
+    QT_LOGGER_INFO_KV(logger, "Отброшено", kv("value", value()));
+    QCOMPARE(evaluated, 0);
+}
+
+void TestQtSpdlog::testJsonFormatter()
+{
+    // Один вызов: текстовый sink и JSON sink, каждый со своим форматом
+    std::ostringstream textStream;
+    std::ostringstream jsonStream;
+    auto textSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(textStream);
+    auto jsonSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(jsonStream);
+    textSink->set_pattern("%v");
+    jsonSink->set_formatter(std::make_unique<qt_spdlog::json_formatter>("\n"));
+    auto logger = std::make_shared<spdlog::logger>("json_app", spdlog::sinks_init_list{textSink, jsonSink});
+
+    {
+        auto module = qt_spdlog::module("billing");
+        QT_LOGGER_INFO_KV(logger, "Платеж \"принят\"", kv("amount", 2500.5), kv("currency", "RUB"));
+    }
+    QT_LOGGER_WARN(logger, "Без полей");
+
+    QCOMPARE(QString::fromStdString(textStream.str()),
+             QString("Платеж \"принят\" amount=2500.5 currency=RUB\nБез полей\n"));
+
+    QStringList lines = QString::fromStdString(jsonStream.str()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(lines.size(), 2);
+
+    QJsonParseError error;
+    QJsonObject first = QJsonDocument::fromJson(lines[0].toUtf8(), &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(first.value("level").toString(), QString("info"));
+    QCOMPARE(first.value("logger").toString(), QString("json_app"));
+    QCOMPARE(first.value("module").toString(), QString("billing"));
+    QCOMPARE(first.value("message").toString(), QString("Платеж \"принят\""));
+    QCOMPARE(first.value("fields").toObject().value("amount").toDouble(), 2500.5);
+    QCOMPARE(first.value("fields").toObject().value("currency").toString(), QString("RUB"));
+    QVERIFY(first.value("source").toObject().value("file").toString().endsWith("test_qt_spdlog.cpp"));
+    QVERIFY(first.value("thread").toInteger() > 0);
+
+    QJsonObject second = QJsonDocument::fromJson(lines[1].toUtf8()).object();
+    QCOMPARE(second.value("message").toString(), QString("Без полей"));
+    QVERIFY(!second.contains("fields"));
+    QVERIFY(!second.contains("source"));
+
+    // Асинхронный логгер копирует значения полей: строка без владения переживает исходную
+    std::ostringstream asyncStream;
+    auto asyncSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(asyncStream);
+    asyncSink->set_formatter(std::make_unique<qt_spdlog::json_formatter>("\n"));
+    auto backend = std::make_shared<qt_spdlog::async::backend>();
+    auto asyncLogger = std::make_shared<qt_spdlog::async::async_logger>("json_async", asyncSink, backend);
+    {
+        std::string path = "/api/v1/orders";
+        QT_LOGGER_INFO_KV(asyncLogger, "Запрос", kv("path", std::string_view(path)), kv("status", 200));
+        path.assign(path.size(), 'x');
+    }
+    QVERIFY(asyncLogger->flush_and_wait());
+    QJsonObject asyncFields = QJsonDocument::fromJson(QByteArray::fromStdString(asyncStream.str())).object()
+                                  .value("fields").toObject();
+    QCOMPARE(asyncFields.value("path").toString(), QString("/api/v1/orders"));
+    QCOMPARE(asyncFields.value("status").toInt(), 200);
+}
+
+void TestQtSpdlog::testCborFormatter()
+{
+    std::ostringstream cborStream;
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(cborStream);
+    sink->set_formatter(std::make_unique<qt_spdlog::cbor_formatter>());
+    auto logger = std::make_shared<spdlog::logger>("cbor_app", sink);
+
+    {
+        auto module = qt_spdlog::module("billing");
+        QT_LOGGER_INFO_KV(logger, "Платеж принят", kv("amount", 2500.5), kv("count", -3),
+                          kv("currency", "RUB"), kv("tags", QStringList{"a", "b"}));
+    }
+    QT_LOGGER_ERROR(logger, "Без полей");
+
+    // Записи идут подряд, каждая декодируется как map QCborValue
+    const QByteArray data = QByteArray::fromStdString(cborStream.str());
+    QCborStreamReader reader(data);
+    QList<QCborMap> records;
+    while (reader.isValid()) {
+        records.append(QCborValue::fromCbor(reader).toMap());
+    }
+    QCOMPARE(records.size(), 2);
+
+    const QCborMap first = records[0];
+    const qint64 nowNs = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    QVERIFY(qAbs(first.value(QStringLiteral("ts")).toInteger() - nowNs) < qint64(60) * 1000000000);
+    QCOMPARE(first.value(QStringLiteral("lvl")).toInteger(), qint64(spdlog::level::info));
+    QCOMPARE(first.value(QStringLiteral("log")).toString(), QString("cbor_app"));
+    QCOMPARE(first.value(QStringLiteral("mod")).toString(), QString("billing"));
+    QCOMPARE(first.value(QStringLiteral("msg")).toString(), QString("Платеж принят"));
+    QVERIFY(first.value(QStringLiteral("src")).toArray().at(0).toString().endsWith("test_qt_spdlog.cpp"));
+
+    const QCborMap fields = first.value(QStringLiteral("f")).toMap();
+    QCOMPARE(fields.keys().first().toString(), QString("amount"));
+    QVERIFY(fields.value(QStringLiteral("amount")).isDouble());
+    QCOMPARE(fields.value(QStringLiteral("amount")).toDouble(), 2500.5);
+    QCOMPARE(fields.value(QStringLiteral("count")).toInteger(), qint64(-3));
+    QCOMPARE(fields.value(QStringLiteral("currency")).toString(), QString("RUB"));
+    QCOMPARE(fields.value(QStringLiteral("tags")).toArray().toVariantList(), QVariantList({"a", "b"}));
+
+    const QCborMap second = records[1];
+    QCOMPARE(second.value(QStringLiteral("lvl")).toInteger(), qint64(spdlog::level::err));
+    QVERIFY(!second.contains(QStringLiteral("f")));
+    QVERIFY(!second.contains(QStringLiteral("src")));
+    QVERIFY(!second.contains(QStringLiteral("mod")));
+
+#ifdef QT_SPDLOG_CBOR2JSON_PATH
+    // Конвертер дает те же поля, что и json_formatter
+    QProcess converter;
+    converter.start(QT_SPDLOG_CBOR2JSON_PATH);
+    QVERIFY(converter.waitForStarted());
+    converter.write(data);
+    converter.closeWriteChannel();
+    QVERIFY(converter.waitForFinished());
+    QCOMPARE(converter.exitCode(), 0);
+
+    const QList<QByteArray> lines = converter.readAllStandardOutput().split('\n');
+    QCOMPARE(lines.size(), 3);
+    const QJsonObject json = QJsonDocument::fromJson(lines[0]).object();
+    QCOMPARE(json.value("level").toString(), QString("info"));
+    QCOMPARE(json.value("module").toString(), QString("billing"));
+    QCOMPARE(json.value("message").toString(), QString("Платеж принят"));
+    QCOMPARE(json.value("fields").toObject().value("amount").toDouble(), 2500.5);
+    QCOMPARE(QJsonDocument::fromJson(lines[1]).object().value("level").toString(), QString("error"));
+#endif
+}
+
+void TestQtSpdlog::testThreadContext()
+{
+    using qt_spdlog::kv;
+    std::ostringstream textStream;
+    std::ostringstream jsonStream;
+    auto textSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(textStream);
+    auto jsonSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(jsonStream);
+    textSink->set_formatter(qt_spdlog::make_pattern_formatter("%v [%&]"));
+    jsonSink->set_formatter(std::make_unique<qt_spdlog::json_formatter>("\n"));
+    auto logger = std::make_shared<spdlog::logger>("context_app", spdlog::sinks_init_list{textSink, jsonSink});
+
+    auto backend = std::make_shared<qt_spdlog::async::backend>();
+    auto asyncLogger = std::make_shared<qt_spdlog::async::async_logger>(
+        "context_async", spdlog::sinks_init_list{textSink, jsonSink}, backend);
+
+    {
+        const QString requestId = "req 1";
+        auto requestContext = qt_spdlog::context(kv("request_id", requestId), kv("user", 42));
+        logger->info("outer");
+        {
+            // Внутренний ключ перекрывает внешний
+            auto stepContext = qt_spdlog::context(kv("user", "bob"));
+            logger->info("inner");
+        }
+        // Асинхронная запись выводится после выхода из области, но со своим контекстом
+        asyncLogger->info("async");
+    }
+    QVERIFY(qt_spdlog::mdc::empty());
+    QVERIFY(asyncLogger->flush_and_wait());
+    logger->info("none");
+
+    QCOMPARE(QString::fromStdString(textStream.str()),
+             QString("outer [request_id=\"req 1\" user=42]\n"
+                     "inner [request_id=\"req 1\" user=bob]\n"
+                     "async [request_id=\"req 1\" user=42]\n"
+                     "none []\n"));
+
+    QStringList lines = QString::fromStdString(jsonStream.str()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(lines.size(), 4);
+    QJsonObject inner = QJsonDocument::fromJson(lines[1].toUtf8()).object().value("context").toObject();
+    QCOMPARE(inner.value("request_id").toString(), QString("req 1"));
+    QCOMPARE(inner.value("user").toString(), QString("bob"));
+    QCOMPARE(QJsonDocument::fromJson(lines[2].toUtf8()).object().value("context").toObject().value("user").toInt(), 42);
+    QVERIFY(!QJsonDocument::fromJson(lines[3].toUtf8()).object().contains("context"));
+}
+
+void TestQtSpdlog::testContextPropagation()
+{
+    using qt_spdlog::kv;
+    std::ostringstream jsonStream;
+    auto jsonSink = std::make_shared<spdlog::sinks::ostream_sink_mt>(jsonStream);
+    jsonSink->set_formatter(std::make_unique<qt_spdlog::json_formatter>("\n"));
+    auto logger = std::make_shared<spdlog::logger>("pool_app", jsonSink);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    {
+        auto operation = qt_spdlog::begin_operation();
+        auto module = qt_spdlog::module("Import");
+        auto userContext = qt_spdlog::context(kv("user", 7));
+
+        auto future = qt_spdlog::run_with_context(&pool, [logger](int part) {
+            logger->info("part {}", part);
+            return qt_spdlog::get_current_module();
+        }, 1);
+        QCOMPARE(future.result(), QString("Import"));
+
+        pool.start(qt_spdlog::wrap([logger]() {
+            auto step = qt_spdlog::context(kv("step", "commit"));
+            logger->info("commit");
+        }));
+        QVERIFY(pool.waitForDone(5000));
+    }
+
+    // После задачи у потока пула нет чужого контекста
+    auto future = QtConcurrent::run(&pool, [logger]() {
+        logger->info("bare");
+        return qt_spdlog::mdc::empty();
+    });
+    QVERIFY(future.result());
+
+    QStringList lines = QString::fromStdString(jsonStream.str()).split('\n', Qt::SkipEmptyParts);
+    QCOMPARE(lines.size(), 3);
+    QJsonObject part = QJsonDocument::fromJson(lines[0].toUtf8()).object();
+    QCOMPARE(part.value("module").toString(), QString("Import"));
+    const qint64 correlationId = part.value("context").toObject().value("correlation_id").toInteger();
+    QVERIFY(correlationId > 0);
+    QCOMPARE(part.value("context").toObject().value("user").toInt(), 7);
+    QJsonObject commit = QJsonDocument::fromJson(lines[1].toUtf8()).object().value("context").toObject();
+    QCOMPARE(commit.value("correlation_id").toInteger(), correlationId);
+    QCOMPARE(commit.value("step").toString(), QString("commit"));
+    QCOMPARE(commit.value("user").toInt(), 7);
+    QJsonObject bare = QJsonDocument::fromJson(lines[2].toUtf8()).object();
+    QVERIFY(!bare.contains("context"));
+    QVERIFY(!bare.contains("module"));
 }
 
 void TestQtSpdlog::testMacroTrace()
@@ -317,5 +762,1086 @@ void TestQtSpdlog::testScopedLoggerLevel()
     QCOMPARE(testLogger->level(), originalLevel);
 }
 
-QTEST_APPLESS_MAIN(TestQtSpdlog)
+void TestQtSpdlog::testLevelParsing()
+{
+    // Разбор доступен на этапе компиляции
+    static_assert(qt_spdlog::is_valid_level("Critical"));
+    static_assert(qt_spdlog::level_name(spdlog::level::err) == "error");
+
+    spdlog::level::level_enum level = spdlog::level::info;
+    QVERIFY(qt_spdlog::parse_level("WARNING", level));
+    QCOMPARE(level, spdlog::level::warn);
+    QVERIFY(qt_spdlog::parse_level(QStringView(u"Debug"), level));
+    QCOMPARE(level, spdlog::level::debug);
+    QVERIFY(qt_spdlog::parse_level(QStringLiteral("always"), level));
+    QCOMPARE(level, spdlog::level::off);
+
+    // Неизвестное имя не меняет уровень
+    QVERIFY(!qt_spdlog::parse_level("warm", level));
+    QVERIFY(!qt_spdlog::parse_level("", level));
+    QCOMPARE(level, spdlog::level::off);
+    QVERIFY(!qt_spdlog::is_valid_level(QStringView(u"informational")));
+
+    QCOMPARE(qt_spdlog::string_to_level(QStringView(u"Error")), spdlog::level::err);
+    QCOMPARE(qt_spdlog::string_to_level("err"), spdlog::level::err); // через spdlog::level::from_str
+    QCOMPARE(qt_spdlog::level_to_string(spdlog::level::warn), QStringLiteral("warn"));
+    QCOMPARE(qt_spdlog::qt_to_spdlog_level(QtCriticalMsg), spdlog::level::err);
+
+    QCOMPARE(qt_spdlog::get_level_aliases(QStringLiteral("warn")), QStringList({"warning"}));
+    QCOMPARE(qt_spdlog::get_level_display_name(QStringLiteral("warning")), QStringLiteral("warn"));
+    QCOMPARE(qt_spdlog::get_available_levels(),
+             QStringList({"always", "critical", "debug", "error", "info", "off", "trace", "warn", "warning"}));
+}
+
+void TestQtSpdlog::testLevelSpec()
+{
+    QString error;
+    auto spec = qt_spdlog::levels::spec::parse("net=debug, net.*=trace, spec_db*=warn, d?_pool=error, info", &error);
+    QVERIFY2(spec, qPrintable(error));
+    // Точное имя, затем глоб с большим числом обычных символов
+    QCOMPARE(spec->level_for("net"), std::optional(spdlog::level::debug));
+    QCOMPARE(spec->level_for("net.http"), std::optional(spdlog::level::trace));
+    QCOMPARE(spec->level_for("spec_db_pool"), std::optional(spdlog::level::warn));
+    QCOMPARE(spec->level_for("db_pool"), std::optional(spdlog::level::err));
+    QCOMPARE(spec->level_for("network"), std::optional(spdlog::level::info));
+    QVERIFY(!qt_spdlog::levels::spec::parse("net=loud", &error));
+    QVERIFY(error.contains("net=loud"));
+
+    // Существующие логгеры реестра
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(testStream);
+    auto network = std::make_shared<spdlog::logger>("spec_net.http", sink);
+    auto other = std::make_shared<spdlog::logger>("spec_other", sink);
+    spdlog::register_logger(network);
+    spdlog::register_logger(other);
+    other->set_level(spdlog::level::info);
+    QVERIFY(qt_spdlog::set_level_spec("spec_net.*=trace,spec_late=error,spec_cat*=critical,spec_worker=debug"));
+    QCOMPARE(network->level(), spdlog::level::trace);
+    QCOMPARE(other->level(), spdlog::level::info);
+
+    // Логгеры, созданные позже: фабрика spdlog, категория Qt и thread-local клон
+    auto late = spdlog::create<spdlog::sinks::ostream_sink_mt>("spec_late", std::ref(testStream));
+    QCOMPARE(late->level(), spdlog::level::err);
+    QCOMPARE(qt_spdlog::categories::get_logger("spec_category")->level(), spdlog::level::critical);
+
+    spdlog::level::level_enum workerLevel = spdlog::level::off;
+    spdlog::level::level_enum workerLevelAfter = spdlog::level::off;
+    std::thread worker([&]() {
+        qt_spdlog::set_current_module("spec_worker");
+        workerLevel = qt_spdlog::get_thread_local_logger()->level();
+        // Смена спецификации доходит и до уже созданного логгера потока
+        qt_spdlog::set_level_spec("spec_worker=warn");
+        workerLevelAfter = qt_spdlog::get_thread_local_logger()->level();
+    });
+    worker.join();
+    QCOMPARE(workerLevel, spdlog::level::debug);
+    QCOMPARE(workerLevelAfter, spdlog::level::warn);
+
+    // Ошибка в спецификации ничего не меняет
+    QVERIFY(!qt_spdlog::set_level_spec("spec_net.*=loud"));
+    QCOMPARE(network->level(), spdlog::level::trace);
+
+    qt_spdlog::set_level_spec("");
+    qt_spdlog::categories::reset();
+    for (const char* name : {"spec_net.http", "spec_other", "spec_late"}) {
+        spdlog::drop(name);
+    }
+}
+
+void TestQtSpdlog::testLoggerHierarchy()
+{
+    // 10 сервисов x 10 модулей x 100 логгеров: "hier3.m5.l42"
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(testStream);
+    std::vector<std::shared_ptr<spdlog::logger>> loggers;
+    loggers.reserve(10000);
+    for (int i = 0; i < 10000; ++i) {
+        auto name = fmt::format("hier{}.m{}.l{}", i / 1000, i / 100 % 10, i % 100);
+        auto logger = std::make_shared<spdlog::logger>(name, sink);
+        logger->set_level(spdlog::level::info);
+        spdlog::register_logger(logger);
+        loggers.push_back(std::move(logger));
+    }
+    // Логгеры реестра подключаются к дереву при первой установке уровня префиксу
+    auto at = [&loggers](int service, int module, int index) {
+        return loggers[static_cast<std::size_t>(service * 1000 + module * 100 + index)]->level();
+    };
+
+    // Уровень префикса доходит до всех потомков, соседние поддеревья не меняются
+    qt_spdlog::hierarchy::set_level("hier3", spdlog::level::debug);
+    QCOMPARE(at(3, 0, 0), spdlog::level::debug);
+    QCOMPARE(at(3, 9, 99), spdlog::level::debug);
+    QCOMPARE(at(4, 0, 0), spdlog::level::info);
+    QCOMPARE(qt_spdlog::hierarchy::effective_level("hier3.m1.l1"), std::optional(spdlog::level::debug));
+
+    // Явный уровень потомка сильнее уровня предка; снятие возвращает исходный
+    qt_spdlog::hierarchy::set_level("hier3.m5", spdlog::level::err);
+    qt_spdlog::hierarchy::set_level("hier3", spdlog::level::trace);
+    QCOMPARE(at(3, 4, 10), spdlog::level::trace);
+    QCOMPARE(at(3, 5, 10), spdlog::level::err);
+    qt_spdlog::hierarchy::clear_level("hier3");
+    QCOMPARE(at(3, 4, 10), spdlog::level::info);
+    QCOMPARE(at(3, 5, 10), spdlog::level::err);
+    qt_spdlog::hierarchy::clear_level("hier3.m5");
+    QCOMPARE(at(3, 5, 10), spdlog::level::info);
+
+    // Спецификация уровней под явным уровнем дерева: после снятия логгер получает
+    // уровень спецификации, а не тот, что был до явного уровня
+    qt_spdlog::hierarchy::set_level("hier3", spdlog::level::debug);
+    QVERIFY(qt_spdlog::set_level_spec("hier3.m0.l0=error"));
+    QCOMPARE(at(3, 0, 0), spdlog::level::debug);
+    qt_spdlog::hierarchy::clear_level("hier3");
+    QCOMPARE(at(3, 0, 0), spdlog::level::err);
+    QCOMPARE(at(3, 0, 1), spdlog::level::info);
+    qt_spdlog::set_level_spec("");
+
+    // ScopedLoggerLevel по префиксу действует на поддерево
+    {
+        qt_spdlog::scoped::ScopedLoggerLevel scope("hier7.m2", spdlog::level::warn);
+        QCOMPARE(at(7, 2, 50), spdlog::level::warn);
+        QCOMPARE(at(7, 3, 50), spdlog::level::info);
+    }
+    QCOMPARE(at(7, 2, 50), spdlog::level::info);
+
+    // Логгер фабрики spdlog, не подключенный явно, тоже попадает под уровень префикса
+    auto factoryLogger = spdlog::create<spdlog::sinks::ostream_sink_mt>("hier9.factory.worker", std::ref(testStream));
+    factoryLogger->set_level(spdlog::level::info);
+    QVERIFY(!qt_spdlog::hierarchy::contains("hier9"));
+    {
+        qt_spdlog::scoped::ScopedLoggerLevel scope("hier9", spdlog::level::err);
+        QVERIFY(static_cast<bool>(scope));
+        QCOMPARE(factoryLogger->level(), spdlog::level::err);
+    }
+    QCOMPARE(factoryLogger->level(), spdlog::level::info);
+    spdlog::drop("hier9.factory.worker");
+
+    // Логгер, созданный позже, сразу получает уровень предка
+    qt_spdlog::hierarchy::set_level("hier8", spdlog::level::critical);
+    QCOMPARE(qt_spdlog::categories::get_logger("hier8.late")->level(), spdlog::level::critical);
+
+    // should_log подключенного логгера видит уровень предка
+    QVERIFY(!loggers[8500]->should_log(spdlog::level::err));
+    QVERIFY(loggers[8500]->should_log(spdlog::level::critical));
+
+    qt_spdlog::hierarchy::clear_level("hier8");
+    qt_spdlog::categories::reset();
+    for (const auto& logger : loggers) {
+        spdlog::drop(logger->name());
+    }
+}
+
+void TestQtSpdlog::testLoggerHandle()
+{
+    const qt_spdlog::logger_handle handle("handle_test");
+    QVERIFY(!handle.resolved());
+    QCOMPARE(handle.get(), spdlog::default_logger_raw());
+
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(testStream);
+    auto logger = std::make_shared<spdlog::logger>("handle_test", sink);
+    qt_spdlog::register_logger(logger);
+    QVERIFY(handle.resolved());
+    QCOMPARE(handle.get(), logger.get());
+    QCOMPARE(QT_SPDLOG_LOGGER("handle_test"), logger.get());
+
+    {
+        qt_spdlog::scoped::ScopedLoggerLevel scope(handle, spdlog::level::trace);
+        QCOMPARE(logger->level(), spdlog::level::trace);
+    }
+    QCOMPARE(logger->level(), spdlog::level::info);
+
+    // Прямой spdlog::drop не виден дескриптору до invalidate_logger_handles()
+    spdlog::drop("handle_test");
+    QCOMPARE(handle.get(), logger.get());
+    qt_spdlog::invalidate_logger_handles();
+    QCOMPARE(handle.get(), spdlog::default_logger_raw());
+
+    // Промах кэшируется: логгер из фабрики spdlog (без смены поколения) находится
+    // при плановой перепроверке или сразу после invalidate_logger_handles()
+    const qt_spdlog::logger_handle factoryHandle("handle_factory");
+    QVERIFY(!factoryHandle.resolved());
+    auto factoryLogger = spdlog::create<spdlog::sinks::ostream_sink_mt>("handle_factory", std::ref(testStream));
+    QVERIFY(!factoryHandle.resolved());
+    std::uint32_t calls = 1;
+    while (!factoryHandle.resolved() && calls <= qt_spdlog::handles::details::miss_recheck_calls) {
+        ++calls;
+    }
+    QVERIFY(factoryHandle.resolved());
+    QCOMPARE(factoryHandle.get(), factoryLogger.get());
+    spdlog::drop("handle_factory");
+    qt_spdlog::invalidate_logger_handles();
+    QVERIFY(!factoryHandle.resolved());
+    factoryLogger = spdlog::create<spdlog::sinks::ostream_sink_mt>("handle_factory", std::ref(testStream));
+    qt_spdlog::invalidate_logger_handles();
+    QVERIFY(factoryHandle.resolved());
+    qt_spdlog::drop("handle_factory");
+
+    // 32 потока разрешают имя в цикле, пока логгер удаляется и регистрируется заново;
+    // ненайденное имя все время дает логгер по умолчанию
+    const qt_spdlog::logger_handle missingHandle("handle_missing");
+    const int THREADS = 32;
+    std::atomic<bool> running{true};
+    std::atomic<int> unexpected{0};
+    std::atomic<int> resolvedCount{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&]() {
+            while (running.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 1000; ++i) {
+                    spdlog::logger* current = handle.get();
+                    if (current == logger.get()) {
+                        resolvedCount.fetch_add(1, std::memory_order_relaxed);
+                    } else if (current != spdlog::default_logger_raw()) {
+                        unexpected.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    if (missingHandle.get() != spdlog::default_logger_raw()) {
+                        unexpected.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 50; ++i) {
+        qt_spdlog::register_logger(logger);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        qt_spdlog::drop("handle_test");
+    }
+    qt_spdlog::register_logger(logger);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    running = false;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    QCOMPARE(unexpected.load(), 0);
+    QVERIFY(resolvedCount.load() > 0);
+    QCOMPARE(handle.get(), logger.get());
+
+    qt_spdlog::drop("handle_test");
+}
+
+void TestQtSpdlog::testCompiledPattern()
+{
+    using qt_spdlog::CompiledPattern;
+    using qt_spdlog::patterns::layout;
+
+    // Ошибки обнаруживаются при разборе, а не печатаются как текст
+    QString error;
+    QVERIFY(!CompiledPattern::compile(QStringLiteral("[%Q] %v"), &error));
+    QVERIFY(error.contains("%Q"));
+    QVERIFY(!CompiledPattern::compile(QStringLiteral("%v %")));
+    QVERIFY(!CompiledPattern::compile(QStringLiteral("%99v")));
+    QVERIFY(CompiledPattern::compile(QStringLiteral("%-8l %5!n [%!] %&")));
+
+    QCOMPARE(qt_spdlog::patterns::MESSAGE.layout(), layout::message_only);
+    QCOMPARE(qt_spdlog::patterns::DEFAULT.layout(), layout::general);
+    QCOMPARE(CompiledPattern::compile(QStringLiteral("[app] 100%% %v"))->layout(), layout::prefix_message);
+    QCOMPARE(CompiledPattern::compile(QStringLiteral("%v!"))->layout(), layout::general);
+
+    // Быстрые пути пишут то же, что pattern_formatter
+    spdlog::details::log_msg msg("pattern_test", spdlog::level::info, "hello");
+    for (const char* pattern : {"%v", "[app] 100%% %v"}) {
+        spdlog::memory_buf_t fast;
+        spdlog::memory_buf_t reference;
+        CompiledPattern::compile(QString(pattern))->make_formatter()->format(msg, fast);
+        qt_spdlog::make_pattern_formatter(pattern)->format(msg, reference);
+        QCOMPARE(std::string(fast.data(), fast.size()), std::string(reference.data(), reference.size()));
+    }
+
+    // Смена общего паттерна во время записи: каждая строка целиком в одном из форматов
+    std::ostringstream output;
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(output);
+    auto logger = std::make_shared<spdlog::logger>("pattern_test", sink);
+    spdlog::register_logger(logger);
+    const auto first = CompiledPattern::compile(QStringLiteral("A %v"));
+    const auto second = CompiledPattern::compile(QStringLiteral("B [%l] %v"));
+    QVERIFY(qt_spdlog::set_pattern(*first));
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&]() {
+            while (running.load(std::memory_order_relaxed)) {
+                logger->info("msg");
+            }
+        });
+    }
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(qt_spdlog::set_pattern(i % 2 ? *second : *first));
+    }
+    running = false;
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    std::istringstream lines(output.str());
+    std::string line;
+    while (std::getline(lines, line)) {
+        QVERIFY2(line == "A msg" || line == "B [info] msg", line.c_str());
+    }
+    QVERIFY(!qt_spdlog::set_pattern(QStringLiteral("%Q")));
+
+    // Свой formatter sink'а действует до следующего общего set_pattern
+    logger->set_pattern("own %v");
+    output.str("");
+    logger->info("one");
+    QVERIFY(qt_spdlog::set_pattern(*second));
+    logger->info("two");
+    QCOMPARE(QString::fromStdString(output.str()), QString("own one\nB [info] two\n"));
+
+    // Логгер из фабрики после установки получает текущий паттерн, следующий - без реестра
+    std::ostringstream factoryOutput;
+    auto factoryLogger = spdlog::create<spdlog::sinks::ostream_sink_mt>("pattern_factory", std::ref(factoryOutput));
+    factoryLogger->set_level(spdlog::level::info);
+    QVERIFY(qt_spdlog::set_pattern(*second));
+    factoryLogger->info("one");
+    QVERIFY(qt_spdlog::set_pattern(*first));
+    factoryLogger->info("two");
+    QCOMPARE(QString::fromStdString(factoryOutput.str()), QString("B [info] one\nA two\n"));
+    spdlog::drop("pattern_factory");
+
+    QVERIFY(qt_spdlog::set_pattern(qt_spdlog::patterns::MESSAGE));
+    spdlog::drop("pattern_test");
+}
+
+void TestQtSpdlog::testTimestamps()
+{
+    using qt_spdlog::timestamps::source;
+
+    // Дата и время из общего кэша пишутся так же, как флагами pattern_formatter
+    const char* pattern = "%Y-%m-%d %H:%M:%S.%e [%T] %v";
+    const auto compiled = qt_spdlog::CompiledPattern::compile(QString(pattern));
+    QVERIFY(compiled);
+    auto cachedFormatter = compiled->make_formatter();
+    auto referenceFormatter = qt_spdlog::make_pattern_formatter(pattern);
+    for (int hours = 0; hours < 3; ++hours) {
+        spdlog::details::log_msg msg(spdlog::log_clock::now() + std::chrono::hours(hours), spdlog::source_loc{},
+                                     "timestamp_test", spdlog::level::info, "hello");
+        spdlog::memory_buf_t cached;
+        spdlog::memory_buf_t reference;
+        cachedFormatter->format(msg, cached);
+        referenceFormatter->format(msg, reference);
+        QCOMPARE(std::string(cached.data(), cached.size()), std::string(reference.data(), reference.size()));
+    }
+
+    // Каждый доступный источник близок к system_clock
+    for (source value : {source::realtime, source::realtime_coarse, source::tsc}) {
+        if (!qt_spdlog::timestamps::set_source(value)) {
+            continue;
+        }
+        QCOMPARE(qt_spdlog::timestamps::current_source(), value);
+        const auto difference = qt_spdlog::timestamps::now() - spdlog::log_clock::now();
+        QVERIFY(std::chrono::abs(difference) < std::chrono::milliseconds(50));
+    }
+
+    // json_formatter берет timestamp из времени записи spdlog - одно чтение часов
+    auto sink = std::make_shared<TimeSink>();
+    auto logger = std::make_shared<spdlog::logger>("timestamp_test", sink);
+    auto previous = spdlog::default_logger();
+    spdlog::set_default_logger(logger);
+    qt_spdlog::json::json_log(spdlog::level::info, QStringLiteral("event"));
+    QT_LOG_INFO("text {}", 1);
+    spdlog::set_default_logger(previous);
+    qt_spdlog::timestamps::set_source(source::realtime);
+
+    QCOMPARE(sink->times.size(), std::size_t(2));
+    QCOMPARE(sink->payloads[0], std::string("event"));
+    QCOMPARE(sink->payloads[1], std::string("text 1"));
+}
+
+void TestQtSpdlog::testTscTimestamps()
+{
+    using qt_spdlog::timestamps::source;
+
+    // Без инвариантного TSC источник не меняется
+    if (!qt_spdlog::timestamps::is_available(source::tsc)) {
+        QVERIFY(!qt_spdlog::timestamps::set_source(source::tsc));
+        QCOMPARE(qt_spdlog::timestamps::current_source(), source::realtime);
+        QSKIP("Нет инвариантного TSC");
+    }
+
+    // Частая перекалибровка, чтобы замер пересек несколько эпох
+    QVERIFY(qt_spdlog::timestamps::set_source(source::tsc, std::chrono::milliseconds(20), std::chrono::milliseconds(2)));
+    const auto captured = qt_spdlog::timestamps::capture();
+    QVERIFY(captured.ticks != 0);
+    const auto capturedAt = spdlog::log_clock::now();
+
+    // Под гипервизором TSC виртуальных процессоров может расходиться, поэтому порядок
+    // меток между потоками проверяется только без него (CPUID.1:ECX, бит 31)
+    bool virtualized = false;
+#if defined(_MSC_VER)
+    int registers[4] = {};
+    __cpuid(registers, 1);
+    virtualized = (static_cast<unsigned>(registers[2]) & (1u << 31)) != 0;
+#elif defined(QT_SPDLOG_HAS_TSC)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    virtualized = __get_cpuid(1u, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 31)) != 0;
+#endif
+
+    // Два потока по очереди снимают метку сразу после того, как увидели метку
+    // другого потока: с синхронным TSC и непрерывными эпохами она не меньше
+    const int ROUNDS = 20000;
+    std::atomic<std::int64_t> last{0};
+    std::atomic<int> turn{0};
+    int violations[2] = {0, 0};
+    auto player = [&](int self) {
+        for (int i = 0; i < ROUNDS; ++i) {
+            while (turn.load(std::memory_order_acquire) != self) {
+                std::this_thread::yield();
+            }
+            const std::int64_t previous = last.load(std::memory_order_relaxed);
+            const std::int64_t mine = qt_spdlog::timestamps::now().time_since_epoch().count();
+            if (mine < previous) {
+                ++violations[self];
+            }
+            last.store(mine, std::memory_order_relaxed);
+            turn.store(1 - self, std::memory_order_release);
+        }
+    };
+    std::thread first(player, 0);
+    std::thread second(player, 1);
+    first.join();
+    second.join();
+    if (!virtualized) {
+        QCOMPARE(violations[0] + violations[1], 0);
+    }
+
+    // После перекалибровок метка близка к системным часам, а такты, снятые до них,
+    // переводятся по своей эпохе. Запас - на вытеснение потока между двумя чтениями
+    const auto drift = qt_spdlog::timestamps::now() - spdlog::log_clock::now();
+    QVERIFY(std::chrono::abs(drift) < std::chrono::milliseconds(50));
+    const auto convertedDrift = qt_spdlog::timestamps::to_time(captured) - capturedAt;
+    QVERIFY(std::chrono::abs(convertedDrift) < std::chrono::milliseconds(50));
+
+    QVERIFY(qt_spdlog::timestamps::set_source(source::realtime));
+}
+
+void TestQtSpdlog::testQtMessageHandler()
+{
+    testStream.str("");
+    testLogger->set_pattern("%v|%s|%#|%!");
+    qt_spdlog::setup_qt_message_handler(true);
+
+    // Контекст Qt становится source_loc, категория - префиксом
+    QMessageLogger("src/widget.cpp", 42, "void Widget::paint()", "qt.widgets").warning("Перерисовка %d", 7);
+    QCOMPARE(QString::fromStdString(testStream.str()).trimmed(),
+             QString("[qt.widgets] Перерисовка 7|widget.cpp|42|void Widget::paint()"));
+
+    // Категория default не добавляется, отброшенные по уровню не форматируются
+    testStream.str("");
+    testLogger->set_level(spdlog::level::info);
+    QMessageLogger("main.cpp", 7, "main", "default").debug("скрыто");
+    QMessageLogger("main.cpp", 8, "main", "default").info("видно");
+    QCOMPARE(QString::fromStdString(testStream.str()).trimmed(), QString("видно|main.cpp|8|main"));
+
+    qInstallMessageHandler(nullptr);
+    testLogger->set_level(spdlog::level::trace);
+    testLogger->set_pattern("%v");
+}
+
+void TestQtSpdlog::testQtCategoryBridge()
+{
+    testStream.str("");
+    qt_spdlog::setup_qt_category_bridge(true);
+
+    // Категория получает свой логгер с именем категории и sink'ами логгера по умолчанию
+    auto logger = qt_spdlog::categories::get_logger("test.network");
+    QCOMPARE(QString::fromStdString(logger->name()), QString("test.network"));
+    QCOMPARE(logger->sinks().front(), testSink);
+
+    // Уровень логгера управляет встроенной проверкой Qt
+    qt_spdlog::categories::set_level("test.network", spdlog::level::warn);
+    QVERIFY(!lcTestNetwork().isDebugEnabled());
+    QVERIFY(!lcTestNetwork().isInfoEnabled());
+    QVERIFY(lcTestNetwork().isWarningEnabled());
+
+    qCDebug(lcTestNetwork) << "отброшено Qt";
+    qCWarning(lcTestNetwork, "сетевое предупреждение");
+    QCOMPARE(QString::fromStdString(testStream.str()).trimmed(), QString("сетевое предупреждение"));
+
+    qt_spdlog::categories::set_level("test.network", spdlog::level::debug);
+    QVERIFY(lcTestNetwork().isDebugEnabled());
+
+    // Имя динамической категории по прежнему адресу - уже другая категория
+    char dynamicName[32];
+    std::strcpy(dynamicName, "test.dynamic.first");
+    QCOMPARE(qt_spdlog::categories::logger_for(dynamicName)->name(), std::string("test.dynamic.first"));
+    std::strcpy(dynamicName, "test.dynamic.second");
+    QCOMPARE(qt_spdlog::categories::logger_for(dynamicName)->name(), std::string("test.dynamic.second"));
+
+    qt_spdlog::categories::uninstall();
+    qt_spdlog::categories::reset();
+    qInstallMessageHandler(nullptr);
+}
+
+void TestQtSpdlog::testQtHandlerReentrancy()
+{
+    auto sink = std::make_shared<ReentrantSink>();
+    auto logger = std::make_shared<spdlog::logger>("reentrant", sink);
+    spdlog::set_default_logger(logger);
+    qt_spdlog::setup_qt_message_handler(true);
+
+    // Без защиты повторный вход зациклился бы или заблокировался на мьютексе sink'а
+    qWarning("внешнее предупреждение");
+    QCOMPARE(sink->records, 1);
+
+    qInstallMessageHandler(nullptr);
+    spdlog::set_default_logger(testLogger);
+}
+
+void TestQtSpdlog::testAsyncQtMessageHandler()
+{
+    auto backend = std::make_shared<qt_spdlog::async::backend>();
+    std::ostringstream asyncStream;
+    auto logger = std::make_shared<qt_spdlog::async::async_logger>(
+        "async_qt", std::make_shared<spdlog::sinks::ostream_sink_mt>(asyncStream), backend);
+    logger->set_pattern("%v|%s|%#");
+    logger->set_level(spdlog::level::info);
+    spdlog::set_default_logger(logger);
+    qt_spdlog::async::setup_qt_message_handler(true);
+
+    QMessageLogger("src/view.cpp", 17, "void View::show()", "qt.gui").warning("асинхронно %d", 1);
+    QMessageLogger("src/view.cpp", 18, "void View::show()", "qt.gui").debug("ниже уровня");
+
+    // Запись выполняет backend; flush_and_wait дожидается ее
+    QVERIFY(logger->flush_and_wait());
+    QCOMPARE(QString::fromStdString(asyncStream.str()).trimmed(), QString("[qt.gui] асинхронно 1|view.cpp|17"));
+    QCOMPARE(logger->stats().processed, quint64(1));
+
+    qInstallMessageHandler(nullptr);
+    spdlog::set_default_logger(testLogger);
+}
+
+void TestQtSpdlog::testContextWindow()
+{
+    testStream.str("");
+    testLogger->set_level(spdlog::level::info);
+    qt_spdlog::enable_context_window(4);
+
+    // Отброшенные по уровню записи не выводятся, но попадают в окно
+    for (int i = 0; i < 6; ++i) {
+        QT_LOG_DEBUG("debug {}", i);
+    }
+    QCOMPARE(QString::fromStdString(testStream.str()), QString());
+
+    // Ошибка выводит последние 4 записи перед собой
+    QT_LOG_ERROR("error {}", QString("happened"));
+
+    QString output = QString::fromStdString(testStream.str());
+    QVERIFY(!output.contains("debug 1"));
+    QVERIFY(output.contains("debug 2"));
+    QVERIFY(output.contains("debug 5"));
+    QVERIFY(output.indexOf("debug 5") < output.indexOf("error happened"));
+
+    // После дампа окно пустое: маркеры контекста тоже не выводятся
+    testStream.str("");
+    QT_LOG_ERROR("second error");
+    QVERIFY(!QString::fromStdString(testStream.str()).contains("debug"));
+    QVERIFY(!QString::fromStdString(testStream.str()).contains("Контекст ошибки"));
+
+    // Записи другого логгера не попадают в дамп чужой ошибки
+    std::ostringstream otherStream;
+    auto otherLogger = std::make_shared<spdlog::logger>(
+        "context_other", std::make_shared<spdlog::sinks::ostream_sink_mt>(otherStream));
+    otherLogger->set_pattern("%v");
+    otherLogger->set_level(spdlog::level::info);
+    const char localBuffer[] = "other debug";
+    QT_LOGGER_DEBUG(otherLogger, localBuffer);
+    testStream.str("");
+    QT_LOG_ERROR("third error");
+    QVERIFY(!QString::fromStdString(testStream.str()).contains("other debug"));
+    QT_LOGGER_ERROR(otherLogger, "other error");
+    QVERIFY(QString::fromStdString(otherStream.str()).contains("other debug"));
+
+    qt_spdlog::disable_context_window();
+    testStream.str("");
+    QT_LOG_DEBUG("debug after disable");
+    QT_LOG_ERROR("error after disable");
+    QCOMPARE(QString::fromStdString(testStream.str()).trimmed(), QString("error after disable"));
+
+    testLogger->set_level(spdlog::level::trace);
+}
+
+void TestQtSpdlog::testAsyncMetrics()
+{
+    qt_spdlog::async::backend_options options;
+    options.queue_size = 16;
+    options.batch_size = 4;
+    auto backend = std::make_shared<qt_spdlog::async::backend>(options);
+
+    std::ostringstream asyncStream;
+    auto sink = std::make_shared<qt_spdlog::async::instrumented_sink>(
+        std::make_shared<spdlog::sinks::ostream_sink_mt>(asyncStream));
+    auto logger = std::make_shared<qt_spdlog::async::async_logger>(
+        "async_test", sink, backend, qt_spdlog::async::overflow_policy::discard_new);
+    logger->set_pattern("%v");
+
+    const int total = 1000;
+    for (int i = 0; i < total; ++i) {
+        logger->info("record {}", i);
+    }
+
+    // Каждая запись либо поставлена в очередь, либо учтена как отброшенная
+    auto stats = logger->stats();
+    QCOMPARE(stats.enqueued + stats.dropped, quint64(total));
+    QVERIFY(stats.enqueued > 0);
+
+    QTRY_COMPARE(logger->stats().processed, logger->stats().enqueued);
+    QTRY_COMPARE(sink->stats().records, logger->stats().processed);
+
+    auto backendStats = backend->stats();
+    QVERIFY(backendStats.queue_high_water <= backendStats.queue_capacity);
+    QVERIFY(backendStats.max_batch_size <= options.batch_size);
+
+    // QObject-обертка публикует те же значения через свойства
+    qt_spdlog::AsyncMetrics metrics(backend);
+    metrics.addLogger(logger);
+    metrics.refresh();
+    QCOMPARE(metrics.property("enqueued").toULongLong(), logger->stats().enqueued);
+    QCOMPARE(metrics.property("dropped").toULongLong(), logger->stats().dropped);
+    QCOMPARE(metrics.property("queueCapacity").toULongLong(), quint64(options.queue_size));
+}
+
+void TestQtSpdlog::testAsyncPriorityLanes()
+{
+    auto options = qt_spdlog::async::backend_options::priority_lanes(64);
+    options.batch_size = 8;
+    auto backend = std::make_shared<qt_spdlog::async::backend>(options);
+
+    std::ostringstream asyncStream;
+    auto logger = std::make_shared<qt_spdlog::async::async_logger>(
+        "async_lanes", std::make_shared<spdlog::sinks::ostream_sink_mt>(asyncStream), backend,
+        qt_spdlog::async::overflow_policy::overrun_oldest);
+    logger->set_pattern("%l %v");
+    logger->set_level(spdlog::level::trace);
+
+    // Отладочная полоса переполнена, ошибки идут через свою полосу
+    const int noiseThreads = 4;
+    const int errorThreads = 2;
+    const int errorsPerThread = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < noiseThreads; ++t) {
+        threads.emplace_back([&logger] {
+            for (int i = 0; i < 20000; ++i) {
+                logger->debug("noise {}", i);
+            }
+        });
+    }
+    for (int t = 0; t < errorThreads; ++t) {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < errorsPerThread; ++i) {
+                logger->error("{} {}", t, i);
+            }
+            logger->log(spdlog::level::off, "always {}", t);
+        });
+    }
+    // flush стоит в младшей полосе вместе с вытесняемыми записями, но сам не вытесняется
+    std::atomic<int> failedFlushes{0};
+    threads.emplace_back([&logger, &failedFlushes] {
+        for (int i = 0; i < 50; ++i) {
+            if (!logger->flush_and_wait()) {
+                ++failedFlushes;
+            }
+        }
+    });
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    QCOMPARE(failedFlushes.load(), 0);
+
+    // Уничтожение backend дожидается обработки всех полос
+    backend.reset();
+
+    // Отладочные записи вытеснялись, ошибки - нет
+    QVERIFY(logger->stats().dropped > 0);
+
+    std::istringstream lines(asyncStream.str());
+    std::string line;
+    std::vector<int> expected(errorThreads, 0);
+    int errors = 0;
+    int always = 0;
+    quint64 noise = 0;
+    while (std::getline(lines, line)) {
+        if (line.rfind("debug ", 0) == 0) {
+            ++noise;
+        } else if (line.rfind("error ", 0) == 0) {
+            int thread = 0;
+            int index = 0;
+            QCOMPARE(std::sscanf(line.c_str() + 6, "%d %d", &thread, &index), 2);
+            // Порядок записей одного потока внутри полосы сохраняется
+            QCOMPARE(index, expected[thread]++);
+            ++errors;
+        } else if (line.find("always") != std::string::npos) {
+            ++always;
+        }
+    }
+    QCOMPARE(errors, errorThreads * errorsPerThread);
+    QCOMPARE(always, errorThreads);
+    // Отброшены только отладочные записи
+    QCOMPARE(noise + logger->stats().dropped, quint64(noiseThreads * 20000));
+}
+
+void TestQtSpdlog::testLatencyHistogram()
+{
+    // Ячейки: 64 на октаву, погрешность значения до 1/64; процентили по рангу
+    qt_spdlog::latency::histogram values;
+    for (int value = 1; value <= 100000; ++value) {
+        values.record(static_cast<std::uint64_t>(value));
+    }
+    QCOMPARE(values.count(), std::uint64_t(100000));
+    QVERIFY(std::abs(values.percentile(50) - 50000) <= 50000.0 / 64);
+    QVERIFY(std::abs(values.percentile(99) - 99000) <= 99000.0 / 64);
+    QCOMPARE(values.percentile(100), 100000.0);
+    QCOMPARE(values.max(), 100000.0);
+
+    // Гистограммы потоков сводятся при чтении
+    qt_spdlog::latency::recorder recorder;
+    const int THREADS = 8;
+    const int CALLS = 10000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&recorder] {
+            for (int call = 0; call < CALLS; ++call) {
+                qt_spdlog::latency::recorder::scope timer(recorder);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // Потоки завершились: их гистограммы уже в общей сумме recorder'а
+    const auto merged = recorder.snapshot();
+    QCOMPARE(merged.count(), std::uint64_t(THREADS * CALLS));
+    QVERIFY(merged.percentile(50) <= merged.percentile(99.9));
+    QVERIFY(merged.percentile(99.9) <= merged.max());
+    recorder.reset();
+    QCOMPARE(recorder.snapshot().count(), std::uint64_t(0));
+
+    // Поток, переживший recorder, при выходе его не трогает
+    {
+        std::promise<void> recorded;
+        std::promise<void> destroyed;
+        auto shortLived = std::make_unique<qt_spdlog::latency::recorder>();
+        std::thread worker([&] {
+            shortLived->record_ticks(100);
+            recorded.set_value();
+            destroyed.get_future().wait();
+        });
+        recorded.get_future().wait();
+        QCOMPARE(shortLived->snapshot().count(), std::uint64_t(1));
+        shortLived.reset();
+        destroyed.set_value();
+        worker.join();
+    }
+
+    // Замер макросов: только вызовы, прошедшие проверку уровня
+    auto logging = qt_spdlog::latency::get("qt_spdlog.log");
+    logging->reset();
+    qt_spdlog::latency::instrument_logging(true);
+    for (int i = 0; i < 100; ++i) {
+        QT_LOG_INFO("Замер {}", i);
+    }
+    // Остальные семейства макросов замеряются так же, по одному разу
+    QT_LOG_INFO_KV("Замер", kv("id", 1));
+    QT_LOG_INFO_JSON("Замер", QVariantMap{{"id", 1}});
+    QT_LOG_INFO_LOCATION();
+    QT_LOG_INFO_LOCATION_MSG("Замер");
+    QT_LOG_ALWAYS("Замер");
+    QT_LOG_EXCEPTION_ERROR(std::runtime_error("Замер"), "тест");
+    testLogger->set_level(spdlog::level::warn);
+    QT_LOG_INFO("Отфильтровано");
+    QT_LOG_INFO_KV("Отфильтровано", kv("id", 1));
+    QT_LOG_INFO_LOCATION();
+    testLogger->set_level(spdlog::level::trace);
+    qt_spdlog::latency::instrument_logging(false);
+    QT_LOG_INFO("Без замера");
+    testStream.str("");
+
+    QCOMPARE(logging->snapshot().count(), std::uint64_t(106));
+    QVERIFY(qt_spdlog::latency::report().find("qt_spdlog.log: count=106 ") != std::string::npos);
+}
+
+void TestQtSpdlog::testSocketSink()
+{
+#if defined(_WIN32) || !defined(QT_SPDLOG_COLLECTOR_PATH)
+    QSKIP("Сокетный sink и qt_spdlog_collector доступны только в POSIX сборке");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString socketPath = dir.filePath("collector.sock");
+
+    qt_spdlog::sinks::socket_sink_options options;
+    options.transport = qt_spdlog::sinks::socket_transport::unix_stream;
+    options.address = socketPath.toStdString();
+    options.batch_records = 10;
+    // Ровно две пачки "record 50".."record 69" (по 10 байт на запись)
+    options.spill_bytes = 200;
+    options.min_backoff = std::chrono::milliseconds(10);
+    auto sink = std::make_shared<qt_spdlog::sinks::socket_sink_mt>(options);
+    spdlog::logger logger("socket_test", sink);
+    logger.set_pattern("%v");
+
+    // Приемника еще нет: полные пачки уходят в буфер
+    for (int i = 0; i < 25; ++i) {
+        logger.info("record {}", i);
+    }
+    auto stats = sink->stats();
+    QCOMPARE(stats.records_sent, quint64(0));
+    QCOMPARE(stats.records_spilled, quint64(20));
+    QVERIFY(!stats.connected);
+
+    QProcess collector;
+    collector.start(QT_SPDLOG_COLLECTOR_PATH, {"--unix", socketPath, "--count", "50"});
+    QVERIFY(collector.waitForStarted());
+    QVERIFY(collector.waitForReadyRead());
+    QVERIFY(collector.readAllStandardOutput().startsWith("ready"));
+
+    // После паузы переподключения буфер отправляется первым
+    QTest::qWait(50);
+    for (int i = 25; i < 50; ++i) {
+        logger.info("record {}", i);
+    }
+    logger.flush();
+
+    QVERIFY(collector.waitForFinished());
+    QVERIFY(collector.readAllStandardOutput().startsWith("records 50 "));
+
+    stats = sink->stats();
+    QCOMPARE(stats.records_sent, quint64(50));
+    QCOMPARE(stats.records_spilled, quint64(0));
+    QCOMPARE(stats.records_dropped, quint64(0));
+    QCOMPARE(stats.connects, quint64(1));
+
+    // Второй разрыв: отправленные после первого пачки не занимают буфер,
+    // поэтому две новые пачки помещаются в него целиком
+    for (int i = 50; i < 75; ++i) {
+        logger.info("record {}", i);
+    }
+    stats = sink->stats();
+    QCOMPARE(stats.records_sent, quint64(50));
+    QCOMPARE(stats.records_spilled, quint64(20));
+    QCOMPARE(stats.records_dropped, quint64(0));
+    QVERIFY(!stats.connected);
+
+    collector.start(QT_SPDLOG_COLLECTOR_PATH, {"--unix", socketPath, "--count", "25"});
+    QVERIFY(collector.waitForStarted());
+    QVERIFY(collector.waitForReadyRead());
+    QVERIFY(collector.readAllStandardOutput().startsWith("ready"));
+
+    QTest::qWait(100);
+    logger.flush();
+
+    QVERIFY(collector.waitForFinished());
+    QVERIFY(collector.readAllStandardOutput().startsWith("records 25 "));
+
+    stats = sink->stats();
+    QCOMPARE(stats.records_sent, quint64(75));
+    QCOMPARE(stats.records_spilled, quint64(0));
+    QCOMPARE(stats.records_dropped, quint64(0));
+    QCOMPARE(stats.connects, quint64(2));
+#endif
+}
+
+void TestQtSpdlog::testSocketSinkDatagram()
+{
+#ifdef _WIN32
+    QSKIP("Сокетный sink доступен только в POSIX сборке");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const std::string socketPath = dir.filePath("collector.dgram").toStdString();
+
+    int receiver = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    QVERIFY(receiver >= 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    QCOMPARE(::bind(receiver, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+
+    qt_spdlog::sinks::socket_sink_options options;
+    options.transport = qt_spdlog::sinks::socket_transport::unix_datagram;
+    options.address = socketPath;
+    options.batch_bytes = 1024 * 1024;
+    options.batch_records = 3;
+    auto sink = std::make_shared<qt_spdlog::sinks::socket_sink_mt>(options);
+    spdlog::logger logger("socket_dgram_test", sink);
+    logger.set_pattern("%v");
+
+    // Пачка больше предела датаграммы делится, запись больше предела отбрасывается
+    logger.info("small 0");
+    logger.info(std::string(400 * 1024, 'x'));
+    logger.info("small 1");
+
+    auto stats = sink->stats();
+    QCOMPARE(stats.records_sent, quint64(2));
+    QCOMPARE(stats.records_dropped, quint64(1));
+    QCOMPARE(stats.records_spilled, quint64(0));
+
+    char buffer[64];
+    for (const char* expected : {"small 0", "small 1"}) {
+        ssize_t received = ::recv(receiver, buffer, sizeof(buffer), MSG_DONTWAIT);
+        QVERIFY(received > 0);
+        QCOMPARE(std::string(buffer, static_cast<std::size_t>(received)).substr(0, 7), std::string(expected));
+    }
+    ::close(receiver);
+#endif
+}
+
+void TestQtSpdlog::testConfigParsing()
+{
+    QString error;
+    auto config = qt_spdlog::config::parse_ini(
+        "; комментарий\n"
+        "pattern = [%T, %l] %v\n"
+        "[sink.console]\n"
+        "type = stdout\n"
+        "[sink.file]\n"
+        "type = rotating\n"
+        "path = \"app.log\"\n"
+        "max_files = 5\n"
+        "[logger.network]\n"
+        "level = Debug\n"
+        "sinks = console, file\n", &error);
+    QVERIFY2(config, qPrintable(error));
+    // Запятая в pattern не делит значение (в отличие от QSettings)
+    QCOMPARE(config->pattern, QStringLiteral("[%T, %l] %v"));
+    QCOMPARE(config->sinks.value("file").path, QStringLiteral("app.log"));
+    QCOMPARE(config->sinks.value("file").max_files, std::size_t(5));
+    QCOMPARE(config->loggers.size(), std::size_t(1));
+    QCOMPARE(config->loggers[0].level, std::optional(spdlog::level::debug));
+    QCOMPARE(config->loggers[0].sinks, QStringList({"console", "file"}));
+
+    QVERIFY(!qt_spdlog::config::parse_json(R"({"loggers": {"a": {"sinks": ["missing"]}}})", &error));
+    QVERIFY(error.contains("missing"));
+    QVERIFY(!qt_spdlog::config::parse_json(R"({"level": "loud"})", &error));
+    QVERIFY(!qt_spdlog::config::parse_json("{\"level\": ", &error));
+}
+
+void TestQtSpdlog::testConfigReload()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString configPath = dir.filePath("logging.json");
+    auto writeConfig = [&](const QByteArray& data) {
+        QFile file(configPath);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(data);
+    };
+
+    writeConfig(R"({"sinks": {"file": {"type": "file", "path": "out.log", "pattern": "%n %l %v"}},
+                    "loggers": {"config_test": {"level": "debug", "sinks": ["file"]}}})");
+    qt_spdlog::config::ConfigWatcher watcher(configPath);
+    QVERIFY2(watcher.lastError().isEmpty(), qPrintable(watcher.lastError()));
+    QCOMPARE(watcher.generation(), quint64(1));
+
+    auto logger = spdlog::get("config_test");
+    QVERIFY(logger);
+    QCOMPARE(logger->level(), spdlog::level::debug);
+    auto sink = std::dynamic_pointer_cast<qt_spdlog::config::reloadable_sink>(logger->sinks().front());
+    QVERIFY(sink);
+    const auto fileSink = sink->sinks()->front();
+    logger->debug("one");
+
+    // Новый уровень и pattern, sink файла переиспользуется
+    writeConfig(R"({"sinks": {"file": {"type": "file", "path": "out.log", "pattern": "%l|%v"}},
+                    "loggers": {"config_test": {"level": "warn", "sinks": ["file"]}}})");
+    QVERIFY(watcher.reload());
+    QCOMPARE(watcher.generation(), quint64(2));
+    QCOMPARE(logger->level(), spdlog::level::warn);
+    QCOMPARE(sink->sinks()->front(), fileSink);
+    logger->info("hidden");
+    logger->warn("two");
+
+    // Запись не ждет перезагрузок и не теряется при замене набора sink'ов
+    constexpr int threads = 4;
+    constexpr int perThread = 500;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&]() {
+            for (int i = 0; i < perThread; ++i) {
+                logger->warn("concurrent");
+            }
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(watcher.reload());
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    // Файл с ошибкой не применяется
+    writeConfig(R"({"loggers": {"config_test": {"level": "trace")");
+    QVERIFY(!watcher.reload());
+    QVERIFY(!watcher.lastError().isEmpty());
+    QCOMPARE(watcher.generation(), quint64(22));
+    QCOMPARE(logger->level(), spdlog::level::warn);
+
+    logger->flush();
+    QFile output(dir.filePath("out.log"));
+    QVERIFY(output.open(QIODevice::ReadOnly));
+    const QList<QByteArray> lines = output.readAll().trimmed().split('\n');
+    QCOMPARE(lines.size(), qsizetype(2 + threads * perThread));
+    QCOMPARE(lines[0], QByteArray("config_test debug one"));
+    QCOMPARE(lines[1], QByteArray("warning|two"));
+    QCOMPARE(lines.count(QByteArray("warning|concurrent")), qsizetype(threads * perThread));
+
+    spdlog::drop("config_test");
+}
+
+void TestQtSpdlog::testConfigWatcher()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString configPath = dir.filePath("logging.json");
+    auto writeConfig = [&](const QString& path, const char* level) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QByteArray data(R"({"loggers": {"watch_test": {"level": ")");
+        data.append(level);
+        data.append(R"(", "sinks": ["null"]}}, "sinks": {"null": {"type": "null"}}})");
+        file.write(data);
+    };
+
+    writeConfig(configPath, "info");
+    auto watcher = std::make_unique<qt_spdlog::config::ConfigWatcher>(configPath);
+    QCOMPARE(watcher->generation(), quint64(1));
+    auto logger = spdlog::get("watch_test");
+    QVERIFY(logger);
+    QCOMPARE(logger->level(), spdlog::level::info);
+
+    // Изменение файла: QFileSystemWatcher и таймер схлопывания в цикле событий
+    writeConfig(configPath, "warn");
+    QTRY_COMPARE_WITH_TIMEOUT(logger->level(), spdlog::level::warn, 5000);
+
+    // Замена переименованием: файл заново попадает под наблюдение
+    const QString replacement = dir.filePath("logging.json.new");
+    writeConfig(replacement, "err");
+    QCOMPARE(std::rename(QFile::encodeName(replacement).constData(), QFile::encodeName(configPath).constData()), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(logger->level(), spdlog::level::err, 5000);
+    QVERIFY(watcher->lastError().isEmpty());
+
+#ifndef _WIN32
+    // SIGHUP без изменения файла: перезагрузку дает только сигнал
+    struct sigaction previous{};
+    struct sigaction custom{};
+    custom.sa_handler = [](int) {};
+    sigemptyset(&custom.sa_mask);
+    QCOMPARE(::sigaction(SIGHUP, &custom, &previous), 0);
+
+    QVERIFY(watcher->enableSighupReload());
+    QTest::qWait(300);
+    const quint64 generation = watcher->generation();
+    QCOMPARE(::raise(SIGHUP), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(watcher->generation(), generation + 1, 5000);
+
+    // Деструктор возвращает обработчик, стоявший до наблюдателя
+    watcher.reset();
+    struct sigaction restored{};
+    QCOMPARE(::sigaction(SIGHUP, nullptr, &restored), 0);
+    QVERIFY(restored.sa_handler == custom.sa_handler);
+    ::sigaction(SIGHUP, &previous, nullptr);
+#endif
+
+    spdlog::drop("watch_test");
+}
+
+// QCoreApplication нужен циклу событий наблюдателя конфигурации
+QTEST_GUILESS_MAIN(TestQtSpdlog)
 #include "test_qt_spdlog.moc"
\ No newline at end of file
@@ -0,0 +1,204 @@
+// Перевод файла qt_spdlog::cbor_formatter в JSON Lines с полями как у json_formatter.
+//
+//   qt_spdlog_cbor2json [INPUT] [--output FILE]
+//
+// Без INPUT читает stdin. Время выводится в ISO 8601 с миллисекундами (локальное),
+// уровень - именем spdlog. Поля "f" сохраняют порядок и типы исходной записи.
+
+#include "qt_spdlog.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QDateTime>
+#include <QFile>
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr, "usage: qt_spdlog_cbor2json [INPUT] [--output FILE]\n");
+}
+
+void appendKey(spdlog::memory_buf_t& buffer, bool& first, spdlog::string_view_t key)
+{
+    if (!first) {
+        buffer.push_back(',');
+    }
+    first = false;
+    qt_spdlog::json::details::append_string(buffer, key);
+    buffer.push_back(':');
+}
+
+// Значение поля: вложенные map/array выводятся с сохранением порядка ключей
+void appendValue(spdlog::memory_buf_t& buffer, const QCborValue& value)
+{
+    if (value.isMap()) {
+        const QCborMap map = value.toMap();
+        bool first = true;
+        buffer.push_back('{');
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            if (!first) {
+                buffer.push_back(',');
+            }
+            first = false;
+            qt_spdlog::json::write_value(buffer, it.key().toString());
+            buffer.push_back(':');
+            appendValue(buffer, it.value());
+        }
+        buffer.push_back('}');
+        return;
+    }
+    if (value.isArray()) {
+        const QCborArray array = value.toArray();
+        bool first = true;
+        buffer.push_back('[');
+        for (const auto& item : array) {
+            if (!first) {
+                buffer.push_back(',');
+            }
+            first = false;
+            appendValue(buffer, item);
+        }
+        buffer.push_back(']');
+        return;
+    }
+    if (value.isByteArray()) {
+        // Как QJsonValue: двоичные данные - base64url
+        qt_spdlog::json::write_value(buffer, QString::fromLatin1(
+            value.toByteArray().toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals)));
+        return;
+    }
+    qt_spdlog::json::write_value(buffer, value.toVariant());
+}
+
+bool convertRecord(spdlog::memory_buf_t& buffer, const QCborValue& value)
+{
+    if (!value.isMap()) {
+        return false;
+    }
+    const QCborMap record = value.toMap();
+    bool first = true;
+    buffer.push_back('{');
+
+    const qint64 nanoseconds = record.value(QStringLiteral("ts")).toInteger();
+    appendKey(buffer, first, "timestamp");
+    qt_spdlog::json::write_value(buffer, QDateTime::fromMSecsSinceEpoch(nanoseconds / 1000000)
+                                             .toString(Qt::ISODateWithMs));
+
+    const qint64 level = record.value(QStringLiteral("lvl")).toInteger(spdlog::level::off);
+    appendKey(buffer, first, "level");
+    qt_spdlog::json::details::append_string(buffer, spdlog::level::to_string_view(
+        static_cast<spdlog::level::level_enum>(qBound<qint64>(spdlog::level::trace, level, spdlog::level::off))));
+
+    appendKey(buffer, first, "logger");
+    qt_spdlog::json::write_value(buffer, record.value(QStringLiteral("log")).toString());
+    appendKey(buffer, first, "thread");
+    fmt::format_to(std::back_inserter(buffer), "{}", record.value(QStringLiteral("tid")).toInteger());
+
+    const QCborValue module = record.value(QStringLiteral("mod"));
+    if (module.isString()) {
+        appendKey(buffer, first, "module");
+        qt_spdlog::json::write_value(buffer, module.toString());
+    }
+
+    const QCborValue context = record.value(QStringLiteral("ctx"));
+    if (context.isMap()) {
+        appendKey(buffer, first, "context");
+        appendValue(buffer, context);
+    }
+
+    const QCborArray source = record.value(QStringLiteral("src")).toArray();
+    if (source.size() >= 2) {
+        appendKey(buffer, first, "source");
+        buffer.push_back('{');
+        bool sourceFirst = true;
+        appendKey(buffer, sourceFirst, "file");
+        qt_spdlog::json::write_value(buffer, source.at(0).toString());
+        appendKey(buffer, sourceFirst, "line");
+        fmt::format_to(std::back_inserter(buffer), "{}", source.at(1).toInteger());
+        if (source.size() > 2) {
+            appendKey(buffer, sourceFirst, "function");
+            qt_spdlog::json::write_value(buffer, source.at(2).toString());
+        }
+        buffer.push_back('}');
+    }
+
+    appendKey(buffer, first, "message");
+    qt_spdlog::json::write_value(buffer, record.value(QStringLiteral("msg")).toString());
+
+    const QCborValue fields = record.value(QStringLiteral("f"));
+    if (fields.isMap()) {
+        appendKey(buffer, first, "fields");
+        appendValue(buffer, fields);
+    }
+
+    buffer.push_back('}');
+    buffer.push_back('\n');
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QString inputPath;
+    QString outputPath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--output" && i + 1 < argc) {
+            outputPath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg.rfind("--", 0) != 0 && inputPath.isEmpty()) {
+            inputPath = QString::fromLocal8Bit(argv[i]);
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    QFile input;
+    const bool inputOpened = inputPath.isEmpty()
+        ? input.open(stdin, QIODevice::ReadOnly)
+        : (input.setFileName(inputPath), input.open(QIODevice::ReadOnly));
+    if (!inputOpened) {
+        std::fprintf(stderr, "qt_spdlog_cbor2json: cannot open input: %s\n", qPrintable(input.errorString()));
+        return 1;
+    }
+
+    QFile output;
+    const bool outputOpened = outputPath.isEmpty()
+        ? output.open(stdout, QIODevice::WriteOnly)
+        : (output.setFileName(outputPath), output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    if (!outputOpened) {
+        std::fprintf(stderr, "qt_spdlog_cbor2json: cannot open output: %s\n", qPrintable(output.errorString()));
+        return 1;
+    }
+
+    // Файл - CBOR sequence: записи идут подряд без обрамляющего массива
+    QCborStreamReader reader(input.readAll());
+    spdlog::memory_buf_t buffer;
+    quint64 records = 0;
+    while (reader.isValid()) {
+        const QCborValue value = QCborValue::fromCbor(reader);
+        // EndOfFile выставляется и после последней целой записи
+        if (reader.lastError() != QCborError::NoError && reader.lastError() != QCborError::EndOfFile) {
+            break;
+        }
+        buffer.clear();
+        if (convertRecord(buffer, value)) {
+            output.write(buffer.data(), static_cast<qint64>(buffer.size()));
+            ++records;
+        }
+    }
+
+    if (reader.lastError() != QCborError::NoError && reader.lastError() != QCborError::EndOfFile) {
+        std::fprintf(stderr, "qt_spdlog_cbor2json: invalid CBOR after %llu records: %s\n",
+                     static_cast<unsigned long long>(records), qPrintable(reader.lastError().toString()));
+        return 1;
+    }
+    return 0;
+}
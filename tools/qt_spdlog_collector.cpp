@@ -0,0 +1,227 @@
+// Минимальный приемник для сокетного sink'а qt_spdlog: используется в тестах и бенчмарках.
+//
+//   qt_spdlog_collector --unix PATH | --unix-dgram PATH | --tcp PORT
+//                       [--count N] [--output FILE]
+//
+// После открытия сокета печатает "ready", по завершении (получено N записей,
+// SIGINT/SIGTERM) - "records N bytes M seconds S". Запись - строка до '\n'.
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int)
+{
+    g_stop = 1;
+}
+
+struct Options {
+    enum class Mode { None, UnixStream, UnixDatagram, Tcp } mode = Mode::None;
+    std::string path;
+    int port = 0;
+    std::uint64_t count = 0; // 0 - без ограничения
+    std::string output;
+};
+
+void printUsage()
+{
+    std::fprintf(stderr, "usage: qt_spdlog_collector --unix PATH | --unix-dgram PATH | --tcp PORT "
+                         "[--count N] [--output FILE]\n");
+}
+
+bool parseArguments(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--unix") {
+            options.mode = Options::Mode::UnixStream;
+            options.path = value;
+        } else if (arg == "--unix-dgram") {
+            options.mode = Options::Mode::UnixDatagram;
+            options.path = value;
+        } else if (arg == "--tcp") {
+            options.mode = Options::Mode::Tcp;
+            options.port = std::atoi(value.c_str());
+        } else if (arg == "--count") {
+            options.count = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return options.mode != Options::Mode::None;
+}
+
+int openSocket(const Options& options)
+{
+    if (options.mode == Options::Mode::Tcp) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        int enable = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<std::uint16_t>(options.port));
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.path.size() >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    std::memcpy(address.sun_path, options.path.c_str(), options.path.size() + 1);
+    ::unlink(options.path.c_str());
+
+    bool datagram = options.mode == Options::Mode::UnixDatagram;
+    int fd = ::socket(AF_UNIX, datagram ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    // Большой приемный буфер, чтобы датаграммы не терялись на всплесках
+    int bufferSize = 8 * 1024 * 1024;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || (!datagram && ::listen(fd, 16) != 0)) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int listenFd = openSocket(options);
+    if (listenFd < 0) {
+        std::fprintf(stderr, "qt_spdlog_collector: cannot open socket: %s\n", std::strerror(errno));
+        return 1;
+    }
+
+    FILE* output = nullptr;
+    if (!options.output.empty()) {
+        output = std::fopen(options.output.c_str(), "ab");
+        if (!output) {
+            std::fprintf(stderr, "qt_spdlog_collector: cannot open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("ready\n");
+    std::fflush(stdout);
+
+    bool datagram = options.mode == Options::Mode::UnixDatagram;
+    std::vector<pollfd> fds{{listenFd, POLLIN, 0}};
+    std::vector<char> buffer(256 * 1024);
+    std::uint64_t records = 0;
+    std::uint64_t bytes = 0;
+    auto started = std::chrono::steady_clock::now();
+    bool firstData = true;
+
+    while (!g_stop && (options.count == 0 || records < options.count)) {
+        if (::poll(fds.data(), fds.size(), 200) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (std::size_t i = 0; i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            if (i == 0 && !datagram) {
+                int client = ::accept(listenFd, nullptr, nullptr);
+                if (client >= 0) {
+                    fds.push_back({client, POLLIN, 0});
+                }
+                continue;
+            }
+
+            ssize_t received = ::recv(fds[i].fd, buffer.data(), buffer.size(), 0);
+            if (received <= 0) {
+                if (!datagram) {
+                    ::close(fds[i].fd);
+                    fds[i].fd = -1;
+                }
+                continue;
+            }
+            // Время считаем от первых данных, а не от запуска
+            if (firstData) {
+                started = std::chrono::steady_clock::now();
+                firstData = false;
+            }
+            bytes += static_cast<std::uint64_t>(received);
+            for (ssize_t j = 0; j < received; ++j) {
+                records += buffer[static_cast<std::size_t>(j)] == '\n';
+            }
+            if (output) {
+                std::fwrite(buffer.data(), 1, static_cast<std::size_t>(received), output);
+            }
+        }
+
+        // Закрытые клиенты убираем после обхода
+        std::vector<pollfd> alive;
+        for (const auto& fd : fds) {
+            if (fd.fd >= 0) {
+                alive.push_back({fd.fd, POLLIN, 0});
+            }
+        }
+        fds.swap(alive);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::printf("records %llu bytes %llu seconds %.6f\n",
+                static_cast<unsigned long long>(records), static_cast<unsigned long long>(bytes), seconds);
+    std::fflush(stdout);
+
+    for (const auto& fd : fds) {
+        ::close(fd.fd);
+    }
+    if (output) {
+        std::fclose(output);
+    }
+    if (options.mode != Options::Mode::Tcp) {
+        ::unlink(options.path.c_str());
+    }
+    return 0;
+}